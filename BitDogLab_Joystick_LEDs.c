@@ -3,14 +3,25 @@
 // =============================================================================
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
-#include "pico/stdlib.h"
-#include "pico/time.h"      
-#include "hardware/adc.h"
-#include "hardware/pwm.h"
-#include "hardware/gpio.h"
-#include "hardware/i2c.h"
+#include "Inc/hal.h"        // Todo acesso ao hardware passa pela HAL
 #include "Inc/ssd1306.h"    
+#include "Inc/ui.h"
+#include "Inc/grafico.h"
+#include "Inc/escalonador.h"
+#include "Inc/amostragem.h"
+#include "Inc/filtro.h"
+#include "Inc/fila_spsc.h"
+#include "Inc/controle.h"
+#include "Inc/planta.h"
+#include "Inc/botoes.h"
+#include "Inc/energia.h"
+#include "Inc/perf.h"
+#include "Inc/telemetria.h"
+#include "Inc/armazenamento.h"
+#include "Inc/zonas.h"
+#include "Inc/console.h"
 
 // =============================================================================
 // DEFINIÇÕES DOS PINOS
@@ -18,200 +29,1057 @@
 #define LED_VERDE       11  // Umidade ideal
 #define LED_AZUL        12  // Umidade baixa
 #define LED_VERMELHO    13  // Umidade alta
+#define BOMBA           10  // Válvula/bomba de irrigação da zona 1 (PWM)
+#define BOMBA_2         9   // Válvula/bomba da zona 2 (PWM)
 
-#define BOTAO_A         5   // Liga/desliga o sistema
+#define BOTAO_A         5   // Liga/desliga o sistema; duplo clique troca a zona
 #define BOTAO_JOYSTICK  22  // Alterna entre modos de operação
 
-#define SENSOR_UMIDADE  26  // Pino ADC para simular leitura de umidade
+#define SENSOR_UMIDADE  26  // Pino ADC para simular leitura de umidade (zona 1)
 #define JOYSTICK_Y      27  // Ajusta a umidade desejada
+#define SENSOR_UMIDADE_2 28 // Sensor da zona 2
 
 #define I2C_SDA_PIN     14
 #define I2C_SCL_PIN     15
 #define PORTA_I2C       i2c1
 
 #define ENDERECO        0x3C
-#define LARGURA         128
-#define ALTURA          64
+#define LARGURA         SSD1306_WIDTH   // Geometria do painel: opções de compilação
+#define ALTURA          SSD1306_HEIGHT  // do driver (Inc/ssd1306.h)
+
+// Segundo display de status opcional (128x32), no mesmo barramento
+#ifndef DISPLAY_SECUNDARIO
+#define DISPLAY_SECUNDARIO 0
+#endif
+#define ENDERECO_2      0x3D
 #define TAM_QUADRADO    8
 
 // Constantes para o centro do joystick
 #define CENTRO_Y        2101
 
+// Amostragem contínua do ADC (round-robin entre sensor e joystick)
+#define ADC_SENSOR          0      // Entrada do ADC ligada ao GPIO 26
+#define ADC_JOYSTICK_Y      1      // Entrada do ADC ligada ao GPIO 27
+#define ADC_SENSOR_2        2      // Entrada do ADC ligada ao GPIO 28
+#define TAXA_AMOSTRAGEM_HZ  1000   // Amostras por segundo em cada entrada
+#define AMOSTRAS_MEDIA      16     // Amostras na média de cada leitura do joystick
+
+// Calibração e filtragem (somente inteiros)
+#define SENSOR_BRUTO_SECO     0      // Leitura do ADC com o solo seco (0%)
+#define SENSOR_BRUTO_MOLHADO  4095   // Leitura do ADC com o solo encharcado (100%)
+#define UMIDADE_ESCALA        1000   // Umidade filtrada em décimos de porcento
+#define ZONA_MORTA_Y          200    // Zona morta em torno do centro do joystick
+#define TAXA_SETPOINT         20     // Variação do setpoint com o joystick no fim do curso (%/s)
+#define PERIODO_SETPOINT_MS   50
+#define LIMIAR_LEDS           10     // Distância (%) do setpoint em que o LED azul/vermelho acende
+#define HISTERESE_LEDS        2      // Histerese (%) desses limiares
+
+// Controle da irrigação (PWM com wrap 4095)
+#define PWM_MAX               4095
+#define PERIODO_CONTROLE_MS   100
+#define LED_BRILHO_MIN        400    // Brilho mínimo de um LED aceso
+#define LED_ERRO_MAX          200    // Erro (décimos de %) em que o LED atinge o brilho máximo
+
+// Console de comandos pela serial (Inc/console.h)
+#define PERIODO_CONSOLE_MS    20
+#define CONSOLE_LINHAS_POR_PASSO 4   // Comandos executados por período, no máximo
+
+// Zonas de irrigação (Inc/zonas.h), cada uma com sensor e bomba próprios.
+// Com mais zonas que entradas livres no ADC, os sensores viriam de um
+// multiplexador analógico. Sem relógio de tempo real, o minuto do dia conta
+// a partir de minuto_partida (meia-noite, se ninguém acertar o relógio).
+#define NUM_ZONAS             2
+#define ZONAS_POR_PAGINA      8      // Linhas da lista de zonas no display
+#define PAGINAS_ZONAS         ((NUM_ZONAS + ZONAS_POR_PAGINA - 1) / ZONAS_POR_PAGINA)
+
+// Histórico da umidade da zona selecionada (Inc/grafico.h): uma amostra a
+// cada PERIODO_TENDENCIA_S; a tela de tendência mostra as últimas LARGURA
+#define PERIODO_TENDENCIA_S   5
+
+static const uint8_t entrada_zona[NUM_ZONAS] = { ADC_SENSOR, ADC_SENSOR_2 };
+static const uint8_t bomba_zona[NUM_ZONAS] = { BOMBA, BOMBA_2 };
+// Janela diária de irrigação de cada zona (início e fim em minutos do dia;
+// iguais = o dia todo). Ex.: { 5 * 60, 8 * 60 } rega só das 5h às 8h
+static const uint16_t janela_zona[NUM_ZONAS][2] = { { 0, 0 }, { 0, 0 } };
+
+// Economia de energia
+#define TAXA_OCIOSA_HZ        400    // Amostras por segundo em cada entrada com leituras estáveis
+#define OCIOSO_APOS_MS        60000  // Sem atividade por este tempo: modo ocioso
+#define TELA_APOS_MS          30000  // Sem atividade por este tempo: painel apagado
+
+// Simulação da planta: sem sensor e bomba reais, a umidade medida vem do
+// modelo, que seca em direção à leitura do ADC e é irrigado pela bomba
+#define SIMULAR_PLANTA        1
+#define PLANTA_TAU_S          60     // Constante de tempo da secagem
+#define PLANTA_GANHO          20     // Décimos de %/s com a bomba no máximo
+#define PLANTA_PASSO_MAX_US   1000000 // Passo máximo da integração do modelo
+
+// Telemetria binária (Inc/telemetria.h): registros a TAXA_REGISTRO_HZ no
+// núcleo 0, agrupados em quadros e escoados em blocos pelo núcleo 1
+#define TAXA_REGISTRO_HZ      100
+#define PERIODO_REGISTRO_US   (1000000 / TAXA_REGISTRO_HZ)
+#define ESCOAMENTO_MAX        512    // Bytes por execução da tarefa de escoamento
+#define LATENCIA_LOTE_MS      1000   // Um lote incompleto é fechado após este tempo
+
+// Persistência na flash (Inc/armazenamento.h): a configuração é gravada
+// depois de ficar estável por CONFIRMAR_APOS_S (um arraste do joystick vira
+// uma gravação só) e o registro de amostras recebe uma a cada AMOSTRA_LOG_S
+#define CONFIRMAR_APOS_S      5
+#define AMOSTRA_LOG_S         60
+
 // =============================================================================
 // VARIÁVEIS GLOBAIS DE CONTROLE
 // =============================================================================
+// Telas do display com o sistema ligado, na ordem da pressão longa do joystick
+typedef enum { VISTA_ZONA, VISTA_TENDENCIA, VISTA_LISTA, VISTAS } vista_t;
+
 volatile bool sistema_ligado = true;       // true = sistema ligado, false = desligado
 volatile bool modo_manual = false;         // true = modo manual, false = automático
-volatile uint16_t umidade_desejada = 50;   // Umidade desejada em porcentagem
-volatile uint16_t umidade_atual = 0;       // Umidade atual simulada
+volatile uint8_t zona_selecionada = 0;     // Zona exibida e ajustada pelo joystick
+volatile uint8_t vista = VISTA_ZONA;       // Tela exibida com o sistema ligado
+volatile uint8_t limiar_leds = LIMIAR_LEDS; // Limiar (%) dos LEDs de umidade baixa/alta
+static uint16_t minuto_partida = 0;        // Minuto do dia na partida
+volatile bool telemetria_ligada = true;    // Linhas de estado e quadros binários
+
+// Setpoint, janela, medida e saída de cada zona (setpoint inicial: 50%)
+static zonas_t zonas;
+
+// Chaves da configuração persistente. A partir de CHAVE_DESEJADA, cada chave
+// guarda os setpoints (%) de 8 zonas; a chave 2 era o setpoint da versão de
+// zona única e não é mais lida.
+enum { CHAVE_LIGADO = 0, CHAVE_MODO = 1, CHAVE_LIMIAR_LEDS = 3, CHAVE_DESEJADA = 4 };
+_Static_assert(CHAVE_DESEJADA + (NUM_ZONAS + 7) / 8 <= ARMAZENAMENTO_CHAVES, "zonas demais para a flash");
+static armazenamento_t armazenamento;
+
+SSD1306_DEFINE(ssd, LARGURA, ALTURA);   // Display principal
+#if DISPLAY_SECUNDARIO
+SSD1306_DEFINE(ssd_secundario, 128, 32);
+#endif
+
+// Cadeia de filtros do sensor: mediana contra picos, média móvel, EMA e uma
+// pequena histerese para a leitura não oscilar entre dois valores
+static const filtro_config_t config_filtro_umidade = {
+    .calibrar = true, .mediana = 5, .media = 16, .ema_shift = 4, .histerese = 3,
+};
+static filtro_t filtro_umidade[NUM_ZONAS];
+static uint64_t cursor_sensor[NUM_ZONAS];
 
-volatile uint32_t tempo_ultimo_botao_A = 0;
-volatile uint32_t tempo_ultimo_botao_joystick = 0;
+static joystick_eixo_t eixo_y = {
+    .centro = CENTRO_Y, .zona_morta = ZONA_MORTA_Y, .minimo = 0, .maximo = 4095,
+};
 
-ssd1306_t ssd;   // Instância do display SSD1306
+static comparador_t umidade_baixa = { .banda = HISTERESE_LEDS };
+static comparador_t umidade_alta = { .banda = HISTERESE_LEDS };
+
+// PI sintonizado para o modelo da planta (primeira ordem, tau = 60 s):
+// constante de tempo em malha fechada da ordem de 10 s e subida da bomba
+// limitada a 10% do curso por passo
+static const pid_config_t config_pid = {
+    .kp_q16 = 20 << 16, .ki_q16 = 22000, .kd_q16 = 0,
+    .saida_min = 0, .saida_max = PWM_MAX, .taxa_max = PWM_MAX / 10,
+    .periodo_us = PERIODO_CONTROLE_MS * 1000,
+};
+static planta_t planta[NUM_ZONAS];
+static uint64_t planta_instante_us;   // Instante da última leitura das plantas
 
 // =============================================================================
-// FUNÇÃO DE ANTIRREBOTE (DEBOUNCE)
+// ESTADO COMPARTILHADO ENTRE OS NÚCLEOS
+// O núcleo 0 (sensores, controle e LEDs) sobrescreve o instantâneo do estado
+// numa caixa sem travas; o núcleo 1 (display e telemetria), mesmo no período
+// lento da tela desligada, lê sempre o último publicado.
 // =============================================================================
-bool verificar_debounce(volatile uint32_t *ultimo_tempo) {
-    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-    if (tempo_atual - *ultimo_tempo > 100) {
-        *ultimo_tempo = tempo_atual;
-        return true;
+typedef struct {
+    uint64_t instante_us;
+    uint16_t zona;                          // Zona selecionada (a partir de 1)
+    uint16_t umidade_atual;                 // Da zona selecionada
+    uint16_t umidade_desejada;
+    uint16_t saida_bomba;
+    uint16_t umidade_zonas[NUM_ZONAS];      // Todas as zonas, para a lista
+    uint16_t desejada_zonas[NUM_ZONAS];
+    bool sistema_ligado;
+    bool tela_ligada;
+    bool modo_manual;
+    uint8_t vista;
+} estado_t;
+
+CAIXA_SPSC_DEFINIR(caixa_estado, estado_t);
+
+static estado_t estado_nucleo1;   // Último instantâneo recebido pelo núcleo 1
+
+// Registros da telemetria binária em trânsito do núcleo 0 para o núcleo 1
+TELEMETRIA_DEFINIR(telemetria_binaria, 64, hal_stdio_write);
+
+// =============================================================================
+// ESTÁGIOS INSTRUMENTADOS (com PERF_ATIVO; senão não geram código)
+// =============================================================================
+PERF_DEFINIR(sensor);       // Amostras novas do ADC pela cadeia de filtros
+PERF_DEFINIR(planta);
+PERF_DEFINIR(controle);     // Passo de controle de todas as zonas
+PERF_DEFINIR(joystick);     // Média das amostras do joystick
+PERF_DEFINIR(leds);
+PERF_DEFINIR(ui);           // Redesenho dos widgets no framebuffer
+PERF_DEFINIR(flush);        // Início do envio assíncrono ao display
+PERF_DEFINIR(telemetria);   // Formatação e envio da linha de estado
+PERF_DEFINIR(binaria);      // Codificação dos quadros e escoamento do anel
+
+// =============================================================================
+// TELAS DO DISPLAY (WIDGETS LIGADOS ÀS VARIÁVEIS DE CONTROLE)
+// =============================================================================
+static ui_widget_t widgets_ligado[] = {
+    UI_NUMERO(0, 0, "Umidade: ", &estado_nucleo1.umidade_atual, "%"),
+    UI_NUMERO(0, 20, "Desejada: ", &estado_nucleo1.umidade_desejada, "%"),
+    UI_ROTULO(0, 40, "Modo: "),
+    UI_ALTERNATIVA(48, 40, &estado_nucleo1.modo_manual, "Manual", "Auto"),
+#if NUM_ZONAS > 1
+    UI_NUMERO(96, 40, "Z", &estado_nucleo1.zona, ""),
+#endif
+    UI_MEDIDOR(0, 54, LARGURA, 10, &estado_nucleo1.umidade_atual, &estado_nucleo1.umidade_desejada, 100),
+};
+static ui_widget_t widgets_desligado[] = {
+    UI_ROTULO(0, 20, "Sistema Desligado"),
+};
+static ui_widget_t widgets_tendencia[] = {
+    UI_NUMERO(0, 0, "Z", &estado_nucleo1.zona, ""),
+    UI_NUMERO(32, 0, "", &estado_nucleo1.umidade_atual, "%"),
+    UI_NUMERO(72, 0, "/", &estado_nucleo1.umidade_desejada, "%"),
+};
+static ui_tela_t tela_ligado = UI_TELA(widgets_ligado);
+static ui_tela_t tela_desligado = UI_TELA(widgets_desligado);
+static ui_tela_t tela_tendencia = UI_TELA(widgets_tendencia);
+
+// Histórico da umidade: linha de tendência na página livre da tela da zona e
+// gráfico com o setpoint pontilhado na tela de tendência. Rolam uma coluna
+// por amostra nova, sem redesenhar o resto
+static grafico_serie_t historico;
+static grafico_t linha_tendencia = GRAFICO(&historico, 0, 8, LARGURA, 8, 0, 100);
+static grafico_t grafico_tendencia = GRAFICO(&historico, 0, 8, LARGURA, ALTURA - 8, 0, 100);
+
+#if DISPLAY_SECUNDARIO
+// Display secundário: resumo da zona selecionada, sempre na mesma tela
+static ui_widget_t widgets_secundario[] = {
+    UI_NUMERO(0, 0, "Zona ", &estado_nucleo1.zona, ""),
+    UI_NUMERO(0, 8, "Umidade: ", &estado_nucleo1.umidade_atual, "%"),
+    UI_NUMERO(0, 16, "Desejada: ", &estado_nucleo1.umidade_desejada, "%"),
+    UI_ALTERNATIVA(0, 24, &estado_nucleo1.sistema_ligado, "Ligado", "Desligado"),
+};
+static ui_tela_t tela_secundario = UI_TELA(widgets_secundario);
+#endif
+
+// Lista de zonas em páginas de ZONAS_POR_PAGINA linhas ("> Z1  42% /50%");
+// a página exibida é a da zona selecionada, marcada com ">"
+#define WIDGETS_POR_ZONA 4
+static uint16_t numero_zona[NUM_ZONAS];
+static bool zona_marcada[NUM_ZONAS];
+static ui_widget_t widgets_zonas[NUM_ZONAS][WIDGETS_POR_ZONA];
+static ui_tela_t telas_zonas[PAGINAS_ZONAS];
+
+static void montar_lista_zonas(void) {
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+        uint8_t y = (i % ZONAS_POR_PAGINA) * 8;
+        numero_zona[i] = i + 1;
+        ui_widget_t linha[WIDGETS_POR_ZONA] = {
+            UI_ALTERNATIVA(0, y, &zona_marcada[i], ">", " "),
+            UI_NUMERO(8, y, "Z", &numero_zona[i], ""),
+            UI_NUMERO(40, y, "", &estado_nucleo1.umidade_zonas[i], "%"),
+            UI_NUMERO(80, y, "/", &estado_nucleo1.desejada_zonas[i], "%"),
+        };
+        memcpy(widgets_zonas[i], linha, sizeof(linha));
+    }
+    for (uint8_t p = 0; p < PAGINAS_ZONAS; ++p) {
+        uint8_t linhas = NUM_ZONAS - p * ZONAS_POR_PAGINA;
+        if (linhas > ZONAS_POR_PAGINA)
+            linhas = ZONAS_POR_PAGINA;
+        telas_zonas[p] = (ui_tela_t){ widgets_zonas[p * ZONAS_POR_PAGINA], linhas * WIDGETS_POR_ZONA };
     }
-    return false;
+}
+
+// Troca a tela exibida: limpa o display e força o redesenho dos widgets e
+// dos gráficos
+static ui_tela_t *trocar_tela(ui_tela_t *atual, ui_tela_t *nova) {
+    if (atual != nova) {
+        ssd1306_fill(&ssd, false);
+        ui_invalidar(nova);
+        grafico_invalidar(&linha_tendencia);
+        grafico_invalidar(&grafico_tendencia);
+    }
+    return nova;
 }
 
 // =============================================================================
-// ROTINAS DE INTERRUPÇÃO PARA OS BOTÕES
+// FUNÇÃO PARA CONFIGURAR O PWM
 // =============================================================================
-void interrupcao_botao(uint gpio, uint32_t eventos) {
-    if (gpio == BOTAO_A && verificar_debounce(&tempo_ultimo_botao_A)) {
+void configurar_pwm(uint pin) {
+    hal_pwm_init(pin, PWM_MAX);
+}
+
+// =============================================================================
+// FUNÇÃO PARA LER A UMIDADE ATUAL DE UMA ZONA (SIMULADA)
+// =============================================================================
+int32_t ler_umidade_atual(uint8_t zona) {
+    // Passa pela cadeia de filtros todas as amostras novas do sensor
+    static int32_t decimos[NUM_ZONAS];
+    uint16_t amostras[128];
+    uint16_t n = amostragem_novas(entrada_zona[zona], amostras, 128, &cursor_sensor[zona]);
+    for (uint16_t i = 0; i < n; ++i)
+        decimos[zona] = filtro_processar(&filtro_umidade[zona], amostras[i]);
+    return decimos[zona];  // Décimos de porcento
+}
+
+// =============================================================================
+// FUNÇÃO PARA ATUALIZAR OS LEDs COM BASE NA UMIDADE
+// =============================================================================
+// Brilho proporcional ao erro: de LED_BRILHO_MIN até PWM_MAX em LED_ERRO_MAX
+static uint16_t brilho_led(int32_t erro) {
+    if (erro < 0)
+        erro = -erro;
+    if (erro > LED_ERRO_MAX)
+        erro = LED_ERRO_MAX;
+    return LED_BRILHO_MIN + erro * (PWM_MAX - LED_BRILHO_MIN) / LED_ERRO_MAX;
+}
+
+void atualizar_leds(int32_t umidade_decimos, uint16_t umidade_desejada) {
+    // Comparadores com histerese: a umidade parada perto de um limiar não
+    // faz os LEDs piscarem
+    int32_t diferenca = ((umidade_decimos + 5) / 10) - umidade_desejada;
+    bool baixa = comparador_atualizar(&umidade_baixa, -diferenca, limiar_leds);
+    bool alta = comparador_atualizar(&umidade_alta, diferenca, limiar_leds);
+
+    // Azul e vermelho ficam mais fortes quanto mais longe do setpoint; o
+    // verde é máximo no setpoint e enfraquece ao se afastar dele
+    int32_t erro = umidade_decimos - umidade_desejada * 10;
+    hal_pwm_set(LED_AZUL, baixa ? brilho_led(erro) : 0);
+    hal_pwm_set(LED_VERMELHO, alta ? brilho_led(erro) : 0);
+    hal_pwm_set(LED_VERDE, !baixa && !alta ? PWM_MAX + LED_BRILHO_MIN - brilho_led(erro * 2) : 0);
+}
+
+// =============================================================================
+// TAREFAS DO NÚCLEO 0 (SENSORES, CONTROLE E LEDS)
+// =============================================================================
+// Minuto do dia pelo relógio desde a partida
+static uint16_t minuto_do_dia(void) {
+    return (uint16_t)((minuto_partida + hal_time_us() / 60000000u) % 1440);
+}
+
+static uint16_t porcento(int32_t decimos) {
+    return (uint16_t)((decimos + 5) / 10);
+}
+
+#if SIMULAR_PLANTA
+// Avança o modelo pelo tempo decorrido desde a última leitura (mais que o
+// período se a tarefa atrasou ou o sistema estava desligado), em passos de
+// até PLANTA_PASSO_MAX_US, curtos diante da constante de tempo
+static int32_t avancar_planta(planta_t *p, int32_t ambiente, int32_t bomba, uint64_t decorrido_us) {
+    int32_t umidade;
+    do {
+        uint32_t dt = decorrido_us < PLANTA_PASSO_MAX_US ? (uint32_t)decorrido_us : PLANTA_PASSO_MAX_US;
+        umidade = planta_passo(p, ambiente, bomba, dt);
+        decorrido_us -= dt;
+    } while (decorrido_us > 0);
+    return umidade;
+}
+#endif
+
+// Leitura dos sensores (ou das plantas simuladas, regadas pela saída atual
+// das bombas)
+void tarefa_sensor(void) {
+    if (!sistema_ligado)
+        return;
+#if SIMULAR_PLANTA
+    uint64_t agora = hal_time_us();
+    uint64_t decorrido = agora - planta_instante_us;
+    planta_instante_us = agora;
+#endif
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+        int32_t medida;
+        PERF_MEDIR(sensor, medida = ler_umidade_atual(i));
+#if SIMULAR_PLANTA
+        PERF_MEDIR(planta, medida = avancar_planta(&planta[i], medida, zonas.saida[i], decorrido));
+#endif
+        zonas.umidade[i] = medida;
+    }
+}
+
+// Controle da irrigação: no modo automático, um passo de PI em todas as zonas
+// leva cada uma ao seu setpoint dentro da sua janela; no manual ou com o
+// sistema desligado, as bombas ficam paradas
+void tarefa_controle(void) {
+    PERF_MEDIR(controle, zonas_controlar(&zonas, &config_pid, sistema_ligado && !modo_manual, minuto_do_dia()));
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i)
+        hal_pwm_set(bomba_zona[i], (uint16_t)zonas.saida[i]);
+}
+
+// Ajuste da umidade desejada da zona selecionada com o joystick: fora da zona
+// morta, a deflexão do eixo Y sobe ou desce o setpoint proporcionalmente, até
+// TAXA_SETPOINT %/s
+void tarefa_setpoint(void) {
+    static int32_t centesimos = -1;
+    static uint8_t zona = 0;
+    if (!sistema_ligado)
+        return;
+    // Ressincroniza se a zona mudou ou se o setpoint foi alterado por fora
+    // (ex.: duplo clique)
+    uint8_t z = zona_selecionada;
+    if (centesimos < 0 || z != zona || centesimos / 100 * 10 != zonas.desejada[z]) {
+        centesimos = zonas.desejada[z] * 10;
+        zona = z;
+    }
+    int32_t bruto;
+    PERF_MEDIR(joystick, bruto = amostragem_media(ADC_JOYSTICK_Y, AMOSTRAS_MEDIA));
+    int32_t deflexao = joystick_deflexao(&eixo_y, bruto);
+    centesimos += deflexao * TAXA_SETPOINT * PERIODO_SETPOINT_MS / 1000;
+    if (centesimos < 0)
+        centesimos = 0;
+    if (centesimos > 10000)
+        centesimos = 10000;
+    zonas.desejada[z] = centesimos / 100 * 10;
+}
+
+void tarefa_leds(void) {
+    if (sistema_ligado) {
+        uint8_t z = zona_selecionada;
+        PERF_MEDIR(leds, atualizar_leds(zonas.umidade[z], porcento(zonas.desejada[z])));
+    } else {
+        // Sistema desligado: apaga os LEDs
+        hal_pwm_set(LED_VERDE, 0);
+        hal_pwm_set(LED_AZUL, 0);
+        hal_pwm_set(LED_VERMELHO, 0);
+    }
+}
+
+// Gestos dos botões, já sem repique:
+//   A: clique liga/desliga o sistema; duplo clique seleciona a próxima zona;
+//   pressão longa imprime os relatórios do escalonador, de energia, da
+//   telemetria, da flash e de desempenho pela serial
+//   Joystick: clique alterna o modo; duplo clique volta o setpoint da zona a
+//   50%; pressão longa passa para a próxima tela (zona, tendência, lista)
+static void tratar_botao(uint8_t gpio, botao_gesto_t gesto);
+
+static botao_t lista_botoes[] = {
+    BOTAO(BOTAO_A, NUM_ZONAS > 1 ? 300000 : 0),
+    BOTAO(BOTAO_JOYSTICK, 300000),
+};
+static botoes_t botoes = BOTOES(lista_botoes, tratar_botao, 20000, 1000000);
+
+// Consumo médio estimado por estado (ajustar com medições da placa)
+static const energia_config_t config_energia = {
+    .ocioso_apos_us = OCIOSO_APOS_MS * 1000u,
+    .tela_apos_us = TELA_APOS_MS * 1000u,
+    .corrente_ua = { [ENERGIA_ATIVO] = 24000, [ENERGIA_OCIOSO] = 15000, [ENERGIA_DESLIGADO] = 8000 },
+    .corrente_tela_ua = 9000,
+};
+static energia_t energia;
+
+void tarefa_botoes(void) {
+    botoes_processar(&botoes, hal_time_us());
+}
+
+// Publica o estado atual para o núcleo 1
+void tarefa_publicar(void) {
+    uint8_t z = zona_selecionada;
+    estado_t estado = {
+        .instante_us = hal_time_us(),
+        .zona = z + 1,
+        .umidade_atual = porcento(zonas.umidade[z]),
+        .umidade_desejada = porcento(zonas.desejada[z]),
+        .saida_bomba = (uint16_t)zonas.saida[z],
+        .sistema_ligado = sistema_ligado,
+        .modo_manual = modo_manual,
+        .tela_ligada = energia.tela_ligada,
+        .vista = vista,
+    };
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+        estado.umidade_zonas[i] = porcento(zonas.umidade[i]);
+        estado.desejada_zonas[i] = porcento(zonas.desejada[i]);
+    }
+    caixa_spsc_publicar(&caixa_estado, &estado);
+}
+
+// Flags de telemetria e do registro na flash para a zona
+static uint8_t flags_zona(uint8_t zona) {
+    return (sistema_ligado ? TELEMETRIA_LIGADO : 0) | (modo_manual ? TELEMETRIA_MANUAL : 0) |
+           TELEMETRIA_ZONA(zona);
+}
+
+// Registro de tamanho fixo da zona selecionada para a telemetria binária
+void tarefa_registro(void) {
+    if (!telemetria_ligada)
+        return;
+    uint8_t z = zona_selecionada;
+    registro_t registro = {
+        .instante_us = (uint32_t)hal_time_us(),
+        .umidade = (int16_t)zonas.umidade[z],
+        .desejada = (uint16_t)zonas.desejada[z],
+        .bomba = (uint16_t)zonas.saida[z],
+        .flags = flags_zona(z),
+    };
+    telemetria_registrar(&telemetria_binaria, &registro);
+}
+
+// Configuração e registro de amostras na flash. As gravações param o
+// núcleo 1 por alguns milissegundos (dezenas, ao apagar um setor)
+void tarefa_persistencia(void) {
+    static uint32_t estavel_s = 0;
+    static uint32_t segundos = 0;
+    bool ligado = sistema_ligado, manual = modo_manual;
+    uint8_t limiar = limiar_leds;
+    bool mudou = armazenamento_escrever(&armazenamento, CHAVE_LIGADO, &ligado, sizeof(ligado));
+    mudou |= armazenamento_escrever(&armazenamento, CHAVE_MODO, &manual, sizeof(manual));
+    mudou |= armazenamento_escrever(&armazenamento, CHAVE_LIMIAR_LEDS, &limiar, sizeof(limiar));
+    for (uint8_t i = 0; i < NUM_ZONAS; i += 8) {
+        uint8_t desejadas[8];
+        uint8_t n = NUM_ZONAS - i < 8 ? NUM_ZONAS - i : 8;
+        for (uint8_t k = 0; k < n; ++k)
+            desejadas[k] = (uint8_t)porcento(zonas.desejada[i + k]);
+        mudou |= armazenamento_escrever(&armazenamento, CHAVE_DESEJADA + i / 8, desejadas, n);
+    }
+    estavel_s = mudou ? 0 : estavel_s + 1;
+    if (armazenamento.sujas && estavel_s >= CONFIRMAR_APOS_S)
+        armazenamento_confirmar(&armazenamento);
+
+    if (++segundos % AMOSTRA_LOG_S == 0) {
+        for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+            amostra_log_t amostra = {
+                .instante_s = (uint32_t)(hal_time_us() / 1000000),
+                .umidade = (int16_t)zonas.umidade[i],
+                .desejada = (uint16_t)zonas.desejada[i],
+                .bomba = (uint16_t)zonas.saida[i],
+                .flags = flags_zona(i),
+            };
+            armazenamento_registrar(&armazenamento, &amostra);
+        }
+    }
+}
+
+// Restaura a configuração gravada (valores fora da faixa ficam no padrão)
+static void restaurar_configuracao(void) {
+    bool ligado, manual;
+    uint8_t limiar;
+    armazenamento_iniciar(&armazenamento);
+    if (armazenamento_ler(&armazenamento, CHAVE_LIGADO, &ligado, sizeof(ligado)))
+        sistema_ligado = ligado;
+    if (armazenamento_ler(&armazenamento, CHAVE_MODO, &manual, sizeof(manual)))
+        modo_manual = manual;
+    for (uint8_t i = 0; i < NUM_ZONAS; i += 8) {
+        uint8_t desejadas[8];
+        uint8_t n = NUM_ZONAS - i < 8 ? NUM_ZONAS - i : 8;
+        if (armazenamento_ler(&armazenamento, CHAVE_DESEJADA + i / 8, desejadas, n))
+            for (uint8_t k = 0; k < n; ++k)
+                if (desejadas[k] <= 100)
+                    zonas.desejada[i + k] = desejadas[k] * 10;
+    }
+    if (armazenamento_ler(&armazenamento, CHAVE_LIMIAR_LEDS, &limiar, sizeof(limiar)) && limiar <= 50)
+        limiar_leds = limiar;
+    printf("Configuração restaurada: sistema %s, modo %s, umidade desejada da zona 1 %d%%\n",
+           sistema_ligado ? "ligado" : "desligado", modo_manual ? "manual" : "automático",
+           porcento(zonas.desejada[0]));
+}
+
+void tarefa_console(void);
+void tarefa_energia(void);
+
+enum { T_BOTOES, T_SENSOR, T_CONTROLE, T_SETPOINT, T_LEDS, T_PUBLICAR, T_REGISTRO, T_PERSISTENCIA, T_CONSOLE, T_ENERGIA, TAREFAS_NUCLEO0 };
+
+static tarefa_t tarefas_nucleo0[] = {
+    //     nome          função             período (us)                prazo (us)
+    TAREFA("botoes",     tarefa_botoes,     10000,                      5000),
+    TAREFA("sensor",     tarefa_sensor,     100000,                     20000),
+    TAREFA("controle",   tarefa_controle,   PERIODO_CONTROLE_MS * 1000, 20000),
+    TAREFA("setpoint",   tarefa_setpoint,   PERIODO_SETPOINT_MS * 1000, 20000),
+    TAREFA("leds",       tarefa_leds,       100000,                     20000),
+    TAREFA("publicar",   tarefa_publicar,   100000,                     20000),
+    TAREFA("registro",   tarefa_registro,   PERIODO_REGISTRO_US,        5000),
+    TAREFA("persistencia", tarefa_persistencia, 1000000,                0),
+    TAREFA("console",    tarefa_console,    PERIODO_CONSOLE_MS * 1000,  20000),
+    TAREFA("energia",    tarefa_energia,    100000,                     20000),
+};
+static escalonador_t escalonador_nucleo0 = ESCALONADOR(tarefas_nucleo0);
+
+// Períodos das tarefas do núcleo 0 em cada estado de energia. Ocioso: os
+// botões e o console são lidos com menos frequência e os registros saem a
+// 10 Hz. Desligado: tudo a 1 s, e a interrupção dos botões antecipa a tarefa
+// deles e acorda o núcleo.
+static const uint32_t periodos_us[ENERGIA_ESTADOS][TAREFAS_NUCLEO0] = {
+    //  botoes   sensor   controle                    setpoint                    leds     publicar registro             persistencia console                    energia
+    {   10000,   100000,  PERIODO_CONTROLE_MS * 1000, PERIODO_SETPOINT_MS * 1000, 100000,  100000,  PERIODO_REGISTRO_US, 1000000,     PERIODO_CONSOLE_MS * 1000, 100000  },
+    {   100000,  100000,  PERIODO_CONTROLE_MS * 1000, PERIODO_SETPOINT_MS * 1000, 100000,  100000,  100000,              1000000,     100000,                    100000  },
+    {   1000000, 1000000, 1000000,                    1000000,                    1000000, 1000000, 1000000,             1000000,     1000000,                   1000000 },
+};
+static const uint32_t taxa_adc_hz[ENERGIA_ESTADOS] = { TAXA_AMOSTRAGEM_HZ, TAXA_OCIOSA_HZ, 0 };
+
+// Qualquer mudança visível ou comando do usuário conta como atividade
+void tarefa_energia(void) {
+    static estado_t anterior;
+    uint64_t agora = hal_time_us();
+    uint8_t z = zona_selecionada;
+    uint16_t umidade = porcento(zonas.umidade[z]), desejada = porcento(zonas.desejada[z]);
+    if (umidade != anterior.umidade_atual || desejada != anterior.umidade_desejada ||
+        z + 1 != anterior.zona || vista != anterior.vista ||
+        modo_manual != anterior.modo_manual || sistema_ligado != anterior.sistema_ligado) {
+        energia_atividade(&energia, agora);
+        anterior.umidade_atual = umidade;
+        anterior.umidade_desejada = desejada;
+        anterior.zona = z + 1;
+        anterior.vista = vista;
+        anterior.modo_manual = modo_manual;
+        anterior.sistema_ligado = sistema_ligado;
+    }
+    energia_estado_t estado = energia.estado;
+    if (energia_atualizar(&energia, sistema_ligado, agora) && energia.estado != estado) {
+        amostragem_definir_taxa(taxa_adc_hz[energia.estado]);
+        for (uint8_t i = 0; i < TAREFAS_NUCLEO0; ++i)
+            escalonador_definir_periodo(&tarefas_nucleo0[i], periodos_us[energia.estado][i]);
+    }
+}
+
+// Contadores da telemetria binária (lidos do outro núcleo: só indicativos)
+static void relatorio_telemetria(void) {
+    printf("Telemetria: %lu quadros, %lu bytes, %lu registros perdidos\n",
+           (unsigned long)telemetria_binaria.quadros, (unsigned long)telemetria_binaria.bytes,
+           (unsigned long)telemetria_perdidos(&telemetria_binaria));
+}
+
+static console_t console;   // Definida com a tabela de comandos, mais abaixo
+static escalonador_t escalonador_nucleo1;   // Definido com as tarefas do núcleo 1
+
+// Relatórios dos escalonadores dos dois núcleos, de energia, da telemetria,
+// do console, da flash e de desempenho
+static void imprimir_relatorios(void) {
+    printf("Núcleo 0:\n");
+    escalonador_relatorio(&escalonador_nucleo0);
+    printf("Núcleo 1:\n");
+    escalonador_relatorio(&escalonador_nucleo1);
+    energia_relatorio(&energia);
+    relatorio_telemetria();
+    printf("Console: %lu linhas, %lu erros, %lu bytes perdidos\n", (unsigned long)console.linhas,
+           (unsigned long)console.erros, (unsigned long)console.perdidos);
+    printf("Display: %lu envios abortados (NACK)\n", (unsigned long)ssd.flush_errors);
+#if DISPLAY_SECUNDARIO
+    printf("Display secundário: %lu envios abortados (NACK)\n",
+           (unsigned long)ssd_secundario.flush_errors);
+#endif
+    armazenamento_relatorio(&armazenamento);
+    PERF_RELATORIO();
+}
+
+static void tratar_botao(uint8_t gpio, botao_gesto_t gesto) {
+    if (gesto == BOTAO_PRESSIONADO) {
+        energia_atividade(&energia, hal_time_us());
+        escalonador_antecipar(&tarefas_nucleo0[T_ENERGIA]);
+    } else if (gpio == BOTAO_A && gesto == BOTAO_LONGO) {
+        imprimir_relatorios();
+    } else if (gpio == BOTAO_A && gesto == BOTAO_CLIQUE) {
         sistema_ligado = !sistema_ligado;
         printf("Botão A: Sistema %s\n", sistema_ligado ? "ligado" : "desligado");
-    }
-    
-    if (gpio == BOTAO_JOYSTICK && verificar_debounce(&tempo_ultimo_botao_joystick)) {
+    } else if (gpio == BOTAO_JOYSTICK && gesto == BOTAO_CLIQUE) {
         modo_manual = !modo_manual;
         printf("Botão Joystick: Modo %s\n", modo_manual ? "manual" : "automático");
+    } else if (gpio == BOTAO_A && gesto == BOTAO_DUPLO_CLIQUE) {
+        zona_selecionada = (zona_selecionada + 1) % NUM_ZONAS;
+        printf("Botão A: Zona %d\n", zona_selecionada + 1);
+    } else if (gpio == BOTAO_JOYSTICK && gesto == BOTAO_DUPLO_CLIQUE) {
+        zonas.desejada[zona_selecionada] = 500;
+        printf("Botão Joystick: Umidade desejada da zona %d 50%%\n", zona_selecionada + 1);
+    } else if (gpio == BOTAO_JOYSTICK && gesto == BOTAO_LONGO) {
+        vista = (vista + 1) % VISTAS;
     }
 }
 
 // =============================================================================
-// FUNÇÃO PARA CONFIGURAR O PWM
+// CONSOLE PELA SERIAL
+// Os mesmos ajustes dos botões e do joystick, e mais os que não têm gesto
+// (relógio, janelas, limiar dos LEDs). Zonas são numeradas a partir de 1.
 // =============================================================================
-void configurar_pwm(uint pin) {
-    gpio_set_function(pin, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    pwm_set_wrap(slice_num, 4095);
-    pwm_set_enabled(slice_num, true);
+static bool ler_zona(const char *texto, uint8_t *zona) {
+    int32_t n;
+    if (!console_inteiro(texto, 1, NUM_ZONAS, &n)) {
+        printf("erro: zona deve ser de 1 a %d\n", NUM_ZONAS);
+        return false;
+    }
+    *zona = (uint8_t)(n - 1);
+    return true;
+}
+
+// "liga"/"desliga" (e sinônimos de uma letra); false se não for nenhum
+static bool ler_liga(const char *texto, bool *ligado) {
+    if (strcmp(texto, "liga") == 0 || strcmp(texto, "1") == 0)
+        *ligado = true;
+    else if (strcmp(texto, "desliga") == 0 || strcmp(texto, "0") == 0)
+        *ligado = false;
+    else {
+        printf("erro: use liga ou desliga\n");
+        return false;
+    }
+    return true;
+}
+
+static void comando_estado(uint8_t argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    uint16_t minuto = minuto_do_dia();
+    printf("Sistema %s, modo %s, relógio %02d:%02d, zona %d selecionada, telemetria %s\n",
+           sistema_ligado ? "ligado" : "desligado", modo_manual ? "manual" : "automático",
+           minuto / 60, minuto % 60, zona_selecionada + 1, telemetria_ligada ? "ligada" : "desligada");
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+        uint16_t inicio = zonas.janela_inicio_min[i], fim = zonas.janela_fim_min[i];
+        printf("Zona %d: umidade %d%% desejada %d%% bomba %ld%% janela %02d:%02d-%02d:%02d%s\n", i + 1,
+               porcento(zonas.umidade[i]), porcento(zonas.desejada[i]),
+               (long)(zonas.saida[i] * 100 / PWM_MAX), inicio / 60, inicio % 60, fim / 60, fim % 60,
+               zonas.na_janela & (1ull << i) ? " (regando)" : "");
+    }
+}
+
+static void comando_sistema(uint8_t argc, char **argv) {
+    (void)argc;
+    bool ligado;
+    if (ler_liga(argv[1], &ligado))
+        sistema_ligado = ligado;
+}
+
+static void comando_modo(uint8_t argc, char **argv) {
+    (void)argc;
+    if (strcmp(argv[1], "auto") == 0)
+        modo_manual = false;
+    else if (strcmp(argv[1], "manual") == 0)
+        modo_manual = true;
+    else
+        printf("erro: use auto ou manual\n");
+}
+
+static void comando_zona(uint8_t argc, char **argv) {
+    (void)argc;
+    uint8_t zona;
+    if (ler_zona(argv[1], &zona))
+        zona_selecionada = zona;
+}
+
+// tela zona|tendencia|lista: mesma sequência da pressão longa do joystick
+static void comando_tela(uint8_t argc, char **argv) {
+    (void)argc;
+    static const char *nomes[VISTAS] = { "zona", "tendencia", "lista" };
+    for (uint8_t i = 0; i < VISTAS; ++i) {
+        if (strcmp(argv[1], nomes[i]) == 0) {
+            vista = i;
+            return;
+        }
+    }
+    printf("erro: use zona, tendencia ou lista\n");
+}
+
+// desejada <%> (zona selecionada) ou desejada <zona> <%>
+static void comando_desejada(uint8_t argc, char **argv) {
+    uint8_t zona = zona_selecionada;
+    int32_t valor;
+    if (argc == 3 && !ler_zona(argv[1], &zona))
+        return;
+    if (!console_inteiro(argv[argc - 1], 0, 100, &valor)) {
+        printf("erro: umidade desejada deve ser de 0 a 100\n");
+        return;
+    }
+    zonas.desejada[zona] = valor * 10;
+}
+
+static void comando_janela(uint8_t argc, char **argv) {
+    (void)argc;
+    uint8_t zona;
+    uint16_t inicio, fim;
+    if (!ler_zona(argv[1], &zona))
+        return;
+    if (!console_horario(argv[2], &inicio) || !console_horario(argv[3], &fim)) {
+        printf("erro: horários no formato hh:mm\n");
+        return;
+    }
+    zonas_definir_janela(&zonas, zona, inicio, fim);
+}
+
+// Sem relógio de tempo real: acertar o relógio muda o minuto da partida
+static void comando_relogio(uint8_t argc, char **argv) {
+    uint16_t minuto;
+    if (argc == 2) {
+        if (!console_horario(argv[1], &minuto)) {
+            printf("erro: horário no formato hh:mm\n");
+            return;
+        }
+        uint16_t desde_partida = (uint16_t)(hal_time_us() / 60000000u % 1440);
+        minuto_partida = (uint16_t)((minuto + 1440 - desde_partida) % 1440);
+    }
+    minuto = minuto_do_dia();
+    printf("Relógio: %02d:%02d\n", minuto / 60, minuto % 60);
+}
+
+static void comando_limiar(uint8_t argc, char **argv) {
+    (void)argc;
+    int32_t valor;
+    if (console_inteiro(argv[1], 0, 50, &valor))
+        limiar_leds = (uint8_t)valor;
+    else
+        printf("erro: limiar deve ser de 0 a 50\n");
+}
+
+static void comando_telemetria(uint8_t argc, char **argv) {
+    (void)argc;
+    bool ligada;
+    if (ler_liga(argv[1], &ligada))
+        telemetria_ligada = ligada;
+}
+
+// relatorio [zerar]: com zerar, as estatísticas dos escalonadores e dos
+// estágios medidos recomeçam depois de impressas, para medir só o trecho
+// seguinte
+static void comando_relatorio(uint8_t argc, char **argv) {
+    bool zerar = argc == 2;
+    if (zerar && strcmp(argv[1], "zerar") != 0) {
+        printf("erro: use relatorio ou relatorio zerar\n");
+        return;
+    }
+    imprimir_relatorios();
+    if (!zerar)
+        return;
+    escalonador_zerar_estatisticas(&escalonador_nucleo0);
+    escalonador_zerar_estatisticas(&escalonador_nucleo1);
+    PERF_ZERAR();
+    printf("Estatísticas zeradas\n");
+}
+
+static const console_comando_t comandos[] = {
+    //              nome          função              args  ajuda
+    CONSOLE_COMANDO("estado",     comando_estado,     0, 0, "sistema, relógio e todas as zonas"),
+    CONSOLE_COMANDO("sistema",    comando_sistema,    1, 1, "liga|desliga"),
+    CONSOLE_COMANDO("modo",       comando_modo,       1, 1, "auto|manual"),
+    CONSOLE_COMANDO("zona",       comando_zona,       1, 1, "<zona>  seleciona a zona"),
+    CONSOLE_COMANDO("tela",       comando_tela,       1, 1, "zona|tendencia|lista  tela do display"),
+    CONSOLE_COMANDO("desejada",   comando_desejada,   1, 2, "[zona] <0-100>  umidade desejada (%)"),
+    CONSOLE_COMANDO("janela",     comando_janela,     3, 3, "<zona> <hh:mm> <hh:mm>  horário de rega (iguais: o dia todo)"),
+    CONSOLE_COMANDO("relogio",    comando_relogio,    0, 1, "[hh:mm]  mostra ou acerta o relógio"),
+    CONSOLE_COMANDO("limiar",     comando_limiar,     1, 1, "<0-50>  limiar (%) dos LEDs"),
+    CONSOLE_COMANDO("telemetria", comando_telemetria, 1, 1, "liga|desliga  linhas de estado e quadros binários"),
+    CONSOLE_COMANDO("relatorio",  comando_relatorio,  0, 1, "[zerar]  escalonador, energia, telemetria, flash e desempenho"),
+};
+static console_t console = CONSOLE(comandos);
+
+// Poucas linhas por período, para um roteiro colado de uma vez não atrasar
+// as outras tarefas; o resto espera no anel
+void tarefa_console(void) {
+    console_receber(&console);
+    if (console_processar(&console, CONSOLE_LINHAS_POR_PASSO)) {
+        energia_atividade(&energia, hal_time_us());
+        escalonador_antecipar(&tarefas_nucleo0[T_ENERGIA]);
+    }
 }
 
 // =============================================================================
-// FUNÇÃO PARA LER A UMIDADE ATUAL (SIMULADA)
+// ROTINA DE INTERRUPÇÃO PARA OS BOTÕES
+// Só registra o nível do pino e o instante; o antirrebote e os gestos ficam na tarefa,
+// que é antecipada (e o núcleo acordado) para não esperar o próximo período
 // =============================================================================
-uint16_t ler_umidade_atual() {
-    adc_select_input(0);   // Lê o pino do sensor de umidade
-    return (adc_read() * 100) / 4095;  // Converte para porcentagem
+void interrupcao_botao(uint gpio, uint32_t eventos) {
+    (void)eventos;
+    botoes_registrar(gpio);
+    escalonador_antecipar(&tarefas_nucleo0[T_BOTOES]);
+    hal_wake();
 }
 
 // =============================================================================
-// FUNÇÃO PARA ATUALIZAR OS LEDs COM BASE NA UMIDADE
+// TAREFAS DO NÚCLEO 1 (DISPLAY E TELEMETRIA)
 // =============================================================================
-void atualizar_leds(uint16_t umidade_atual, uint16_t umidade_desejada) {
-    if (umidade_atual < umidade_desejada - 10) {
-        gpio_put(LED_AZUL, 1);    // Umidade baixa
-        gpio_put(LED_VERDE, 0);
-        gpio_put(LED_VERMELHO, 0);
-    } else if (umidade_atual > umidade_desejada + 10) {
-        gpio_put(LED_VERMELHO, 1); // Umidade alta
-        gpio_put(LED_VERDE, 0);
-        gpio_put(LED_AZUL, 0);
-    } else {
-        gpio_put(LED_VERDE, 1);   // Umidade ideal
-        gpio_put(LED_AZUL, 0);
-        gpio_put(LED_VERMELHO, 0);
+void tarefa_display(void);
+void tarefa_telemetria(void);
+void tarefa_binaria(void);
+
+static tarefa_t tarefas_nucleo1[] = {
+    //     nome          função             período (us)  prazo (us)
+    TAREFA("display",    tarefa_display,    200000,       100000),
+    TAREFA("telemetria", tarefa_telemetria, 1000000,      0),
+    TAREFA("binaria",    tarefa_binaria,    100000,       50000),
+};
+static escalonador_t escalonador_nucleo1 = ESCALONADOR(tarefas_nucleo1);
+
+// Histórico da zona selecionada: uma amostra a cada PERIODO_TENDENCIA_S,
+// mesmo com o painel apagado; trocar de zona recomeça o histórico
+static void registrar_tendencia(void) {
+    static uint64_t proxima_us = 0;
+    static uint16_t zona = 0;
+    if (estado_nucleo1.zona != zona) {
+        zona = estado_nucleo1.zona;
+        grafico_serie_limpar(&historico);
+        grafico_invalidar(&linha_tendencia);
+        grafico_invalidar(&grafico_tendencia);
+        proxima_us = estado_nucleo1.instante_us;
+    }
+    if (estado_nucleo1.instante_us >= proxima_us) {
+        grafico_serie_adicionar(&historico, (int16_t)estado_nucleo1.umidade_atual);
+        proxima_us += PERIODO_TENDENCIA_S * 1000000ull;
     }
 }
 
+// Exibição das informações no display: só os widgets cujos valores mudaram
+// são redesenhados e enviados, e os gráficos só rolam quando chega amostra.
+// Com o painel apagado nada é desenhado; ao acender, a tela é atualizada
+// antes de o painel ligar
+void tarefa_display(void) {
+    static ui_tela_t *tela = NULL;
+    static bool tela_ligada = true;
+    caixa_spsc_ler(&caixa_estado, &estado_nucleo1);
+    registrar_tendencia();
+    if (estado_nucleo1.tela_ligada) {
+        ui_tela_t *proxima = &tela_desligado;
+        grafico_t *grafico = NULL;
+        if (estado_nucleo1.sistema_ligado && estado_nucleo1.vista == VISTA_LISTA) {
+            for (uint8_t i = 0; i < NUM_ZONAS; ++i)
+                zona_marcada[i] = i + 1 == estado_nucleo1.zona;
+            proxima = &telas_zonas[(estado_nucleo1.zona - 1) / ZONAS_POR_PAGINA];
+        } else if (estado_nucleo1.sistema_ligado && estado_nucleo1.vista == VISTA_TENDENCIA) {
+            proxima = &tela_tendencia;
+            grafico = &grafico_tendencia;
+            grafico_definir_referencia(grafico, (int16_t)estado_nucleo1.umidade_desejada);
+        } else if (estado_nucleo1.sistema_ligado) {
+            proxima = &tela_ligado;
+            grafico = &linha_tendencia;
+        }
+        tela = trocar_tela(tela, proxima);
+        PERF_MEDIR(ui,
+            ui_atualizar(&ssd, tela);
+            if (grafico)
+                grafico_atualizar(&ssd, grafico));
+        PERF_MEDIR(flush, ssd1306_flush_async(&ssd));
+#if DISPLAY_SECUNDARIO
+        // Com o barramento ocupado pelo principal, o envio entra na fila
+        PERF_MEDIR(ui, ui_atualizar(&ssd_secundario, &tela_secundario));
+        PERF_MEDIR(flush, ssd1306_flush_async(&ssd_secundario));
+#endif
+    }
+    if (estado_nucleo1.tela_ligada != tela_ligada) {
+        tela_ligada = estado_nucleo1.tela_ligada;
+        ssd1306_display(&ssd, tela_ligada);
+#if DISPLAY_SECUNDARIO
+        ssd1306_display(&ssd_secundario, tela_ligada);
+#endif
+        escalonador_definir_periodo(&tarefas_nucleo1[0], tela_ligada ? 200000 : 1000000);
+    }
+}
+
+void tarefa_telemetria(void) {
+    if (!telemetria_ligada)
+        return;
+    PERF_INICIO(telemetria);
+    printf("Zona %d Umidade: %d%% Desejada: %d%% Bomba: %d%% Modo: %s Sistema: %s\n",
+           estado_nucleo1.zona, estado_nucleo1.umidade_atual, estado_nucleo1.umidade_desejada,
+           estado_nucleo1.saida_bomba * 100 / PWM_MAX,
+           estado_nucleo1.modo_manual ? "manual" : "automático",
+           estado_nucleo1.sistema_ligado ? "ligado" : "desligado");
+    PERF_FIM(telemetria);
+}
+
+// Telemetria binária: fecha os lotes completos (e, a cada LATENCIA_LOTE_MS,
+// também o incompleto) e escoa o anel em blocos de até ESCOAMENTO_MAX bytes
+void tarefa_binaria(void) {
+    static uint64_t ultimo_fechamento_us = 0;
+    uint64_t agora = hal_time_us();
+    bool forcar = agora - ultimo_fechamento_us >= LATENCIA_LOTE_MS * 1000u;
+    if (forcar)
+        ultimo_fechamento_us = agora;
+    PERF_MEDIR(binaria,
+        telemetria_processar(&telemetria_binaria, forcar);
+        telemetria_escoar(&telemetria_binaria, ESCOAMENTO_MAX));
+}
+
+// Um passo do núcleo 1: executa as tarefas liberadas e informa até quando dormir
+static uint64_t passo_nucleo1(void) {
+    return escalonador_executar_pendentes(&escalonador_nucleo1);
+}
+
 // =============================================================================
 // FUNÇÃO PRINCIPAL (main)
 // =============================================================================
 int main() {
     // Inicialização do sistema e UART
-    stdio_init_all();
+    hal_stdio_init();
     printf("Iniciando sistema de irrigação...\n");
+    zonas_iniciar(&zonas, NUM_ZONAS, 500, config_pid.saida_min);
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i)
+        zonas_definir_janela(&zonas, i, janela_zona[i][0], janela_zona[i][1]);
+    restaurar_configuracao();
 
     // -------------------------------------------------------------------------
     // Inicialização do ADC para o sensor de umidade e joystick
     // -------------------------------------------------------------------------
     printf("Ligando ADC para o sensor de umidade e joystick...\n");
-    adc_init();
-    adc_gpio_init(SENSOR_UMIDADE);
-    adc_gpio_init(JOYSTICK_Y);
+    const uint8_t entradas = (1 << ADC_SENSOR) | (1 << ADC_JOYSTICK_Y) | (1 << ADC_SENSOR_2);
+    hal_adc_init(entradas);   // GPIOs 26, 27 e 28
+    amostragem_iniciar(entradas, TAXA_AMOSTRAGEM_HZ);
+
+    calibracao_t calibracao_umidade;
+    calibracao_definir(&calibracao_umidade, SENSOR_BRUTO_SECO, 0, SENSOR_BRUTO_MOLHADO, UMIDADE_ESCALA);
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i)
+        filtro_iniciar(&filtro_umidade[i], &config_filtro_umidade, &calibracao_umidade);
+
+    // Centro do joystick medido em repouso (se estiver perto do nominal)
+    hal_sleep_until_us(hal_time_us() + 20000);
+    int32_t centro = amostragem_media(ADC_JOYSTICK_Y, AMOSTRAS_MEDIA);
+    if (abs(centro - CENTRO_Y) < 2 * ZONA_MORTA_Y)
+        joystick_calibrar_centro(&eixo_y, centro);
+
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i) {
+        zonas.umidade[i] = zonas.medida_anterior[i] = ler_umidade_atual(i);
+        planta_iniciar(&planta[i], zonas.umidade[i], PLANTA_TAU_S, PLANTA_GANHO, PWM_MAX);
+    }
+    planta_instante_us = hal_time_us();
+    montar_lista_zonas();
 
     // -------------------------------------------------------------------------
-    // Configuração dos LEDs
+    // Configuração dos LEDs e da bomba (PWM)
     // -------------------------------------------------------------------------
-    printf("Configurando LEDs...\n");
-    gpio_init(LED_VERDE);
-    gpio_set_dir(LED_VERDE, GPIO_OUT);
-    gpio_init(LED_AZUL);
-    gpio_set_dir(LED_AZUL, GPIO_OUT);
-    gpio_init(LED_VERMELHO);
-    gpio_set_dir(LED_VERMELHO, GPIO_OUT);
+    printf("Configurando LEDs e bombas...\n");
+    configurar_pwm(LED_VERDE);
+    configurar_pwm(LED_AZUL);
+    configurar_pwm(LED_VERMELHO);
+    for (uint8_t i = 0; i < NUM_ZONAS; ++i)
+        configurar_pwm(bomba_zona[i]);
 
     // -------------------------------------------------------------------------
     // Configuração dos Botões com Interrupções
     // -------------------------------------------------------------------------
     printf("Ligando botões com interrupções...\n");
-    gpio_init(BOTAO_A);
-    gpio_set_dir(BOTAO_A, GPIO_IN);
-    gpio_pull_up(BOTAO_A);
-    gpio_init(BOTAO_JOYSTICK);
-    gpio_set_dir(BOTAO_JOYSTICK, GPIO_IN);
-    gpio_pull_up(BOTAO_JOYSTICK);
-    gpio_set_irq_enabled_with_callback(BOTAO_A, GPIO_IRQ_EDGE_FALL, true, &interrupcao_botao);
-    gpio_set_irq_enabled_with_callback(BOTAO_JOYSTICK, GPIO_IRQ_EDGE_FALL, true, &interrupcao_botao);
+    hal_gpio_init_input(BOTAO_A, true);
+    hal_gpio_init_input(BOTAO_JOYSTICK, true);
+    const uint32_t bordas = HAL_GPIO_EDGE_FALL | HAL_GPIO_EDGE_RISE;
+    hal_gpio_set_irq(BOTAO_A, bordas, &interrupcao_botao);
+    hal_gpio_set_irq(BOTAO_JOYSTICK, bordas, &interrupcao_botao);
 
     // -------------------------------------------------------------------------
     // Inicialização do I2C e Configuração do Display SSD1306
     // -------------------------------------------------------------------------
     printf("Ligando Display SSD1306 via I2C...\n");
-    i2c_init(PORTA_I2C, 400 * 1000);
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
-    ssd1306_init(&ssd, LARGURA, ALTURA, false, ENDERECO, PORTA_I2C);
+    hal_i2c_init(PORTA_I2C, 400 * 1000, I2C_SDA_PIN, I2C_SCL_PIN);
+    ssd1306_init(&ssd, false, ENDERECO, PORTA_I2C);
     ssd1306_config(&ssd);
     ssd1306_fill(&ssd, false);
     ssd1306_send_data(&ssd);
+#if DISPLAY_SECUNDARIO
+    ssd1306_init(&ssd_secundario, false, ENDERECO_2, PORTA_I2C);
+    ssd1306_config(&ssd_secundario);
+    ssd1306_send_data(&ssd_secundario);
+#endif
 
     // -------------------------------------------------------------------------
-    // Loop Principal do Sistema
+    // Loop Principal do Sistema: o núcleo 1 cuida do display e da telemetria;
+    // o núcleo 0 fica com sensores, controle e LEDs. Em cada núcleo, cada
+    // tarefa roda no seu próprio período e a CPU dorme entre as liberações,
+    // acordada pelo alarme ou pela interrupção dos botões
     // -------------------------------------------------------------------------
-    while (1) {
-        if (sistema_ligado) {
-            // Leitura da umidade atual (simulada)
-            umidade_atual = ler_umidade_atual();
-
-            // Ajuste da umidade desejada com o joystick
-            adc_select_input(1);   // Eixo Y do joystick
-            uint16_t valor_y = adc_read();
-            umidade_desejada = (valor_y * 100) / 4095;
-
-            // Simulação de aumento da umidade no modo automático
-            if (!modo_manual && umidade_atual < umidade_desejada) {
-                umidade_atual++;
-                sleep_ms(100); // Espera 100 ms antes de aumentar a umidade
-            }
-
-            // Atualização dos LEDs
-            atualizar_leds(umidade_atual, umidade_desejada);
-
-            // Exibição das informações no display
-            char buffer[50];
-            ssd1306_fill(&ssd, false);
-            snprintf(buffer, sizeof(buffer), "Umidade: %d%%", umidade_atual);
-            ssd1306_text(&ssd, buffer, 0, 0, true);
-            snprintf(buffer, sizeof(buffer), "Desejada: %d%%", umidade_desejada);
-            ssd1306_text(&ssd, buffer, 0, 20, true);
-            snprintf(buffer, sizeof(buffer), "Modo: %s", modo_manual ? "Manual" : "Auto");
-            ssd1306_text(&ssd, buffer, 0, 40, true);
-            ssd1306_send_data(&ssd);
-        } else {
-            // Sistema desligado: apaga os LEDs e exibe mensagem no display
-            gpio_put(LED_VERDE, 0);
-            gpio_put(LED_AZUL, 0);
-            gpio_put(LED_VERMELHO, 0);
-            ssd1306_fill(&ssd, false);
-            ssd1306_text(&ssd, "Sistema Desligado", 0, 20, true);
-            ssd1306_send_data(&ssd);
-        }
+    energia_iniciar(&energia, &config_energia, hal_time_us());
+    escalonador_iniciar(&escalonador_nucleo1);
+    hal_core1_launch(passo_nucleo1);
 
-        sleep_ms(500);  // Atualiza a cada 500ms
+    escalonador_iniciar(&escalonador_nucleo0);
+    while (hal_running()) {
+        escalonador_passo(&escalonador_nucleo0);
     }
-    
+
+    // Só no host o laço termina: grava o que estava pendente (como faria
+    // uma rotina de desligamento) e mostra o relatório da execução simulada
+    armazenamento_confirmar(&armazenamento);
+    armazenamento_descarregar(&armazenamento);
+    imprimir_relatorios();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "amostragem.h"
+
+#define AMOSTRAGEM_MASCARA  (AMOSTRAGEM_TAMANHO - 1)
+#define AMOSTRAGEM_ENTRADAS 5
+
+// O endereço de escrita do DMA dá a volta no anel, que precisa estar alinhado
+// ao próprio tamanho em bytes
+static volatile uint16_t anel[AMOSTRAGEM_TAMANHO] __attribute__((aligned(AMOSTRAGEM_TAMANHO * sizeof(uint16_t))));
+
+static uint8_t quantidade_entradas;
+static int8_t posicao[AMOSTRAGEM_ENTRADAS];   // Posição de cada entrada no round-robin
+static uint32_t taxa_total_hz;
+static uint32_t taxa_anterior_hz;
+static uint64_t ancora;        // Contagem na última mudança de taxa
+static uint64_t ancora_us;     // Instante da última mudança de taxa
+
+void amostragem_iniciar(uint8_t mascara, uint32_t taxa_hz) {
+  quantidade_entradas = 0;
+  for (uint8_t i = 0; i < AMOSTRAGEM_ENTRADAS; ++i)
+    posicao[i] = (mascara & (1u << i)) ? (int8_t)quantidade_entradas++ : -1;
+  taxa_total_hz = taxa_anterior_hz = taxa_hz * quantidade_entradas;
+  hal_adc_stream_start(mascara, taxa_hz, anel, AMOSTRAGEM_TAMANHO);
+  ancora = 0;
+  ancora_us = hal_adc_stream_start_us();
+}
+
+void amostragem_definir_taxa(uint32_t taxa_hz) {
+  uint32_t nova = taxa_hz * quantidade_entradas;
+  if (nova == taxa_total_hz)
+    return;
+  ancora = hal_adc_stream_count();
+  ancora_us = hal_time_us();
+  if (taxa_total_hz)
+    taxa_anterior_hz = taxa_total_hz;
+  taxa_total_hz = nova;
+  hal_adc_stream_set_rate(taxa_hz);
+}
+
+// Índice global da amostra mais recente da entrada dentre as total gravadas
+static bool amostragem_indice_ultima(uint8_t entrada, uint64_t total, uint64_t *indice) {
+  if (entrada >= AMOSTRAGEM_ENTRADAS || posicao[entrada] < 0)
+    return false;
+  uint64_t pos = (uint64_t)posicao[entrada];
+  if (total <= pos)
+    return false;
+  *indice = total - 1 - ((total - 1 - pos) % quantidade_entradas);
+  return true;
+}
+
+// Instante estimado a partir da última mudança de taxa (amostras anteriores a
+// ela usam a taxa anterior)
+static uint64_t amostragem_instante(uint64_t indice) {
+  if (indice >= ancora && taxa_total_hz)
+    return ancora_us + (indice - ancora) * 1000000u / taxa_total_hz;
+  return ancora_us - (ancora - indice) * 1000000u / taxa_anterior_hz;
+}
+
+// Lê as n amostras mais recentes da entrada, copiando-as para destino (se não
+// for NULL) e acumulando a soma em soma (se não for NULL)
+static uint16_t amostragem_ler(uint8_t entrada, uint16_t *destino, uint32_t *soma,
+                               uint16_t n, uint64_t *instante_us) {
+  // Uma amostra k só é segura enquanto k + TAMANHO não foi gravada; a folga de
+  // uma amostra cobre a escrita em andamento
+  if (quantidade_entradas == 0)
+    return 0;
+  uint16_t capacidade = (AMOSTRAGEM_TAMANHO - 2) / quantidade_entradas;
+  if (n > capacidade)
+    n = capacidade;
+  if (n == 0)
+    return 0;
+
+  for (;;) {
+    uint64_t total = hal_adc_stream_count();
+    uint64_t ultima;
+    if (!amostragem_indice_ultima(entrada, total, &ultima))
+      return 0;
+    uint64_t disponiveis = ultima / quantidade_entradas + 1;
+    uint16_t copiar = (disponiveis < n) ? (uint16_t)disponiveis : n;
+    uint64_t primeira = ultima - (uint64_t)(copiar - 1) * quantidade_entradas;
+
+    uint64_t k = primeira;
+    uint32_t acumulado = 0;
+    for (uint16_t i = 0; i < copiar; ++i, k += quantidade_entradas) {
+      uint16_t valor = anel[k & AMOSTRAGEM_MASCARA];
+      acumulado += valor;
+      if (destino)
+        destino[i] = valor;
+    }
+
+    if (hal_adc_stream_count() + 1 < primeira + AMOSTRAGEM_TAMANHO) {
+      if (instante_us)
+        *instante_us = amostragem_instante(ultima);
+      if (soma)
+        *soma = acumulado;
+      return copiar;
+    }
+    // O DMA sobrescreveu parte da cópia: tenta de novo com a posição atual
+  }
+}
+
+uint16_t amostragem_copiar(uint8_t entrada, uint16_t *destino, uint16_t n, uint64_t *instante_us) {
+  return amostragem_ler(entrada, destino, NULL, n, instante_us);
+}
+
+uint16_t amostragem_novas(uint8_t entrada, uint16_t *destino, uint16_t max, uint64_t *cursor) {
+  if (quantidade_entradas == 0)
+    return 0;
+  uint16_t capacidade = (AMOSTRAGEM_TAMANHO - 2) / quantidade_entradas;
+  if (max > capacidade)
+    max = capacidade;
+
+  for (;;) {
+    uint64_t total = hal_adc_stream_count();
+    uint64_t ultima;
+    if (max == 0 || !amostragem_indice_ultima(entrada, total, &ultima))
+      return 0;
+    uint64_t seq_ultima = ultima / quantidade_entradas;
+    if (seq_ultima < *cursor)
+      return 0;
+    uint64_t seq = *cursor;
+    if (seq_ultima - seq + 1 > max)
+      seq = seq_ultima + 1 - max;  // Atrasado: pula as mais antigas
+    uint16_t copiar = (uint16_t)(seq_ultima - seq + 1);
+    uint64_t primeira = ultima - (uint64_t)(copiar - 1) * quantidade_entradas;
+
+    uint64_t k = primeira;
+    for (uint16_t i = 0; i < copiar; ++i, k += quantidade_entradas)
+      destino[i] = anel[k & AMOSTRAGEM_MASCARA];
+
+    if (hal_adc_stream_count() + 1 < primeira + AMOSTRAGEM_TAMANHO) {
+      *cursor = seq_ultima + 1;
+      return copiar;
+    }
+  }
+}
+
+bool amostragem_ultima(uint8_t entrada, amostra_t *amostra) {
+  uint16_t valor;
+  uint64_t instante;
+  if (amostragem_copiar(entrada, &valor, 1, &instante) == 0)
+    return false;
+  amostra->valor = valor;
+  amostra->instante_us = instante;
+  return true;
+}
+
+uint16_t amostragem_media(uint8_t entrada, uint16_t n) {
+  uint32_t soma;
+  uint16_t lidas = amostragem_ler(entrada, NULL, &soma, n, NULL);
+  return lidas ? soma / lidas : 0;
+}
@@ -0,0 +1,47 @@
+#ifndef AMOSTRAGEM_H
+#define AMOSTRAGEM_H
+
+#include "hal.h"
+
+// =============================================================================
+// AMOSTRAGEM CONTÍNUA DO ADC
+// O ADC converte em round-robin as entradas escolhidas e o DMA grava as
+// amostras num anel circular, sem uso da CPU. Os leitores tiram cópias do anel
+// sem travas: a posição de escrita é lida antes e depois da cópia e, se o DMA
+// tiver alcançado as amostras copiadas, a cópia é refeita.
+// =============================================================================
+
+#define AMOSTRAGEM_TAMANHO 512   // Amostras no anel, somando as entradas (potência de 2)
+
+typedef struct {
+  uint16_t valor;          // Leitura de 12 bits
+  uint64_t instante_us;    // Instante da conversão (microssegundos desde o boot)
+} amostra_t;
+
+// Inicia a conversão contínua das entradas de mascara (bit 0 = GPIO26, bit 1 =
+// GPIO27, ...) a taxa_hz amostras por segundo em cada entrada
+void amostragem_iniciar(uint8_t mascara, uint32_t taxa_hz);
+
+// Muda a taxa por entrada sem perder a sequência das amostras (cursores de
+// amostragem_novas continuam válidos); 0 pausa a conversão
+void amostragem_definir_taxa(uint32_t taxa_hz);
+
+// Copia as n amostras mais recentes da entrada para destino, da mais antiga para
+// a mais nova. Retorna quantas foram copiadas (menos que n no início da
+// aquisição ou se n passar da capacidade por entrada). Se instante_us não for
+// NULL, recebe o instante da amostra mais nova.
+uint16_t amostragem_copiar(uint8_t entrada, uint16_t *destino, uint16_t n, uint64_t *instante_us);
+
+// Copia até max amostras da entrada gravadas a partir de *cursor (número de
+// sequência da próxima amostra esperada naquela entrada; comece com 0) e avança
+// o cursor. Se o leitor atrasar mais que a capacidade do anel, as amostras
+// perdidas são puladas. Retorna quantas foram copiadas.
+uint16_t amostragem_novas(uint8_t entrada, uint16_t *destino, uint16_t max, uint64_t *cursor);
+
+// Amostra mais recente da entrada; false se ainda não houver nenhuma
+bool amostragem_ultima(uint8_t entrada, amostra_t *amostra);
+
+// Média das n amostras mais recentes da entrada (0 se não houver amostras)
+uint16_t amostragem_media(uint8_t entrada, uint16_t n);
+
+#endif
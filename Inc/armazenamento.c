@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <string.h>
+#include "armazenamento.h"
+#include "crc16.h"
+
+// Página: marca (2) | CRC (2) | sequência (4) | carga. O CRC cobre da
+// sequência ao fim da página; os bytes não usados da carga ficam em 0xFF.
+#define CABECALHO          8
+#define CARGA              (HAL_FLASH_PAGE_SIZE - CABECALHO)
+#define PAGINAS_POR_SETOR  (HAL_FLASH_SECTOR_SIZE / HAL_FLASH_PAGE_SIZE)
+#define MARCA_KV           0x564B   // "KV"
+#define MARCA_LOG          0x474C   // "LG"
+#define FIM_DAS_CHAVES     0xFF
+
+_Static_assert(ARMAZENAMENTO_CHAVES * (2 + ARMAZENAMENTO_VALOR_MAX) <= CARGA,
+               "todas as chaves precisam caber numa página");
+_Static_assert(4 + ARMAZENAMENTO_AMOSTRAS_PAGINA * sizeof(amostra_log_t) <= CARGA,
+               "as amostras precisam caber numa página");
+
+static uint32_t ler32(const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// -----------------------------------------------------------------------------
+// ANEL DE SETORES
+// -----------------------------------------------------------------------------
+static void anel_configurar(anel_flash_t *anel, uint16_t marca, uint32_t primeiro_setor, uint32_t setores) {
+  memset(anel, 0, sizeof(*anel));
+  anel->marca = marca;
+  anel->inicio = primeiro_setor * HAL_FLASH_SECTOR_SIZE;
+  anel->paginas = (uint16_t)(setores * PAGINAS_POR_SETOR);
+}
+
+static const uint8_t *anel_pagina(const anel_flash_t *anel, uint16_t i) {
+  return hal_flash_read(anel->inicio + (uint32_t)i * HAL_FLASH_PAGE_SIZE);
+}
+
+static bool pagina_valida(const anel_flash_t *anel, const uint8_t *p) {
+  return (p[0] | p[1] << 8) == anel->marca &&
+         (p[2] | p[3] << 8) == crc16_ccitt(p + 4, HAL_FLASH_PAGE_SIZE - 4);
+}
+
+static bool pagina_apagada(const uint8_t *p) {
+  for (uint32_t i = 0; i < HAL_FLASH_PAGE_SIZE; ++i)
+    if (p[i] != 0xFF)
+      return false;
+  return true;
+}
+
+// Percorre as páginas válidas (em ordem de posição, não de sequência) e
+// posiciona a gravação logo depois da de maior sequência
+static void anel_percorrer(anel_flash_t *anel,
+                           void (*tratar)(const uint8_t *pagina, uint32_t sequencia, void *contexto),
+                           void *contexto) {
+  bool achou = false;
+  uint32_t maior = 0;
+  uint16_t posicao = 0;
+  for (uint16_t i = 0; i < anel->paginas; ++i) {
+    const uint8_t *p = anel_pagina(anel, i);
+    if (!pagina_valida(anel, p))
+      continue;
+    uint32_t sequencia = ler32(p + 4);
+    tratar(p, sequencia, contexto);
+    if (!achou || (int32_t)(sequencia - maior) > 0) {
+      maior = sequencia;
+      posicao = i;
+      achou = true;
+    }
+  }
+  anel->proxima = achou ? (uint16_t)((posicao + 1) % anel->paginas) : 0;
+  anel->sequencia = achou ? maior + 1 : 1;
+}
+
+// Pula as páginas deixadas sujas por gravações interrompidas; retorna true se
+// a próxima gravação começa um setor (que será apagado antes)
+static bool anel_preparar(anel_flash_t *anel) {
+  while (anel->proxima % PAGINAS_POR_SETOR && !pagina_apagada(anel_pagina(anel, anel->proxima)))
+    anel->proxima = (uint16_t)((anel->proxima + 1) % anel->paginas);
+  return anel->proxima % PAGINAS_POR_SETOR == 0;
+}
+
+// Completa o cabeçalho de pagina e a grava na próxima posição livre
+static bool anel_gravar(anel_flash_t *anel, uint8_t *pagina) {
+  bool novo_setor = anel_preparar(anel);
+  uint32_t endereco = anel->inicio + (uint32_t)anel->proxima * HAL_FLASH_PAGE_SIZE;
+  if (novo_setor) {
+    if (!hal_flash_erase(endereco))
+      return false;
+    anel->apagamentos++;
+  }
+  pagina[0] = (uint8_t)anel->marca;
+  pagina[1] = (uint8_t)(anel->marca >> 8);
+  for (int i = 0; i < 4; ++i)
+    pagina[4 + i] = (uint8_t)(anel->sequencia >> (8 * i));
+  uint16_t crc = crc16_ccitt(pagina + 4, HAL_FLASH_PAGE_SIZE - 4);
+  pagina[2] = (uint8_t)crc;
+  pagina[3] = (uint8_t)(crc >> 8);
+  // Se falhar, a posição não avança: uma página meio gravada é pulada por
+  // anel_preparar na próxima tentativa
+  if (!hal_flash_program(endereco, pagina))
+    return false;
+  anel->proxima = (uint16_t)((anel->proxima + 1) % anel->paginas);
+  anel->sequencia++;
+  anel->gravacoes++;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// CHAVE/VALOR
+// -----------------------------------------------------------------------------
+typedef struct {
+  armazenamento_t *a;
+  uint32_t sequencia[ARMAZENAMENTO_CHAVES];   // Página de onde veio cada valor
+} leitura_kv_t;
+
+static void aplicar_pagina_kv(const uint8_t *pagina, uint32_t sequencia, void *contexto) {
+  leitura_kv_t *l = contexto;
+  const uint8_t *p = pagina + CABECALHO;
+  const uint8_t *fim = pagina + HAL_FLASH_PAGE_SIZE;
+  while (p + 2 <= fim && p[0] != FIM_DAS_CHAVES) {
+    uint8_t chave = p[0], tamanho = p[1];
+    if (chave >= ARMAZENAMENTO_CHAVES || tamanho == 0 || tamanho > ARMAZENAMENTO_VALOR_MAX ||
+        p + 2 + tamanho > fim)
+      return;
+    // Vale o valor da página mais recente
+    if (!l->a->tamanhos[chave] || (int32_t)(sequencia - l->sequencia[chave]) >= 0) {
+      memcpy(l->a->valores[chave], p + 2, tamanho);
+      l->a->tamanhos[chave] = tamanho;
+      l->sequencia[chave] = sequencia;
+    }
+    p += 2 + tamanho;
+  }
+}
+
+bool armazenamento_ler(const armazenamento_t *a, uint8_t chave, void *valor, uint8_t tamanho) {
+  if (chave >= ARMAZENAMENTO_CHAVES || !a->tamanhos[chave])
+    return false;
+  memcpy(valor, a->valores[chave], tamanho < a->tamanhos[chave] ? tamanho : a->tamanhos[chave]);
+  return true;
+}
+
+bool armazenamento_escrever(armazenamento_t *a, uint8_t chave, const void *valor, uint8_t tamanho) {
+  if (chave >= ARMAZENAMENTO_CHAVES || tamanho == 0 || tamanho > ARMAZENAMENTO_VALOR_MAX)
+    return false;
+  if (a->tamanhos[chave] == tamanho && memcmp(a->valores[chave], valor, tamanho) == 0)
+    return false;
+  memcpy(a->valores[chave], valor, tamanho);
+  a->tamanhos[chave] = tamanho;
+  a->sujas |= (uint16_t)(1u << chave);
+  return true;
+}
+
+bool armazenamento_confirmar(armazenamento_t *a) {
+  if (!a->sujas)
+    return true;
+  // Primeira página de um setor: cópia de todas as chaves
+  bool copia = anel_preparar(&a->kv);
+  memset(a->pagina, 0xFF, sizeof(a->pagina));
+  uint8_t *p = a->pagina + CABECALHO;
+  for (uint8_t chave = 0; chave < ARMAZENAMENTO_CHAVES; ++chave) {
+    if (!a->tamanhos[chave] || !(copia || (a->sujas & (1u << chave))))
+      continue;
+    *p++ = chave;
+    *p++ = a->tamanhos[chave];
+    memcpy(p, a->valores[chave], a->tamanhos[chave]);
+    p += a->tamanhos[chave];
+  }
+  if (!anel_gravar(&a->kv, a->pagina))
+    return false;
+  a->sujas = 0;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// AMOSTRAS
+// -----------------------------------------------------------------------------
+static void ignorar_pagina(const uint8_t *pagina, uint32_t sequencia, void *contexto) {
+  (void)pagina;
+  (void)sequencia;
+  (void)contexto;
+}
+
+static bool gravar_amostras(armazenamento_t *a) {
+  memset(a->pagina, 0xFF, sizeof(a->pagina));
+  a->pagina[CABECALHO] = a->amostras_na_ram;
+  memcpy(a->pagina + CABECALHO + 4, a->amostras, a->amostras_na_ram * sizeof(amostra_log_t));
+  if (!anel_gravar(&a->log, a->pagina))
+    return false;
+  a->amostras_na_ram = 0;
+  return true;
+}
+
+bool armazenamento_registrar(armazenamento_t *a, const amostra_log_t *amostra) {
+  // Página anterior ainda não gravada: tenta de novo antes de aceitar mais
+  if (a->amostras_na_ram == ARMAZENAMENTO_AMOSTRAS_PAGINA && !gravar_amostras(a))
+    return false;
+  a->amostras[a->amostras_na_ram++] = *amostra;
+  if (a->amostras_na_ram == ARMAZENAMENTO_AMOSTRAS_PAGINA)
+    return gravar_amostras(a);
+  return true;
+}
+
+bool armazenamento_descarregar(armazenamento_t *a) {
+  return a->amostras_na_ram == 0 || gravar_amostras(a);
+}
+
+uint32_t armazenamento_percorrer(const armazenamento_t *a,
+                                 void (*tratar)(const amostra_log_t *amostra, void *contexto),
+                                 void *contexto) {
+  // A página seguinte à última gravada é a mais antiga (ou está apagada)
+  uint32_t total = 0;
+  for (uint16_t i = 0; i < a->log.paginas; ++i) {
+    const uint8_t *p = anel_pagina(&a->log, (uint16_t)((a->log.proxima + i) % a->log.paginas));
+    if (!pagina_valida(&a->log, p))
+      continue;
+    uint8_t n = p[CABECALHO];
+    if (n > ARMAZENAMENTO_AMOSTRAS_PAGINA)
+      continue;
+    for (uint8_t k = 0; k < n; ++k) {
+      amostra_log_t amostra;
+      memcpy(&amostra, p + CABECALHO + 4 + k * sizeof(amostra_log_t), sizeof(amostra));
+      tratar(&amostra, contexto);
+    }
+    total += n;
+  }
+  return total;
+}
+
+// -----------------------------------------------------------------------------
+// PARTIDA E RELATÓRIO
+// -----------------------------------------------------------------------------
+void armazenamento_iniciar(armazenamento_t *a) {
+  memset(a, 0, sizeof(*a));
+  anel_configurar(&a->kv, MARCA_KV, 0, ARMAZENAMENTO_SETORES_KV);
+  anel_configurar(&a->log, MARCA_LOG, ARMAZENAMENTO_SETORES_KV, ARMAZENAMENTO_SETORES_LOG);
+  leitura_kv_t leitura = { .a = a };
+  anel_percorrer(&a->kv, aplicar_pagina_kv, &leitura);
+  anel_percorrer(&a->log, ignorar_pagina, NULL);
+}
+
+void armazenamento_relatorio(const armazenamento_t *a) {
+  printf("flash       paginas  apagamentos  sequencia\n");
+  printf("chaves      %7lu  %11lu  %9lu\n", (unsigned long)a->kv.gravacoes,
+         (unsigned long)a->kv.apagamentos, (unsigned long)a->kv.sequencia);
+  printf("amostras    %7lu  %11lu  %9lu  (%u na RAM)\n", (unsigned long)a->log.gravacoes,
+         (unsigned long)a->log.apagamentos, (unsigned long)a->log.sequencia, a->amostras_na_ram);
+}
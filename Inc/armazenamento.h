@@ -0,0 +1,90 @@
+#ifndef ARMAZENAMENTO_H
+#define ARMAZENAMENTO_H
+
+#include "hal.h"
+
+// =============================================================================
+// CONFIGURAÇÃO E REGISTRO DE AMOSTRAS NA FLASH
+// A área de dados da HAL é dividida em dois anéis de setores, gravados uma
+// página por vez, em ordem, e apagados um setor à frente: o desgaste fica
+// distribuído igualmente entre os setores de cada anel.
+//
+// Toda página gravada tem cabeçalho com marca, número de sequência e CRC: uma
+// gravação interrompida por queda de energia fica com o CRC errado e é
+// ignorada (a página é pulada na próxima gravação). Um único percurso pelos
+// anéis, na partida, reconstrói o estado.
+//
+// - Chave/valor: cada confirmação grava numa página só as chaves alteradas
+//   (o valor mais recente de cada chave é o da página de maior sequência).
+//   A primeira página de cada setor é uma cópia de todas as chaves, então o
+//   setor seguinte (o mais antigo) sempre pode ser apagado sem perder nada.
+// - Amostras: ARMAZENAMENTO_AMOSTRAS_PAGINA amostras acumulam na RAM e vão
+//   juntas para uma página; com o anel cheio, as mais antigas são apagadas.
+//   Numa queda de energia, perdem-se só as amostras ainda na RAM.
+// =============================================================================
+
+#define ARMAZENAMENTO_CHAVES       16   // Chaves 0..15
+#define ARMAZENAMENTO_VALOR_MAX    8    // Bytes por valor
+#define ARMAZENAMENTO_SETORES_KV   4
+#define ARMAZENAMENTO_SETORES_LOG  (HAL_FLASH_AREA_SIZE / HAL_FLASH_SECTOR_SIZE - ARMAZENAMENTO_SETORES_KV)
+#define ARMAZENAMENTO_AMOSTRAS_PAGINA 20
+
+typedef struct {
+  uint32_t instante_s;
+  int16_t umidade;          // Décimos de porcento
+  uint16_t desejada;        // Décimos de porcento
+  uint16_t bomba;           // Nível de PWM
+  uint8_t flags;
+  uint8_t reservado;
+} amostra_log_t;
+
+// Anel de setores gravado página a página
+typedef struct {
+  uint16_t marca;           // Distingue as páginas de cada anel
+  uint32_t inicio;          // Deslocamento do primeiro setor na área da HAL
+  uint16_t paginas;
+  uint16_t proxima;         // Próxima página a gravar
+  uint32_t sequencia;       // Sequência da próxima página
+  uint32_t gravacoes;       // Páginas gravadas desde a partida
+  uint32_t apagamentos;     // Setores apagados desde a partida
+} anel_flash_t;
+
+typedef struct {
+  anel_flash_t kv;
+  anel_flash_t log;
+  uint8_t valores[ARMAZENAMENTO_CHAVES][ARMAZENAMENTO_VALOR_MAX];
+  uint8_t tamanhos[ARMAZENAMENTO_CHAVES];   // 0 = chave ausente
+  uint16_t sujas;                           // Bit por chave ainda não confirmada
+  amostra_log_t amostras[ARMAZENAMENTO_AMOSTRAS_PAGINA];
+  uint8_t amostras_na_ram;
+  uint8_t pagina[HAL_FLASH_PAGE_SIZE];      // Montagem da página (na RAM, como o SDK exige)
+} armazenamento_t;
+
+// Percorre os dois anéis e reconstrói as chaves e as posições de gravação
+void armazenamento_iniciar(armazenamento_t *a);
+
+// Copia o valor da chave (até tamanho bytes); false se a chave não existe
+bool armazenamento_ler(const armazenamento_t *a, uint8_t chave, void *valor, uint8_t tamanho);
+
+// Altera a chave só na RAM; retorna true se o valor mudou (fica pendente)
+bool armazenamento_escrever(armazenamento_t *a, uint8_t chave, const void *valor, uint8_t tamanho);
+
+// Grava numa página as chaves pendentes; true se não sobrou nada pendente
+bool armazenamento_confirmar(armazenamento_t *a);
+
+// Acumula a amostra; grava uma página quando completa. false se a gravação
+// falhou (a página fica na RAM para a próxima tentativa)
+bool armazenamento_registrar(armazenamento_t *a, const amostra_log_t *amostra);
+
+// Grava a página de amostras incompleta (antes de desligar, por exemplo)
+bool armazenamento_descarregar(armazenamento_t *a);
+
+// Chama tratar para cada amostra gravada, da mais antiga à mais recente;
+// retorna quantas foram
+uint32_t armazenamento_percorrer(const armazenamento_t *a,
+                                 void (*tratar)(const amostra_log_t *amostra, void *contexto),
+                                 void *contexto);
+
+void armazenamento_relatorio(const armazenamento_t *a);
+
+#endif
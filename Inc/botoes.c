@@ -0,0 +1,97 @@
+#include "botoes.h"
+#include "fila_spsc.h"
+
+typedef struct {
+  uint64_t instante_us;
+  uint8_t gpio;
+  bool apertado;
+} botao_evento_t;
+
+// Produtor: a interrupção de GPIO; consumidor: botoes_processar
+FILA_SPSC_DEFINIR(fila_eventos, botao_evento_t, 32);
+
+void botoes_registrar_em(uint8_t gpio, bool apertado, uint64_t instante_us) {
+  botao_evento_t evento = { .instante_us = instante_us, .gpio = gpio, .apertado = apertado };
+  fila_spsc_enviar(&fila_eventos, &evento);
+}
+
+void botoes_registrar(uint8_t gpio) {
+  // Ativo em nível baixo (pull-up)
+  botoes_registrar_em(gpio, !hal_gpio_get(gpio), hal_time_us());
+}
+
+// Emite o clique guardado se a janela do duplo clique já passou
+static void liberar_clique(const botoes_t *b, botao_t *bt, uint64_t agora_us) {
+  if (bt->clique_pendente && agora_us - bt->solto_us > bt->duplo_us) {
+    bt->clique_pendente = false;
+    b->tratador(bt->gpio, BOTAO_CLIQUE);
+  }
+}
+
+// Avança a máquina de estados de um botão até o instante agora_us
+static void avaliar(const botoes_t *b, botao_t *bt, uint64_t agora_us) {
+  // Nível parado há tempo suficiente: a transição vale a partir da última borda
+  if (bt->bruto != bt->estavel && agora_us - bt->borda_us >= b->antirrebote_us) {
+    bt->estavel = bt->bruto;
+    if (bt->estavel) {
+      bt->pressionado_us = bt->borda_us;
+      bt->longo_emitido = false;
+      liberar_clique(b, bt, bt->pressionado_us);
+      b->tratador(bt->gpio, BOTAO_PRESSIONADO);
+    } else {
+      b->tratador(bt->gpio, BOTAO_SOLTO);
+      if (!bt->longo_emitido) {
+        if (bt->clique_pendente) {
+          bt->clique_pendente = false;
+          b->tratador(bt->gpio, BOTAO_DUPLO_CLIQUE);
+        } else if (bt->duplo_us) {
+          bt->clique_pendente = true;
+          bt->solto_us = bt->borda_us;
+        } else {
+          b->tratador(bt->gpio, BOTAO_CLIQUE);
+        }
+      }
+    }
+  }
+
+  if (bt->estavel) {
+    if (!bt->longo_emitido && agora_us - bt->pressionado_us >= b->longo_us) {
+      bt->longo_emitido = true;
+      if (bt->clique_pendente) {
+        bt->clique_pendente = false;
+        b->tratador(bt->gpio, BOTAO_CLIQUE);
+      }
+      b->tratador(bt->gpio, BOTAO_LONGO);
+    }
+  } else {
+    liberar_clique(b, bt, agora_us);
+  }
+}
+
+static botao_t *procurar(botoes_t *b, uint8_t gpio) {
+  for (uint8_t i = 0; i < b->quantidade; ++i)
+    if (b->botoes[i].gpio == gpio)
+      return &b->botoes[i];
+  return NULL;
+}
+
+void botoes_processar(botoes_t *b, uint64_t agora_us) {
+  botao_evento_t evento;
+  while (fila_spsc_receber(&fila_eventos, &evento)) {
+    botao_t *bt = procurar(b, evento.gpio);
+    if (!bt)
+      continue;
+    // Um evento registrado depois de agora_us (interrupção durante o
+    // processamento) empurra o instante de avaliação para frente
+    if (evento.instante_us > agora_us)
+      agora_us = evento.instante_us;
+    avaliar(b, bt, evento.instante_us);
+    // Toda borda reinicia a contagem do antirrebote, mesmo quando o repique
+    // terminou no nível anterior
+    bt->bruto = evento.apertado;
+    bt->borda_us = evento.instante_us;
+  }
+  for (uint8_t i = 0; i < b->quantidade; ++i)
+    avaliar(b, &b->botoes[i], agora_us);
+  b->descartados = fila_eventos.descartadas;
+}
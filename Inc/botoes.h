@@ -0,0 +1,67 @@
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include "hal.h"
+
+// =============================================================================
+// EVENTOS DE BOTÕES
+// A interrupção de GPIO só registra o pino, o nível lido e o instante numa
+// fila sem travas (botoes_registrar). O nível, e não as bordas, decide o
+// estado: quando o pino repica antes da interrupção ser atendida, descida e
+// subida chegam num só evento e só a leitura diz onde o pino parou. Antirrebote e detecção de clique, duplo
+// clique e pressão longa rodam em contexto de tarefa (botoes_processar), que
+// entrega os gestos a um tratador. Botões ativos em nível baixo (pull-up).
+// =============================================================================
+
+typedef enum {
+  BOTAO_PRESSIONADO,     // Pressão confirmada pelo antirrebote
+  BOTAO_SOLTO,           // Soltura confirmada pelo antirrebote
+  BOTAO_CLIQUE,
+  BOTAO_DUPLO_CLIQUE,
+  BOTAO_LONGO,           // Emitido uma vez, ainda com o botão pressionado
+} botao_gesto_t;
+
+typedef void (*botao_tratador_t)(uint8_t gpio, botao_gesto_t gesto);
+
+typedef struct {
+  uint8_t gpio;
+  uint32_t duplo_us;          // Janela do duplo clique (0 = sem duplo clique;
+                              // com janela, o clique simples sai atrasado dela)
+
+  // Estado
+  bool bruto;                 // Último nível lido pela interrupção (true = apertado)
+  bool estavel;               // Nível confirmado pelo antirrebote
+  bool longo_emitido;
+  bool clique_pendente;       // Clique esperando a janela do duplo clique
+  uint64_t borda_us;          // Instante da última borda
+  uint64_t pressionado_us;
+  uint64_t solto_us;
+} botao_t;
+
+typedef struct {
+  botao_t *botoes;
+  uint8_t quantidade;
+  botao_tratador_t tratador;
+  uint32_t antirrebote_us;    // Tempo sem bordas para confirmar um nível
+  uint32_t longo_us;          // Duração da pressão longa
+  uint32_t descartados;       // Eventos perdidos por fila cheia
+} botoes_t;
+
+#define BOTAO(pino, duplo) { .gpio = (pino), .duplo_us = (duplo) }
+
+#define BOTOES(vetor, funcao, antirrebote, longo) \
+  { .botoes = (vetor), .quantidade = sizeof(vetor) / sizeof((vetor)[0]), \
+    .tratador = (funcao), .antirrebote_us = (antirrebote), .longo_us = (longo) }
+
+// Chamada pela interrupção de qualquer borda: lê o nível atual do pino
+void botoes_registrar(uint8_t gpio);
+
+// Versão com nível e instante explícitos (para o host e para repetir
+// sequências gravadas); apertado = pino em nível baixo
+void botoes_registrar_em(uint8_t gpio, bool apertado, uint64_t instante_us);
+
+// Contexto de tarefa: consome a fila, aplica o antirrebote e chama o tratador
+// para cada gesto detectado até o instante agora_us
+void botoes_processar(botoes_t *b, uint64_t agora_us);
+
+#endif
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include "console.h"
+
+// -----------------------------------------------------------------------------
+// RECEPÇÃO
+// -----------------------------------------------------------------------------
+bool console_alimentar(console_t *c, uint8_t byte) {
+  if (c->cabeca - c->cauda == CONSOLE_ANEL) {
+    c->perdidos++;
+    return false;
+  }
+  c->anel[c->cabeca++ & (CONSOLE_ANEL - 1)] = byte;
+  return true;
+}
+
+void console_receber(console_t *c) {
+  while (c->cabeca - c->cauda < CONSOLE_ANEL) {
+    int byte = hal_stdio_read();
+    if (byte < 0)
+      break;
+    c->anel[c->cabeca++ & (CONSOLE_ANEL - 1)] = (uint8_t)byte;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESPACHO
+// -----------------------------------------------------------------------------
+static void listar_comandos(const console_t *c) {
+  for (uint8_t i = 0; i < c->quantidade; ++i)
+    printf("  %-11s %s\n", c->comandos[i].nome, c->comandos[i].ajuda);
+  printf("  %-11s %s\n", "ajuda", "lista os comandos");
+}
+
+// Separa as palavras no próprio buffer da linha e chama o comando
+static void executar_linha(console_t *c) {
+  char *argv[CONSOLE_ARGUMENTOS];
+  uint8_t argc = 0;
+  char *p = c->linha;
+  for (;;) {
+    while (*p == ' ' || *p == '\t')
+      *p++ = '\0';
+    if (!*p)
+      break;
+    if (argc == CONSOLE_ARGUMENTOS) {
+      c->erros++;
+      printf("erro: argumentos demais\n");
+      return;
+    }
+    argv[argc++] = p;
+    while (*p && *p != ' ' && *p != '\t')
+      p++;
+  }
+  if (argc == 0)
+    return;   // Linha vazia
+
+  c->linhas++;
+  if (strcmp(argv[0], "ajuda") == 0) {
+    listar_comandos(c);
+    return;
+  }
+  for (uint8_t i = 0; i < c->quantidade; ++i) {
+    const console_comando_t *comando = &c->comandos[i];
+    if (strcmp(argv[0], comando->nome) != 0)
+      continue;
+    if (argc - 1 < comando->minimo || argc - 1 > comando->maximo) {
+      c->erros++;
+      printf("erro: uso: %s %s\n", comando->nome, comando->ajuda);
+      return;
+    }
+    comando->executar(argc, argv);
+    return;
+  }
+  c->erros++;
+  printf("erro: comando desconhecido '%s' (ajuda lista os comandos)\n", argv[0]);
+}
+
+uint32_t console_processar(console_t *c, uint32_t max_linhas) {
+  uint32_t processadas = 0;
+  while (processadas < max_linhas && c->cauda != c->cabeca) {
+    char byte = (char)c->anel[c->cauda++ & (CONSOLE_ANEL - 1)];
+    if (byte == '\r' || byte == '\n') {
+      // \r\n conta como uma linha vazia extra, que não faz nada
+      if (c->descartando) {
+        c->erros++;
+        printf("erro: linha com mais de %d caracteres\n", CONSOLE_LINHA);
+      } else if (c->tamanho) {
+        c->linha[c->tamanho] = '\0';
+        executar_linha(c);
+        processadas++;
+      }
+      c->tamanho = 0;
+      c->descartando = false;
+    } else if (!c->descartando) {
+      if (c->tamanho == CONSOLE_LINHA)
+        c->descartando = true;
+      else
+        c->linha[c->tamanho++] = byte;
+    }
+  }
+  return processadas;
+}
+
+// -----------------------------------------------------------------------------
+// ARGUMENTOS
+// -----------------------------------------------------------------------------
+bool console_inteiro(const char *texto, int32_t minimo, int32_t maximo, int32_t *valor) {
+  bool negativo = *texto == '-';
+  if (negativo || *texto == '+')
+    texto++;
+  if (!*texto)
+    return false;
+  int64_t v = 0;
+  for (; *texto; ++texto) {
+    if (*texto < '0' || *texto > '9' || v > INT32_MAX)
+      return false;
+    v = v * 10 + (*texto - '0');
+  }
+  if (negativo)
+    v = -v;
+  if (v < minimo || v > maximo)
+    return false;
+  *valor = (int32_t)v;
+  return true;
+}
+
+bool console_horario(const char *texto, uint16_t *minuto_do_dia) {
+  const char *dois_pontos = strchr(texto, ':');
+  if (!dois_pontos || dois_pontos - texto > 2)
+    return false;
+  // Só dígitos: console_inteiro aceitaria o sinal ("+6:30", "06:-0")
+  for (const char *p = texto; *p; ++p)
+    if (p != dois_pontos && (*p < '0' || *p > '9'))
+      return false;
+  char horas[3] = { 0 };
+  memcpy(horas, texto, (size_t)(dois_pontos - texto));
+  int32_t h, m;
+  if (!console_inteiro(horas, 0, 23, &h) || strlen(dois_pontos + 1) != 2 ||
+      !console_inteiro(dois_pontos + 1, 0, 59, &m))
+    return false;
+  *minuto_do_dia = (uint16_t)(h * 60 + m);
+  return true;
+}
@@ -0,0 +1,65 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "hal.h"
+
+// =============================================================================
+// CONSOLE DE COMANDOS PELA SERIAL
+// Os bytes recebidos (hal_stdio_read, sem bloquear) vão para um anel; a cada
+// chamada, console_processar monta no máximo algumas linhas, separa as
+// palavras no próprio buffer da linha e despacha pela tabela de comandos,
+// definida em tempo de compilação. Nada é alocado e nenhuma chamada espera
+// por bytes, então o console pode rodar como tarefa do escalonador.
+//
+// Linha: <comando> [argumentos...] terminada em \r ou \n; linhas maiores que
+// CONSOLE_LINHA são descartadas inteiras. "ajuda" lista a tabela.
+// =============================================================================
+
+#define CONSOLE_ANEL          128   // Bytes recebidos ainda não processados (potência de 2)
+#define CONSOLE_LINHA         64    // Caracteres por linha, sem o terminador
+#define CONSOLE_ARGUMENTOS    6     // Palavras por linha, contando o comando
+
+typedef struct {
+  const char *nome;
+  void (*executar)(uint8_t argc, char **argv);   // argv[0] é o próprio comando
+  uint8_t minimo, maximo;       // Argumentos aceitos, sem contar o comando
+  const char *ajuda;
+} console_comando_t;
+
+typedef struct {
+  const console_comando_t *comandos;
+  uint8_t quantidade;
+
+  uint8_t anel[CONSOLE_ANEL];
+  uint32_t cabeca, cauda;       // Contadores livres; o índice é & (CONSOLE_ANEL - 1)
+  char linha[CONSOLE_LINHA + 1];
+  uint8_t tamanho;
+  bool descartando;             // Linha longa demais: ignora até o fim dela
+
+  // Estatísticas
+  uint32_t linhas;
+  uint32_t erros;               // Comando desconhecido, argumentos ou linha longa
+  uint32_t perdidos;            // Bytes recusados com o anel cheio
+} console_t;
+
+#define CONSOLE_COMANDO(nome_, funcao, minimo_, maximo_, ajuda_) \
+  { .nome = (nome_), .executar = (funcao), .minimo = (minimo_), .maximo = (maximo_), .ajuda = (ajuda_) }
+
+#define CONSOLE(vetor) { .comandos = (vetor), .quantidade = sizeof(vetor) / sizeof((vetor)[0]) }
+
+// Põe um byte no anel (ex.: de uma interrupção da UART); false se cheio
+bool console_alimentar(console_t *c, uint8_t byte);
+
+// Lê da HAL, sem esperar, os bytes que couberem no anel
+void console_receber(console_t *c);
+
+// Processa até max_linhas linhas completas; retorna quantas
+uint32_t console_processar(console_t *c, uint32_t max_linhas);
+
+// Converte um argumento decimal na faixa [minimo, maximo]; false se inválido
+bool console_inteiro(const char *texto, int32_t minimo, int32_t maximo, int32_t *valor);
+
+// Converte "hh:mm" em minutos do dia; false se inválido
+bool console_horario(const char *texto, uint16_t *minuto_do_dia);
+
+#endif
@@ -0,0 +1,60 @@
+#include "controle.h"
+
+static int64_t limitar64(int64_t x, int64_t minimo, int64_t maximo) {
+  return x < minimo ? minimo : (x > maximo ? maximo : x);
+}
+
+void pid_iniciar(controlador_pid_t *pid, const pid_config_t *config) {
+  pid->config = *config;
+  pid_reiniciar(pid);
+}
+
+void pid_reiniciar(controlador_pid_t *pid) {
+  pid->integral_q16 = 0;
+  pid->medida_anterior = 0;
+  pid->saida = pid->config.saida_min;
+  pid->iniciado = false;
+}
+
+// Núcleo do passo, comum à versão de um controlador e à de vetores
+static inline int32_t passo(const pid_config_t *c, int64_t *integral_q16, int32_t *medida_anterior,
+                            int32_t saida_anterior, bool derivar, int32_t setpoint, int32_t medida) {
+  int32_t erro = setpoint - medida;
+
+  int64_t p = (int64_t)c->kp_q16 * erro;
+  int64_t d = 0;
+  if (derivar && c->kd_q16)
+    d = -(int64_t)c->kd_q16 * (medida - *medida_anterior) * 1000000 / c->periodo_us;
+  *medida_anterior = medida;
+
+  // Integração condicional (anti-windup): com a saída saturada, o integrador
+  // só anda no sentido que a tira da saturação
+  int64_t minimo = (int64_t)c->saida_min << 16;
+  int64_t maximo = (int64_t)c->saida_max << 16;
+  int64_t integral = *integral_q16 + (int64_t)c->ki_q16 * erro * c->periodo_us / 1000000;
+  int64_t bruta = p + integral + d;
+  if (!((bruta > maximo && erro > 0) || (bruta < minimo && erro < 0)))
+    *integral_q16 = limitar64(integral, minimo, maximo);
+
+  int64_t u = limitar64((p + *integral_q16 + d + 0x8000) >> 16, c->saida_min, c->saida_max);
+
+  // Limitação da taxa de variação da saída
+  if (c->taxa_max)
+    u = limitar64(u, (int64_t)saida_anterior - c->taxa_max, (int64_t)saida_anterior + c->taxa_max);
+  return (int32_t)u;
+}
+
+int32_t pid_passo(controlador_pid_t *pid, int32_t setpoint, int32_t medida) {
+  pid->saida = passo(&pid->config, &pid->integral_q16, &pid->medida_anterior, pid->saida,
+                     pid->iniciado, setpoint, medida);
+  pid->iniciado = true;
+  return pid->saida;
+}
+
+void pid_passo_vetor(const pid_config_t *config, uint32_t n, const int32_t *setpoint,
+                     const int32_t *medida, int64_t *integral_q16, int32_t *medida_anterior,
+                     int32_t *saida) {
+  for (uint32_t i = 0; i < n; ++i)
+    saida[i] = passo(config, &integral_q16[i], &medida_anterior[i], saida[i], true,
+                     setpoint[i], medida[i]);
+}
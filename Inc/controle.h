@@ -0,0 +1,49 @@
+#ifndef CONTROLE_H
+#define CONTROLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// CONTROLADOR PID EM PONTO FIXO
+// Ganhos em Q16. O termo derivativo usa a variação da medida (não do erro),
+// para não dar um salto quando o setpoint muda. Anti-windup por limitação do
+// integrador: ele nunca acumula além do que cabe entre os limites da saída
+// descontados P e D. A saída também tem a taxa de variação limitada por passo.
+// =============================================================================
+
+typedef struct {
+  int32_t kp_q16;           // Saída por unidade de erro
+  int32_t ki_q16;           // Saída por unidade de erro por segundo
+  int32_t kd_q16;           // Saída por (unidade de erro por segundo)
+  int32_t saida_min;
+  int32_t saida_max;
+  int32_t taxa_max;         // Variação máxima da saída por passo (0 = sem limite)
+  uint32_t periodo_us;      // Intervalo fixo entre passos
+} pid_config_t;
+
+typedef struct {
+  pid_config_t config;
+  int64_t integral_q16;     // Termo integral, em unidades de saída Q16
+  int32_t medida_anterior;
+  int32_t saida;
+  bool iniciado;
+} controlador_pid_t;
+
+void pid_iniciar(controlador_pid_t *pid, const pid_config_t *config);
+
+// Zera o integrador e a memória do derivativo; a saída volta ao mínimo
+void pid_reiniciar(controlador_pid_t *pid);
+
+// Um passo de controle; retorna a nova saída
+int32_t pid_passo(controlador_pid_t *pid, int32_t setpoint, int32_t medida);
+
+// Um passo de n controladores com a mesma configuração e o estado em vetores
+// separados (um laço só sobre dados contíguos). Não há a flag iniciado: para
+// reiniciar o controlador i, zere integral_q16[i], volte saida[i] ao mínimo
+// e copie a medida atual para medida_anterior[i].
+void pid_passo_vetor(const pid_config_t *config, uint32_t n, const int32_t *setpoint,
+                     const int32_t *medida, int64_t *integral_q16, int32_t *medida_anterior,
+                     int32_t *saida);
+
+#endif
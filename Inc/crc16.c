@@ -0,0 +1,16 @@
+#include "crc16.h"
+
+// Por nibble: tabela de 16 entradas, barata em flash e rápida o bastante
+static const uint16_t crc_nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t crc16_ccitt(const uint8_t *dados, size_t tamanho) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < tamanho; ++i) {
+    crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (dados[i] >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (dados[i] & 0x0F)]);
+  }
+  return crc;
+}
@@ -0,0 +1,11 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-16/CCITT-FALSE (polinômio 0x1021, valor inicial 0xFFFF), usado nos
+// quadros da telemetria e nas páginas gravadas na flash
+uint16_t crc16_ccitt(const uint8_t *dados, size_t tamanho);
+
+#endif
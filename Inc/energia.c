@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include "energia.h"
+
+static const char *const nomes[ENERGIA_ESTADOS] = { "ativo", "ocioso", "desligado" };
+
+void energia_iniciar(energia_t *e, const energia_config_t *config, uint64_t agora_us) {
+  e->config = config;
+  e->estado = ENERGIA_ATIVO;
+  e->tela_ligada = true;
+  e->atividade_us = agora_us;
+  e->contabilizado_us = agora_us;
+  for (uint8_t i = 0; i < ENERGIA_ESTADOS; ++i)
+    e->tempo_us[i] = 0;
+  e->tempo_tela_us = 0;
+  e->transicoes = 0;
+}
+
+void energia_atividade(energia_t *e, uint64_t agora_us) {
+  e->atividade_us = agora_us;
+}
+
+bool energia_atualizar(energia_t *e, bool sistema_ligado, uint64_t agora_us) {
+  // O intervalo desde a última atualização é atribuído ao estado que vigorava
+  if (agora_us > e->contabilizado_us) {
+    uint64_t dt = agora_us - e->contabilizado_us;
+    e->tempo_us[e->estado] += dt;
+    if (e->tela_ligada)
+      e->tempo_tela_us += dt;
+    e->contabilizado_us = agora_us;
+  }
+
+  uint64_t parado = agora_us > e->atividade_us ? agora_us - e->atividade_us : 0;
+  energia_estado_t estado;
+  if (!sistema_ligado)
+    estado = ENERGIA_DESLIGADO;
+  else if (parado >= e->config->ocioso_apos_us)
+    estado = ENERGIA_OCIOSO;
+  else
+    estado = ENERGIA_ATIVO;
+  bool tela = parado < e->config->tela_apos_us;
+
+  bool mudou = (estado != e->estado) || (tela != e->tela_ligada);
+  if (estado != e->estado)
+    e->transicoes++;
+  e->estado = estado;
+  e->tela_ligada = tela;
+  return mudou;
+}
+
+uint64_t energia_carga_uc(const energia_t *e) {
+  uint64_t carga = 0;
+  for (uint8_t i = 0; i < ENERGIA_ESTADOS; ++i)
+    carga += e->tempo_us[i] * e->config->corrente_ua[i] / 1000000u;
+  return carga + e->tempo_tela_us * e->config->corrente_tela_ua / 1000000u;
+}
+
+void energia_relatorio(const energia_t *e) {
+  uint64_t total = 0;
+  for (uint8_t i = 0; i < ENERGIA_ESTADOS; ++i)
+    total += e->tempo_us[i];
+  printf("estado      tempo (s)      %%\n");
+  for (uint8_t i = 0; i < ENERGIA_ESTADOS; ++i)
+    printf("%-10s %10lu %6lu\n", nomes[i], (unsigned long)(e->tempo_us[i] / 1000000u),
+           (unsigned long)(total ? e->tempo_us[i] * 100 / total : 0));
+  printf("painel     %10lu %6lu\n", (unsigned long)(e->tempo_tela_us / 1000000u),
+         (unsigned long)(total ? e->tempo_tela_us * 100 / total : 0));
+  uint64_t carga = energia_carga_uc(e);
+  // 1 mAh = 3.6e6 uC
+  printf("carga: %lu.%03lu mAh, corrente media: %lu uA (%lu transicoes)\n",
+         (unsigned long)(carga / 3600000u), (unsigned long)(carga % 3600000u / 3600u),
+         (unsigned long)(total ? carga * 1000000u / total : 0), (unsigned long)e->transicoes);
+}
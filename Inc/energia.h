@@ -0,0 +1,60 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include "hal.h"
+
+// =============================================================================
+// GERENCIAMENTO DE ENERGIA
+// Máquina de estados a partir da atividade do sistema (mudanças nas leituras,
+// no setpoint, botões):
+//   ATIVO     -> OCIOSO     sistema ligado e sem atividade por ocioso_apos_us
+//   qualquer  -> DESLIGADO  sistema desligado pelo usuário
+// O painel apaga depois de tela_apos_us sem atividade, em qualquer estado.
+// O módulo só decide; quem aplica (taxa do ADC, períodos das tarefas, painel)
+// é a aplicação. O tempo em cada estado é contabilizado e, com um modelo de
+// corrente média por estado, dá a carga consumida — o mesmo cálculo vale no
+// host, sobre o relógio simulado.
+// =============================================================================
+
+typedef enum {
+  ENERGIA_ATIVO,
+  ENERGIA_OCIOSO,
+  ENERGIA_DESLIGADO,
+  ENERGIA_ESTADOS
+} energia_estado_t;
+
+typedef struct {
+  uint32_t ocioso_apos_us;
+  uint32_t tela_apos_us;
+  uint32_t corrente_ua[ENERGIA_ESTADOS];   // Consumo médio da placa, sem o painel
+  uint32_t corrente_tela_ua;               // Consumo adicional do painel aceso
+} energia_config_t;
+
+typedef struct {
+  const energia_config_t *config;
+  energia_estado_t estado;
+  bool tela_ligada;
+  uint64_t atividade_us;                   // Última atividade
+  uint64_t contabilizado_us;               // Tempo contabilizado até este instante
+  uint64_t tempo_us[ENERGIA_ESTADOS];
+  uint64_t tempo_tela_us;
+  uint32_t transicoes;
+} energia_t;
+
+void energia_iniciar(energia_t *e, const energia_config_t *config, uint64_t agora_us);
+
+// Registra atividade: volta ao estado ATIVO (se ligado) e acende o painel na
+// próxima atualização
+void energia_atividade(energia_t *e, uint64_t agora_us);
+
+// Contabiliza o tempo até agora e reavalia o estado; retorna true se o estado
+// ou o painel mudaram
+bool energia_atualizar(energia_t *e, bool sistema_ligado, uint64_t agora_us);
+
+// Carga consumida desde o início segundo o modelo, em microcoulombs (uA * s)
+uint64_t energia_carga_uc(const energia_t *e);
+
+// Imprime o tempo em cada estado e a carga via stdio
+void energia_relatorio(const energia_t *e);
+
+#endif
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include "escalonador.h"
+
+void escalonador_iniciar(escalonador_t *esc) {
+  uint64_t agora = hal_time_us();
+  for (uint8_t i = 0; i < esc->quantidade; ++i)
+    esc->tarefas[i].liberacao_us = agora;
+}
+
+static void escalonador_executar(tarefa_t *t, uint64_t agora) {
+  uint64_t liberacao = t->liberacao_us;
+  uint32_t atraso = (uint32_t)(agora - liberacao);
+
+  t->executar();
+
+  uint64_t fim = hal_time_us();
+  uint32_t duracao = (uint32_t)(fim - agora);
+  uint32_t prazo = t->prazo_us ? t->prazo_us : t->periodo_us;
+
+  t->execucoes++;
+  t->jitter_total_us += atraso;
+  if (atraso > t->jitter_max_us)
+    t->jitter_max_us = atraso;
+  if (duracao > t->duracao_max_us)
+    t->duracao_max_us = duracao;
+  if (fim - liberacao > prazo)
+    t->estouros++;
+
+  // Próxima liberação na grade fixa. Se várias já passaram, só a mais recente
+  // é executada (com atraso) e as anteriores são descartadas
+  liberacao += t->periodo_us;
+  if (fim >= liberacao + t->periodo_us) {
+    uint64_t puladas = (fim - liberacao) / t->periodo_us;
+    t->perdidas += (uint32_t)puladas;
+    liberacao += puladas * t->periodo_us;
+  }
+  t->liberacao_us = liberacao;
+}
+
+uint64_t escalonador_executar_pendentes(escalonador_t *esc) {
+  uint64_t proxima = UINT64_MAX;
+  for (uint8_t i = 0; i < esc->quantidade; ++i) {
+    tarefa_t *t = &esc->tarefas[i];
+    uint64_t agora = hal_time_us();
+    if (t->antecipar) {
+      t->antecipar = false;
+      if (t->liberacao_us > agora)
+        t->liberacao_us = agora;
+    }
+    if (agora >= t->liberacao_us)
+      escalonador_executar(t, agora);
+    if (t->liberacao_us < proxima)
+      proxima = t->liberacao_us;
+  }
+  return proxima;
+}
+
+void escalonador_passo(escalonador_t *esc) {
+  hal_sleep_until_us(escalonador_executar_pendentes(esc));
+}
+
+void escalonador_antecipar(tarefa_t *t) {
+  t->antecipar = true;
+}
+
+void escalonador_definir_periodo(tarefa_t *t, uint32_t periodo_us) {
+  uint64_t limite = hal_time_us() + periodo_us;
+  t->periodo_us = periodo_us;
+  if (t->liberacao_us > limite)
+    t->liberacao_us = limite;
+}
+
+void escalonador_zerar_estatisticas(escalonador_t *esc) {
+  for (uint8_t i = 0; i < esc->quantidade; ++i) {
+    tarefa_t *t = &esc->tarefas[i];
+    t->execucoes = t->estouros = t->perdidas = 0;
+    t->jitter_max_us = t->duracao_max_us = 0;
+    t->jitter_total_us = 0;
+  }
+}
+
+void escalonador_relatorio(const escalonador_t *esc) {
+  printf("tarefa      periodo  exec  estouros  perdidas  jitter_med  jitter_max  dur_max (us)\n");
+  for (uint8_t i = 0; i < esc->quantidade; ++i) {
+    const tarefa_t *t = &esc->tarefas[i];
+    uint32_t media = t->execucoes ? (uint32_t)(t->jitter_total_us / t->execucoes) : 0;
+    printf("%-10s %8lu %5lu %9lu %9lu %11lu %11lu %8lu\n", t->nome,
+           (unsigned long)t->periodo_us, (unsigned long)t->execucoes,
+           (unsigned long)t->estouros, (unsigned long)t->perdidas,
+           (unsigned long)media, (unsigned long)t->jitter_max_us,
+           (unsigned long)t->duracao_max_us);
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef ESCALONADOR_H
+#define ESCALONADOR_H
+
+#include "hal.h"
+
+// =============================================================================
+// ESCALONADOR COOPERATIVO DE TAXA FIXA
+// Cada tarefa tem período e prazo próprios. As liberações são fixas
+// (inicio + k * periodo), então atrasos não se acumulam; se uma tarefa perder
+// liberações inteiras elas são descartadas e contadas, em vez de executadas em
+// rajada. Entre uma liberação e outra a CPU dorme até o próximo alarme.
+// O tempo vem da HAL (hal_time_us / hal_sleep_until_us), o que permite rodar
+// o escalonador sobre o relógio simulado do host.
+// =============================================================================
+
+typedef struct {
+  const char *nome;
+  void (*executar)(void);
+  uint32_t periodo_us;
+  uint32_t prazo_us;          // Prazo relativo à liberação (0 = o próprio período)
+
+  // Estado
+  uint64_t liberacao_us;      // Próxima liberação
+  volatile bool antecipar;    // Liberação imediata pedida por uma interrupção
+
+  // Estatísticas
+  uint32_t execucoes;
+  uint32_t estouros;          // Execuções que terminaram depois do prazo
+  uint32_t perdidas;          // Liberações descartadas por atraso
+  uint32_t jitter_max_us;     // Maior atraso entre liberação e início
+  uint64_t jitter_total_us;   // Soma dos atrasos (para a média)
+  uint32_t duracao_max_us;    // Maior tempo de execução
+} tarefa_t;
+
+typedef struct {
+  tarefa_t *tarefas;          // Em ordem de prioridade (a primeira é a maior)
+  uint8_t quantidade;
+} escalonador_t;
+
+#define TAREFA(nome_, funcao, periodo, prazo) \
+  { .nome = (nome_), .executar = (funcao), .periodo_us = (periodo), .prazo_us = (prazo) }
+
+#define ESCALONADOR(vetor) { (vetor), sizeof(vetor) / sizeof((vetor)[0]) }
+
+// Primeira liberação de todas as tarefas no instante atual
+void escalonador_iniciar(escalonador_t *esc);
+
+// Executa as tarefas liberadas até agora e retorna o instante da próxima
+// liberação (sem dormir)
+uint64_t escalonador_executar_pendentes(escalonador_t *esc);
+
+// Executa as tarefas pendentes e dorme até a próxima liberação
+void escalonador_passo(escalonador_t *esc);
+
+// Pode ser chamada de uma interrupção: a tarefa é liberada no próximo passo e
+// a grade dela recomeça a partir daí. Para não esperar o alarme, a interrupção
+// deve chamar também hal_wake().
+void escalonador_antecipar(tarefa_t *t);
+
+// Muda o período da tarefa (ex.: modo de economia de energia); se a próxima
+// liberação ficar além de um período novo a partir de agora, é antecipada
+void escalonador_definir_periodo(tarefa_t *t, uint32_t periodo_us);
+
+// Zera as estatísticas e imprime o relatório por tarefa via stdio
+void escalonador_zerar_estatisticas(escalonador_t *esc);
+void escalonador_relatorio(const escalonador_t *esc);
+
+#endif
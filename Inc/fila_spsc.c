@@ -0,0 +1,59 @@
+#include <string.h>
+#include "fila_spsc.h"
+
+bool fila_spsc_enviar(fila_spsc_t *f, const void *item) {
+  uint32_t cabeca = atomic_load_explicit(&f->cabeca, memory_order_relaxed);
+  uint32_t cauda = atomic_load_explicit(&f->cauda, memory_order_acquire);
+  if (cabeca - cauda >= f->capacidade) {
+    f->descartadas++;
+    return false;
+  }
+  memcpy(&f->dados[(cabeca & (f->capacidade - 1)) * f->tamanho_item], item, f->tamanho_item);
+  // O release publica o item antes do novo índice
+  atomic_store_explicit(&f->cabeca, cabeca + 1, memory_order_release);
+  return true;
+}
+
+bool fila_spsc_receber(fila_spsc_t *f, void *item) {
+  uint32_t cauda = atomic_load_explicit(&f->cauda, memory_order_relaxed);
+  uint32_t cabeca = atomic_load_explicit(&f->cabeca, memory_order_acquire);
+  if (cabeca == cauda)
+    return false;
+  memcpy(item, &f->dados[(cauda & (f->capacidade - 1)) * f->tamanho_item], f->tamanho_item);
+  // O release garante que a cópia terminou antes de liberar a posição
+  atomic_store_explicit(&f->cauda, cauda + 1, memory_order_release);
+  return true;
+}
+
+uint32_t fila_spsc_receber_ultimo(fila_spsc_t *f, void *item) {
+  uint32_t retirados = 0;
+  while (fila_spsc_receber(f, item))
+    ++retirados;
+  return retirados;
+}
+
+void caixa_spsc_publicar(caixa_spsc_t *c, const void *item) {
+  uint32_t sequencia = atomic_load_explicit(&c->sequencia, memory_order_relaxed);
+  atomic_store_explicit(&c->sequencia, sequencia + 1, memory_order_relaxed);
+  // A sequência ímpar fica visível antes de qualquer byte novo
+  atomic_thread_fence(memory_order_release);
+  memcpy(c->dados, item, c->tamanho_item);
+  atomic_store_explicit(&c->sequencia, sequencia + 2, memory_order_release);
+}
+
+bool caixa_spsc_ler(caixa_spsc_t *c, void *item) {
+  for (;;) {
+    uint32_t antes = atomic_load_explicit(&c->sequencia, memory_order_acquire);
+    if (antes == c->lida)
+      return false;
+    if (antes & 1)
+      continue;   // Escrita em andamento no outro núcleo
+    memcpy(item, c->dados, c->tamanho_item);
+    // A cópia termina antes de a sequência ser relida
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&c->sequencia, memory_order_relaxed) == antes) {
+      c->lida = antes;
+      return true;
+    }
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef FILA_SPSC_H
+#define FILA_SPSC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// =============================================================================
+// FILA SEM TRAVAS DE UM PRODUTOR E UM CONSUMIDOR (SPSC)
+// Usada para trocar mensagens entre os dois núcleos do RP2040 (ou entre duas
+// threads no host). Cada índice só é escrito por um dos lados, então bastam
+// leituras e escritas atômicas com ordem acquire/release: não há
+// leitura-modificação-escrita atômica, que o Cortex-M0+ não tem.
+// Os índices crescem livremente; a posição no vetor é índice % capacidade.
+// =============================================================================
+
+typedef struct {
+  _Atomic uint32_t cabeca;   // Próxima posição a escrever (só o produtor altera)
+  _Atomic uint32_t cauda;    // Próxima posição a ler (só o consumidor altera)
+  uint32_t capacidade;       // Potência de 2
+  uint32_t tamanho_item;
+  uint8_t *dados;            // capacidade * tamanho_item bytes
+  uint32_t descartadas;      // Envios recusados por fila cheia (só o produtor altera)
+} fila_spsc_t;
+
+// Declara o armazenamento estático e a fila para capacidade itens do tipo
+#define FILA_SPSC_DEFINIR(nome, tipo, cap)                                 \
+  static uint8_t nome##_dados[(cap) * sizeof(tipo)];                       \
+  static fila_spsc_t nome = { .capacidade = (cap), .tamanho_item = sizeof(tipo), \
+                              .dados = nome##_dados }
+
+// Produtor: copia item para a fila; false (e conta o descarte) se estiver cheia
+bool fila_spsc_enviar(fila_spsc_t *f, const void *item);
+
+// Consumidor: retira o item mais antigo; false se a fila estiver vazia
+bool fila_spsc_receber(fila_spsc_t *f, void *item);
+
+// Consumidor: esvazia a fila, ficando só com o item mais recente em item;
+// retorna quantos itens foram retirados
+uint32_t fila_spsc_receber_ultimo(fila_spsc_t *f, void *item);
+
+// =============================================================================
+// CAIXA DO ÚLTIMO VALOR (SPSC)
+// Para um estado em que só a versão mais recente importa: o produtor
+// sobrescreve a caixa a cada publicação (nunca espera nem descarta) e o
+// consumidor, por mais devagar que leia, recebe sempre a última publicação
+// completa. A sequência fica ímpar enquanto o produtor escreve; o consumidor
+// copia e confere se ela continuou a mesma e par, senão copia de novo.
+// =============================================================================
+
+typedef struct {
+  _Atomic uint32_t sequencia;  // Publicações x 2 (+1 durante a escrita); só o produtor altera
+  uint32_t tamanho_item;
+  uint8_t *dados;
+  uint32_t lida;               // Sequência da última leitura (só o consumidor altera)
+} caixa_spsc_t;
+
+#define CAIXA_SPSC_DEFINIR(nome, tipo)                                     \
+  static uint8_t nome##_dados[sizeof(tipo)];                               \
+  static caixa_spsc_t nome = { .tamanho_item = sizeof(tipo), .dados = nome##_dados }
+
+// Produtor: substitui o conteúdo da caixa por item
+void caixa_spsc_publicar(caixa_spsc_t *c, const void *item);
+
+// Consumidor: copia para item a última publicação; false (item intacto) se
+// nada foi publicado desde a leitura anterior
+bool caixa_spsc_ler(caixa_spsc_t *c, void *item);
+
+#endif
@@ -0,0 +1,155 @@
+#include <string.h>
+#include "filtro.h"
+
+// -----------------------------------------------------------------------------
+// CALIBRAÇÃO DE DOIS PONTOS
+// -----------------------------------------------------------------------------
+void calibracao_definir(calibracao_t *c, int32_t bruto0, int32_t valor0, int32_t bruto1, int32_t valor1) {
+  c->bruto0 = bruto0;
+  c->valor0 = valor0;
+  c->bruto1 = bruto1;
+  c->valor1 = valor1;
+  c->ganho_q16 = (bruto1 != bruto0)
+      ? (int32_t)(((int64_t)(valor1 - valor0) << 16) / (bruto1 - bruto0))
+      : 0;
+}
+
+int32_t calibracao_aplicar(const calibracao_t *c, int32_t bruto) {
+  // Arredondado: sem isso, o ganho truncado em Q16 deixa bruto1 um abaixo de valor1
+  int32_t valor = c->valor0 + (int32_t)(((int64_t)(bruto - c->bruto0) * c->ganho_q16 + 0x8000) >> 16);
+  int32_t menor = c->valor0 < c->valor1 ? c->valor0 : c->valor1;
+  int32_t maior = c->valor0 < c->valor1 ? c->valor1 : c->valor0;
+  if (valor < menor)
+    return menor;
+  if (valor > maior)
+    return maior;
+  return valor;
+}
+
+// -----------------------------------------------------------------------------
+// ETAPAS DA CADEIA
+// -----------------------------------------------------------------------------
+static int32_t filtro_mediana(filtro_t *f, int32_t x) {
+  uint8_t n = f->config.mediana;
+  f->mediana_janela[f->mediana_pos] = x;
+  f->mediana_pos = (f->mediana_pos + 1) % n;
+  if (f->mediana_cheia < n)
+    f->mediana_cheia++;
+
+  // Ordenação por inserção de uma cópia (no máximo 5 elementos)
+  int32_t v[FILTRO_MEDIANA_MAX];
+  uint8_t m = f->mediana_cheia;
+  for (uint8_t i = 0; i < m; ++i) {
+    int32_t e = f->mediana_janela[i];
+    int8_t j = i - 1;
+    while (j >= 0 && v[j] > e) {
+      v[j + 1] = v[j];
+      --j;
+    }
+    v[j + 1] = e;
+  }
+  return v[m / 2];
+}
+
+static int32_t filtro_media(filtro_t *f, int32_t x) {
+  uint8_t n = f->config.media;
+  if (f->media_cheia == n)
+    f->media_soma -= f->media_janela[f->media_pos];
+  else
+    f->media_cheia++;
+  f->media_janela[f->media_pos] = x;
+  f->media_soma += x;
+  f->media_pos = (f->media_pos + 1) % n;
+  return f->media_soma / f->media_cheia;
+}
+
+static int32_t filtro_ema(filtro_t *f, int32_t x) {
+  int32_t x_q8 = x * 256;
+  if (!f->ema_iniciada) {
+    f->ema_q8 = x_q8;
+    f->ema_iniciada = true;
+  } else {
+    f->ema_q8 += (x_q8 - f->ema_q8) >> f->config.ema_shift;
+  }
+  return (f->ema_q8 + 128) >> 8;  // Arredonda para o inteiro mais próximo
+}
+
+static int32_t filtro_histerese(filtro_t *f, int32_t x) {
+  if (!f->saida_valida || x > f->saida + f->config.histerese || x < f->saida - f->config.histerese) {
+    f->saida = x;
+    f->saida_valida = true;
+  }
+  return f->saida;
+}
+
+void filtro_iniciar(filtro_t *f, const filtro_config_t *config, const calibracao_t *calibracao) {
+  memset(f, 0, sizeof(*f));
+  f->config = *config;
+  if (f->config.mediana > FILTRO_MEDIANA_MAX)
+    f->config.mediana = FILTRO_MEDIANA_MAX;
+  if (f->config.media > FILTRO_MEDIA_MAX)
+    f->config.media = FILTRO_MEDIA_MAX;
+  if (calibracao)
+    f->calibracao = *calibracao;
+  else
+    f->config.calibrar = false;
+}
+
+int32_t filtro_processar(filtro_t *f, int32_t x) {
+  if (f->config.calibrar)
+    x = calibracao_aplicar(&f->calibracao, x);
+  if (f->config.mediana > 1)
+    x = filtro_mediana(f, x);
+  if (f->config.media > 1)
+    x = filtro_media(f, x);
+  if (f->config.ema_shift)
+    x = filtro_ema(f, x);
+  if (f->config.histerese)
+    return filtro_histerese(f, x);
+  f->saida = x;
+  f->saida_valida = true;
+  return x;
+}
+
+// -----------------------------------------------------------------------------
+// COMPARADOR COM HISTERESE
+// -----------------------------------------------------------------------------
+bool comparador_atualizar(comparador_t *c, int32_t x, int32_t limiar) {
+  if (c->ativo) {
+    if (x < limiar - c->banda)
+      c->ativo = false;
+  } else {
+    if (x > limiar + c->banda)
+      c->ativo = true;
+  }
+  return c->ativo;
+}
+
+// -----------------------------------------------------------------------------
+// EIXO DE JOYSTICK
+// -----------------------------------------------------------------------------
+void joystick_calibrar_centro(joystick_eixo_t *j, int32_t bruto) {
+  j->centro = bruto;
+}
+
+int32_t joystick_deflexao(const joystick_eixo_t *j, int32_t bruto) {
+  int32_t d = bruto - j->centro;
+  if (d > -j->zona_morta && d < j->zona_morta)
+    return 0;
+  int32_t curso;
+  if (d > 0) {
+    d -= j->zona_morta;
+    curso = j->maximo - j->centro - j->zona_morta;
+  } else {
+    d += j->zona_morta;
+    curso = j->centro - j->minimo - j->zona_morta;
+  }
+  if (curso <= 0)
+    return 0;
+  int32_t deflexao = d * 100 / curso;
+  if (deflexao > 100)
+    return 100;
+  if (deflexao < -100)
+    return -100;
+  return deflexao;
+}
@@ -0,0 +1,90 @@
+#ifndef FILTRO_H
+#define FILTRO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// FILTRAGEM DIGITAL E CALIBRAÇÃO (SOMENTE ARITMÉTICA INTEIRA)
+// O Cortex-M0+ do RP2040 não tem FPU; todas as etapas usam inteiros e ponto
+// fixo. Uma amostra percorre, na ordem: calibração de dois pontos, mediana,
+// média móvel, média exponencial (EMA) e histerese. Cada etapa pode ser
+// desligada na configuração.
+// =============================================================================
+
+#define FILTRO_MEDIA_MAX    16   // Janela máxima da média móvel
+#define FILTRO_MEDIANA_MAX  5    // Janela máxima da mediana (ímpar)
+
+// -----------------------------------------------------------------------------
+// CALIBRAÇÃO DE DOIS PONTOS
+// Reta que passa por (bruto0, valor0) e (bruto1, valor1), com inclinação em
+// Q16. A saída é limitada ao intervalo [valor0, valor1].
+// -----------------------------------------------------------------------------
+typedef struct {
+  int32_t bruto0, valor0;
+  int32_t bruto1, valor1;
+  int32_t ganho_q16;
+} calibracao_t;
+
+void calibracao_definir(calibracao_t *c, int32_t bruto0, int32_t valor0, int32_t bruto1, int32_t valor1);
+int32_t calibracao_aplicar(const calibracao_t *c, int32_t bruto);
+
+// -----------------------------------------------------------------------------
+// CADEIA DE FILTROS
+// -----------------------------------------------------------------------------
+typedef struct {
+  bool calibrar;            // Aplica a calibração antes das demais etapas
+  uint8_t mediana;          // Janela da mediana: 0 (desligada), 3 ou 5
+  uint8_t media;            // Janela da média móvel: 0 (desligada) a FILTRO_MEDIA_MAX
+  uint8_t ema_shift;        // EMA com alfa = 1 / 2^ema_shift (0 = desligada)
+  int32_t histerese;        // A saída só muda se a entrada se afastar mais que isso
+} filtro_config_t;
+
+typedef struct {
+  filtro_config_t config;
+  calibracao_t calibracao;
+
+  int32_t mediana_janela[FILTRO_MEDIANA_MAX];
+  uint8_t mediana_pos, mediana_cheia;
+
+  int32_t media_janela[FILTRO_MEDIA_MAX];
+  int32_t media_soma;
+  uint8_t media_pos, media_cheia;
+
+  int32_t ema_q8;           // Estado da EMA em Q8 (8 bits de fração)
+  bool ema_iniciada;
+
+  int32_t saida;            // Última saída (após a histerese)
+  bool saida_valida;
+} filtro_t;
+
+void filtro_iniciar(filtro_t *f, const filtro_config_t *config, const calibracao_t *calibracao);
+int32_t filtro_processar(filtro_t *f, int32_t amostra);
+
+// -----------------------------------------------------------------------------
+// COMPARADOR COM HISTERESE
+// Fica ativo quando x passa de limiar + banda e só volta a inativo quando x
+// cai abaixo de limiar - banda; evita oscilação de saídas perto do limiar.
+// -----------------------------------------------------------------------------
+typedef struct {
+  int32_t banda;
+  bool ativo;
+} comparador_t;
+
+bool comparador_atualizar(comparador_t *c, int32_t x, int32_t limiar);
+
+// -----------------------------------------------------------------------------
+// EIXO DE JOYSTICK
+// Converte a leitura bruta em deflexão de -100 a +100, com zona morta em torno
+// do centro medido. Fora da zona morta a escala recomeça em 0, sem degrau.
+// -----------------------------------------------------------------------------
+typedef struct {
+  int32_t centro;
+  int32_t zona_morta;
+  int32_t minimo, maximo;   // Leituras brutas nos extremos do curso
+} joystick_eixo_t;
+
+void joystick_calibrar_centro(joystick_eixo_t *j, int32_t bruto);
+int32_t joystick_deflexao(const joystick_eixo_t *j, int32_t bruto);
+
+#endif
@@ -3,10 +3,31 @@
 
 #include <stdint.h>
 
-// Fontes para A-Z e 0-9. Os caracteres tem 8x8 pixels
+// Fonte ASCII completa (0x20 a 0x7E). Os caracteres tem 8x8 pixels e cada
+// glifo ocupa 8 bytes, um por coluna (bit 0 = linha de cima), no mesmo formato
+// de uma página do display: o glifo de c fica em font[(c - FONT_FIRST_CHAR) * 8].
 
-static uint8_t font[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Nothing
+#define FONT_FIRST_CHAR 0x20
+#define FONT_LAST_CHAR  0x7E
+#define FONT_WIDTH      8
+
+static const uint8_t font[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //espaço
+    0x00, 0x00, 0x00, 0x5f, 0x00, 0x00, 0x00, 0x00, //!
+    0x00, 0x00, 0x07, 0x00, 0x07, 0x00, 0x00, 0x00, //"
+    0x00, 0x14, 0x7f, 0x14, 0x7f, 0x14, 0x00, 0x00, //#
+    0x00, 0x24, 0x2a, 0x7f, 0x2a, 0x12, 0x00, 0x00, //$
+    0x00, 0x23, 0x13, 0x08, 0x64, 0x62, 0x00, 0x00, //%
+    0x00, 0x36, 0x49, 0x55, 0x22, 0x50, 0x00, 0x00, //&
+    0x00, 0x00, 0x05, 0x03, 0x00, 0x00, 0x00, 0x00, //'
+    0x00, 0x00, 0x1c, 0x22, 0x41, 0x00, 0x00, 0x00, //(
+    0x00, 0x00, 0x41, 0x22, 0x1c, 0x00, 0x00, 0x00, //)
+    0x00, 0x14, 0x08, 0x3e, 0x08, 0x14, 0x00, 0x00, //*
+    0x00, 0x08, 0x08, 0x3e, 0x08, 0x08, 0x00, 0x00, //+
+    0x00, 0x00, 0x50, 0x30, 0x00, 0x00, 0x00, 0x00, //,
+    0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, //-
+    0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, //.
+    0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00, ///
     0x3e, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3e, 0x00, //0
     0x00, 0x00, 0x42, 0x7f, 0x40, 0x00, 0x00, 0x00, //1
     0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00, //2
@@ -17,6 +38,13 @@ static uint8_t font[] = {
     0x01, 0x01, 0x01, 0x61, 0x31, 0x0d, 0x03, 0x00, //7
     0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //8
     0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7f, 0x00, //9
+    0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, //:
+    0x00, 0x00, 0x56, 0x36, 0x00, 0x00, 0x00, 0x00, //;
+    0x00, 0x08, 0x14, 0x22, 0x41, 0x00, 0x00, 0x00, //<
+    0x00, 0x14, 0x14, 0x14, 0x14, 0x14, 0x00, 0x00, //=
+    0x00, 0x00, 0x41, 0x22, 0x14, 0x08, 0x00, 0x00, //>
+    0x00, 0x02, 0x01, 0x51, 0x09, 0x06, 0x00, 0x00, //?
+    0x00, 0x32, 0x49, 0x79, 0x41, 0x3e, 0x00, 0x00, //@
     0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00, //A
     0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7f, 0x00, //B
     0x7e, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00, //C
@@ -43,6 +71,12 @@ static uint8_t font[] = {
     0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00, //X
     0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00, //Y
     0x41, 0x61, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00, //Z
+    0x00, 0x00, 0x7f, 0x41, 0x41, 0x00, 0x00, 0x00, //[
+    0x00, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x00, //barra invertida
+    0x00, 0x00, 0x41, 0x41, 0x7f, 0x00, 0x00, 0x00, //]
+    0x00, 0x04, 0x02, 0x01, 0x02, 0x04, 0x00, 0x00, //^
+    0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, //_
+    0x00, 0x00, 0x01, 0x02, 0x04, 0x00, 0x00, 0x00, //`
 
     // Letras minusculas
         // inspiradas na fonte Minecraft do Craftron Gaming
@@ -72,7 +106,12 @@ static uint8_t font[] = {
     0x00, 0x3c, 0x40, 0x40, 0x70, 0x40, 0x7c, 0x00, //w
     0x00, 0x44, 0x28, 0x10, 0x28, 0x44, 0x00, 0x00, //x
     0x00, 0x4c, 0x50, 0x50, 0x3c, 0x00, 0x00, 0x00, //y
-    0x00, 0x44, 0x64, 0x54, 0x4c, 0x44, 0x00, 0x00 //z
+    0x00, 0x44, 0x64, 0x54, 0x4c, 0x44, 0x00, 0x00, //z
+
+    0x00, 0x00, 0x08, 0x36, 0x41, 0x00, 0x00, 0x00, //{
+    0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, //|
+    0x00, 0x00, 0x41, 0x36, 0x08, 0x00, 0x00, 0x00, //}
+    0x00, 0x08, 0x04, 0x08, 0x10, 0x08, 0x00, 0x00 //~
 };
 
 #endif
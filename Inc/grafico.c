@@ -0,0 +1,97 @@
+#include <string.h>
+#include "grafico.h"
+
+// -----------------------------------------------------------------------------
+// SÉRIE
+// -----------------------------------------------------------------------------
+void grafico_serie_adicionar(grafico_serie_t *s, int16_t valor) {
+  s->amostras[s->total++ & (GRAFICO_AMOSTRAS - 1)] = valor;
+}
+
+void grafico_serie_limpar(grafico_serie_t *s) {
+  s->total = 0;
+}
+
+// -----------------------------------------------------------------------------
+// DESENHO
+// -----------------------------------------------------------------------------
+// Linha do valor dentro da área (0 = topo), recortada à faixa
+static uint8_t grafico_linha(const grafico_t *g, int16_t valor) {
+  if (valor <= g->minimo)
+    return g->altura - 1;
+  if (valor >= g->maximo)
+    return 0;
+  return (uint8_t)(g->altura - 1 -
+                   (int32_t)(valor - g->minimo) * (g->altura - 1) / (g->maximo - g->minimo));
+}
+
+static int16_t grafico_amostra(const grafico_t *g, int64_t k) {
+  return g->serie->amostras[k & (GRAFICO_AMOSTRAS - 1)];
+}
+
+// Bytes da coluna c, que mostra a amostra de índice absoluto k (k < 0: antes
+// da primeira amostra, só a referência). O segmento vai da linha da amostra
+// anterior, exclusive, até a da amostra k; a referência (linha r) é
+// pontilhada pelo índice absoluto, para o pontilhado rolar junto.
+static void grafico_coluna(ssd1306_t *ssd, const grafico_t *g, uint8_t c, int64_t k,
+                           uint8_t anterior, uint8_t atual, int r) {
+  uint8_t bytes[SSD1306_MAX_PAGES];
+  uint8_t paginas = g->altura / 8;
+  memset(bytes, 0, paginas);
+  if (k >= 0) {
+    uint8_t topo = atual, base = atual;
+    if (anterior < atual)
+      topo = anterior + 1;
+    else if (anterior > atual)
+      base = anterior - 1;
+    for (uint8_t pagina = topo >> 3; pagina <= base >> 3; ++pagina) {
+      uint8_t primeiro = (topo >> 3) == pagina ? (topo & 0b111) : 0;
+      uint8_t ultimo = (base >> 3) == pagina ? (base & 0b111) : 7;
+      bytes[pagina] = (uint8_t)((0xFF << primeiro) & (0xFF >> (7 - ultimo)));
+    }
+  }
+  if (r >= 0 && (k & 3) == 0)
+    bytes[r >> 3] |= 1u << (r & 0b111);
+  ssd1306_put_column(ssd, g->x + c, g->y / 8, bytes, paginas);
+}
+
+void grafico_invalidar(grafico_t *g) {
+  g->valido = false;
+}
+
+void grafico_definir_referencia(grafico_t *g, int16_t referencia) {
+  if (referencia != g->referencia) {
+    g->referencia = referencia;
+    g->valido = false;
+  }
+}
+
+uint8_t grafico_atualizar(ssd1306_t *ssd, grafico_t *g) {
+  uint32_t total = g->serie->total;
+  uint32_t novas = total - g->desenhadas;
+  if (g->valido && novas == 0)
+    return 0;
+
+  // Índice absoluto da amostra da coluna 0
+  int64_t primeira = (int64_t)total - g->largura;
+  uint8_t de = 0;
+  if (g->valido && novas < g->largura) {
+    // Rolagem: as colunas antigas andam novas posições para a esquerda
+    de = (uint8_t)(g->largura - novas);
+    ssd1306_shift_left(ssd, g->x, g->x + g->largura - 1, g->y / 8, (g->y + g->altura) / 8 - 1,
+                       (uint8_t)novas);
+  }
+  // Cada linha é calculada uma vez e serve à coluna dela e à seguinte
+  int r = g->referencia != GRAFICO_SEM_REFERENCIA ? grafico_linha(g, g->referencia) : -1;
+  int64_t k = primeira + de;
+  uint8_t anterior = k > 0 ? grafico_linha(g, grafico_amostra(g, k - 1)) : 0;
+  for (uint8_t c = de; c < g->largura; ++c, ++k) {
+    uint8_t atual = k >= 0 ? grafico_linha(g, grafico_amostra(g, k)) : 0;
+    grafico_coluna(ssd, g, c, k, k > 0 ? anterior : atual, atual, r);
+    anterior = atual;
+  }
+
+  g->desenhadas = total;
+  g->valido = true;
+  return (uint8_t)(g->largura - de);
+}
@@ -0,0 +1,57 @@
+#ifndef GRAFICO_H
+#define GRAFICO_H
+
+#include "ssd1306.h"
+
+// =============================================================================
+// GRÁFICO DE TENDÊNCIA ROLANTE
+// A série guarda as últimas GRAFICO_AMOSTRAS amostras num anel; cada gráfico
+// mostra as mais recentes dela, uma por coluna, com a mais nova à direita,
+// ligadas por segmentos verticais. Vários gráficos (ex.: um completo e uma
+// linha de tendência de 8 pixels) podem mostrar a mesma série.
+//
+// A coluna de uma amostra depende só dela, da anterior e da posição absoluta
+// na série. Então, a cada amostra nova, grafico_atualizar desloca as colunas
+// já desenhadas (memmove por página) e desenha só as novas, em vez de
+// redesenhar o gráfico inteiro; o resultado é idêntico ao do redesenho.
+//
+// A área do gráfico ocupa páginas inteiras: y e altura múltiplos de 8.
+// =============================================================================
+
+#define GRAFICO_AMOSTRAS  256   // Capacidade da série (potência de 2, maior que a largura)
+#define GRAFICO_SEM_REFERENCIA INT16_MIN
+
+typedef struct {
+  int16_t amostras[GRAFICO_AMOSTRAS];
+  uint32_t total;           // Amostras já adicionadas (contador livre)
+} grafico_serie_t;
+
+typedef struct {
+  const grafico_serie_t *serie;
+  uint8_t x, y, largura, altura;
+  int16_t minimo, maximo;   // Faixa do eixo vertical (valores fora são recortados)
+  int16_t referencia;       // Linha pontilhada (ex.: setpoint); GRAFICO_SEM_REFERENCIA = nenhuma
+  uint32_t desenhadas;      // serie->total na última atualização
+  bool valido;              // false força o redesenho completo
+} grafico_t;
+
+#define GRAFICO(serie_, px, py, l, a, min, max)                                     \
+  { .serie = (serie_), .x = (px), .y = (py), .largura = (l), .altura = (a),         \
+    .minimo = (min), .maximo = (max), .referencia = GRAFICO_SEM_REFERENCIA }
+
+void grafico_serie_adicionar(grafico_serie_t *s, int16_t valor);
+
+// Esvazia a série (os gráficos dela precisam ser invalidados)
+void grafico_serie_limpar(grafico_serie_t *s);
+
+// Força o redesenho completo na próxima atualização
+void grafico_invalidar(grafico_t *g);
+
+// Muda a linha de referência; se ela mudou, o gráfico é invalidado
+void grafico_definir_referencia(grafico_t *g, int16_t referencia);
+
+// Desenha as amostras novas desde a última atualização (ou o gráfico inteiro,
+// se inválido); retorna quantas colunas foram desenhadas
+uint8_t grafico_atualizar(ssd1306_t *ssd, grafico_t *g);
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef HAL_H
+#define HAL_H
+
+// =============================================================================
+// CAMADA FINA DE ABSTRAÇÃO DE HARDWARE (HAL)
+// No alvo (RP2040) as funções são implementadas em Inc/hal_pico.c sobre o SDK
+// do Pico. No host (HAL_HOST definido) ficam em host/hal_host.c, que simula
+// os periféricos para testes e medições fora da placa.
+// =============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef HAL_HOST
+typedef unsigned int uint;
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t hal_host_i2c0_inst, hal_host_i2c1_inst;
+#define i2c0 (&hal_host_i2c0_inst)
+#define i2c1 (&hal_host_i2c1_inst)
+// No host, cada volta de espera ativa faz os periféricos simulados avançarem
+void tight_loop_contents(void);
+#define HAL_GPIO_EDGE_FALL  0x4u
+#define HAL_GPIO_EDGE_RISE  0x8u
+#else
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/adc.h"
+#define HAL_GPIO_EDGE_FALL  GPIO_IRQ_EDGE_FALL
+#define HAL_GPIO_EDGE_RISE  GPIO_IRQ_EDGE_RISE
+#endif
+
+// -----------------------------------------------------------------------------
+// SISTEMA
+// -----------------------------------------------------------------------------
+// Inicia a saída padrão (UART/USB no alvo; stdout no host)
+void hal_stdio_init(void);
+
+// Escreve bytes crus na saída padrão, sem tradução de \n em \r\n (para
+// fluxos binários misturados ao texto do printf)
+void hal_stdio_write(const uint8_t *dados, size_t tamanho);
+
+// Próximo byte recebido pela entrada padrão, sem esperar; -1 se não há
+int hal_stdio_read(void);
+
+// Condição do laço principal: sempre true no alvo; no host, false quando o
+// tempo simulado de execução se esgota (ao fim, o host grava os artefatos
+// pedidos, como o retrato do painel em PBM)
+bool hal_running(void);
+
+// -----------------------------------------------------------------------------
+// TEMPO
+// -----------------------------------------------------------------------------
+// Microssegundos desde o boot. No host é um relógio simulado, que só avança
+// quando o programa dorme (ou por hal_host_time_advance_us()).
+uint64_t hal_time_us(void);
+
+// Dorme até o instante t (microssegundos desde o boot), acordado por alarme
+// ou antes, se hal_wake() for chamada
+void hal_sleep_until_us(uint64_t t);
+
+// Chamada de uma interrupção: faz o hal_sleep_until_us() em curso (ou o
+// próximo) no mesmo núcleo retornar imediatamente
+void hal_wake(void);
+
+// Contador livre em nanossegundos para medir trechos curtos (dá a volta a
+// cada ~4,3 s; use só diferenças). No alvo vem do temporizador de 1 us; no
+// host é o relógio real (CLOCK_MONOTONIC), não o simulado.
+uint32_t hal_perf_ns(void);
+
+// -----------------------------------------------------------------------------
+// MULTINÚCLEO
+// -----------------------------------------------------------------------------
+// Inicia o núcleo 1, que executa passo() repetidamente e dorme, entre uma
+// chamada e outra, até o instante (microssegundos desde o boot) que passo()
+// retorna. No host, o núcleo 1 é intercalado de forma determinística com o
+// núcleo 0 sempre que este dorme.
+void hal_core1_launch(uint64_t (*passo)(void));
+
+// Núcleo que está executando (0 ou 1)
+uint hal_core_num(void);
+
+// -----------------------------------------------------------------------------
+// GPIO
+// -----------------------------------------------------------------------------
+typedef void (*hal_gpio_irq_cb_t)(uint gpio, uint32_t edges);
+
+void hal_gpio_init_output(uint pin);
+void hal_gpio_init_input(uint pin, bool pull_up);
+void hal_gpio_put(uint pin, bool value);
+bool hal_gpio_get(uint pin);
+
+// Habilita a interrupção das bordas (HAL_GPIO_EDGE_*) do pino. Há uma única
+// rotina para todos os pinos, como no SDK: a última registrada vale.
+void hal_gpio_set_irq(uint pin, uint32_t edges, hal_gpio_irq_cb_t cb);
+
+// -----------------------------------------------------------------------------
+// PWM
+// -----------------------------------------------------------------------------
+// Configura o pino como saída PWM com contagem 0..wrap (divisor 1) e nível 0
+void hal_pwm_init(uint pin, uint16_t wrap);
+void hal_pwm_set(uint pin, uint16_t level);
+
+// -----------------------------------------------------------------------------
+// ADC EM MODO CONTÍNUO
+// -----------------------------------------------------------------------------
+// Liga o ADC e prepara como entradas analógicas os pinos das entradas de
+// mascara (bit 0 = ADC0/GPIO26, ...)
+void hal_adc_init(uint8_t mascara);
+
+// Converte em round-robin as entradas de mascara (bit 0 = ADC0/GPIO26,
+// bit 1 = ADC1/GPIO27, ...) a taxa_hz conversões por segundo em cada entrada.
+// O DMA grava os resultados de 12 bits em anel, circularmente, sem uso da CPU
+// (nem para recomeçar a volta: interrupções atrasadas ou desligadas não
+// perdem conversões). tamanho deve ser potência de 2 e o anel alinhado a
+// tamanho * 2 bytes.
+void hal_adc_stream_start(uint8_t mascara, uint32_t taxa_hz, volatile uint16_t *anel, uint32_t tamanho);
+
+// Total de amostras gravadas desde o início (contador monotônico). A amostra
+// k fica em anel[k % tamanho] e foi convertida no instante
+// inicio + k * 1e6 / (taxa_hz * entradas) microssegundos.
+uint64_t hal_adc_stream_count(void);
+uint64_t hal_adc_stream_start_us(void);
+
+// Muda a taxa de conversão por entrada sem interromper a contagem; 0 pausa o
+// ADC. No alvo, o divisor de 16 bits limita a taxa total mínima a cerca de
+// 732 conversões por segundo (somando as entradas).
+void hal_adc_stream_set_rate(uint32_t taxa_hz);
+
+// -----------------------------------------------------------------------------
+// I2C
+// -----------------------------------------------------------------------------
+// Inicia o controlador a freq_hz nos pinos sda/scl, com pull-ups internos
+void hal_i2c_init(i2c_inst_t *i2c, uint32_t freq_hz, uint sda, uint scl);
+
+// Escrita bloqueante de len bytes no dispositivo addr (7 bits), com STOP ao fim.
+// Retorna o número de bytes escritos ou um valor negativo em caso de erro.
+int hal_i2c_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len);
+
+// Escrita assíncrona: agenda a transferência e retorna imediatamente. done(ctx,
+// ok) é chamada quando o STOP termina a transferência (no alvo, dentro da
+// interrupção do I2C), com ok = false se ela foi abortada (NACK do
+// dispositivo, perda de arbitragem); até lá src não pode ser alterado.
+// Retorna false se o barramento estiver ocupado ou len exceder
+// HAL_I2C_ASYNC_MAX. hal_i2c_write() espera qualquer transferência
+// assíncrona pendente antes de começar.
+#define HAL_I2C_ASYNC_MAX 1040
+typedef void (*hal_i2c_done_cb_t)(void *ctx, bool ok);
+bool hal_i2c_write_async(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         hal_i2c_done_cb_t done, void *ctx);
+bool hal_i2c_busy(i2c_inst_t *i2c);
+
+// -----------------------------------------------------------------------------
+// FLASH (ÁREA DE DADOS)
+// -----------------------------------------------------------------------------
+// Área reservada no fim da flash, depois da imagem do programa, endereçada por
+// deslocamento a partir do seu início. Como na flash real, apagar põe um setor
+// inteiro em 0xFF e programar só leva bits de 1 para 0, uma página por vez.
+// No alvo, as duas operações param o outro núcleo e as interrupções enquanto
+// duram (um apagamento leva dezenas de milissegundos). O que roda por DMA não
+// para: o anel do ADC recomeça as voltas pelo canal de controle encadeado,
+// sem a interrupção, e nenhuma conversão se perde (a interrupção pendente só
+// atualiza a contagem de disparos depois, e hal_adc_stream_count já a
+// considera). Uma transação I2C assíncrona termina no barramento, mas o
+// aviso de conclusão espera o fim da operação.
+#define HAL_FLASH_PAGE_SIZE    256
+#define HAL_FLASH_SECTOR_SIZE  4096
+#define HAL_FLASH_AREA_SIZE    (64 * 1024)
+
+// Conteúdo da área a partir de offset (no alvo, leitura direta pelo XIP)
+const uint8_t *hal_flash_read(uint32_t offset);
+
+// Apaga o setor que começa em offset
+bool hal_flash_erase(uint32_t offset);
+
+// Programa HAL_FLASH_PAGE_SIZE bytes (de um buffer na RAM) na página em offset
+bool hal_flash_program(uint32_t offset, const uint8_t *page);
+
+#endif
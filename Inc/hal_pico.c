@@ -0,0 +1,404 @@
+#include "hal.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+// =============================================================================
+// IMPLEMENTAÇÃO DA HAL SOBRE O SDK DO PICO
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+// SISTEMA
+// -----------------------------------------------------------------------------
+void hal_stdio_init(void) {
+  stdio_init_all();
+}
+
+void hal_stdio_write(const uint8_t *dados, size_t tamanho) {
+  stdio_put_string((const char *)dados, (int)tamanho, false, false);
+}
+
+int hal_stdio_read(void) {
+  int byte = getchar_timeout_us(0);
+  return byte < 0 ? -1 : byte;
+}
+
+bool hal_running(void) {
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// TEMPO
+// -----------------------------------------------------------------------------
+uint64_t hal_time_us(void) {
+  return time_us_64();
+}
+
+static volatile bool acordar[2];
+
+void hal_sleep_until_us(uint64_t t) {
+  uint nucleo = get_core_num();
+  absolute_time_t alvo = from_us_since_boot(t);
+  // WFE até o alarme; qualquer interrupção acorda o núcleo, que volta a
+  // dormir a menos que ela tenha chamado hal_wake()
+  while (!acordar[nucleo] && !best_effort_wfe_or_timeout(alvo))
+    ;
+  acordar[nucleo] = false;
+}
+
+void hal_wake(void) {
+  acordar[get_core_num()] = true;
+  __sev();
+}
+
+uint32_t hal_perf_ns(void) {
+  return time_us_32() * 1000u;
+}
+
+// -----------------------------------------------------------------------------
+// MULTINÚCLEO
+// -----------------------------------------------------------------------------
+static uint64_t (*core1_passo)(void);
+
+static void core1_main(void) {
+  flash_safe_execute_core_init();   // Permite ao núcleo 0 pausar este durante gravações na flash
+  for (;;)
+    hal_sleep_until_us(core1_passo());
+}
+
+void hal_core1_launch(uint64_t (*passo)(void)) {
+  core1_passo = passo;
+  multicore_launch_core1(core1_main);
+}
+
+uint hal_core_num(void) {
+  return get_core_num();
+}
+
+// -----------------------------------------------------------------------------
+// GPIO
+// -----------------------------------------------------------------------------
+void hal_gpio_init_output(uint pin) {
+  gpio_init(pin);
+  gpio_set_dir(pin, GPIO_OUT);
+}
+
+void hal_gpio_init_input(uint pin, bool pull_up) {
+  gpio_init(pin);
+  gpio_set_dir(pin, GPIO_IN);
+  if (pull_up)
+    gpio_pull_up(pin);
+  else
+    gpio_disable_pulls(pin);
+}
+
+void hal_gpio_put(uint pin, bool value) {
+  gpio_put(pin, value);
+}
+
+bool hal_gpio_get(uint pin) {
+  return gpio_get(pin);
+}
+
+void hal_gpio_set_irq(uint pin, uint32_t edges, hal_gpio_irq_cb_t cb) {
+  gpio_set_irq_enabled_with_callback(pin, edges, true, cb);
+}
+
+// -----------------------------------------------------------------------------
+// PWM
+// -----------------------------------------------------------------------------
+void hal_pwm_init(uint pin, uint16_t wrap) {
+  gpio_set_function(pin, GPIO_FUNC_PWM);
+  uint slice_num = pwm_gpio_to_slice_num(pin);
+  pwm_set_wrap(slice_num, wrap);
+  pwm_set_gpio_level(pin, 0);
+  pwm_set_enabled(slice_num, true);
+}
+
+void hal_pwm_set(uint pin, uint16_t level) {
+  pwm_set_gpio_level(pin, level);
+}
+
+// -----------------------------------------------------------------------------
+// ADC EM MODO CONTÍNUO
+// -----------------------------------------------------------------------------
+void hal_adc_init(uint8_t mascara) {
+  adc_init();
+  for (uint i = 0; i < 4; ++i)   // A entrada 4 é o sensor de temperatura interno
+    if (mascara & (1u << i))
+      adc_gpio_init(26 + i);
+  if (mascara & (1u << 4))
+    adc_set_temp_sensor_enabled(true);
+}
+
+// Dois canais de DMA: o de dados percorre o anel (modo ring no endereço de
+// escrita) com uma contagem longa e, ao terminá-la, dispara o de controle,
+// que regrava a contagem no registrador de disparo do de dados. O endereço de
+// escrita segue de onde parou, então o redisparo não depende da CPU: nem a
+// latência da interrupção nem as interrupções desligadas durante a gravação
+// da flash fazem o FIFO do ADC transbordar e desalinhar o round-robin do
+// anel. A interrupção só conta os disparos completos, para
+// hal_adc_stream_count().
+#define ADC_DMA_CONTAGEM (1u << 28)   // Transferências por disparo (~25 h a 3 kHz)
+
+static int adc_dma_chan = -1;
+static int adc_dma_controle = -1;
+static const uint32_t adc_dma_recarga = ADC_DMA_CONTAGEM;
+static volatile uint32_t adc_disparos;
+static uint64_t adc_inicio_us;
+static uint adc_entradas;
+
+// Divisor do relógio de 48 MHz para a taxa total pedida (16 bits inteiros)
+static float adc_divisor(uint32_t taxa_hz) {
+  float divisor = 48000000.0f / ((float)taxa_hz * adc_entradas) - 1.0f;
+  return divisor > 65535.0f ? 65535.0f : divisor;
+}
+
+static void adc_dma_irq(void) {
+  if (adc_dma_chan < 0 || !dma_channel_get_irq1_status(adc_dma_chan))
+    return;
+  dma_channel_acknowledge_irq1(adc_dma_chan);
+  adc_disparos++;
+}
+
+void hal_adc_stream_start(uint8_t mascara, uint32_t taxa_hz, volatile uint16_t *anel, uint32_t tamanho) {
+  uint entradas = 0;
+  uint primeira = 0;
+  for (uint i = 0; i < 5; ++i) {
+    if (mascara & (1u << i)) {
+      if (entradas++ == 0)
+        primeira = i;
+    }
+  }
+
+  adc_run(false);
+  if (adc_dma_chan < 0) {
+    adc_dma_chan = dma_claim_unused_channel(true);
+    adc_dma_controle = dma_claim_unused_channel(true);
+    irq_add_shared_handler(DMA_IRQ_1, adc_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+  } else {
+    // Reinício: o controle para primeiro, para não redisparar os dados
+    dma_channel_abort(adc_dma_controle);
+    dma_channel_abort(adc_dma_chan);
+    dma_channel_acknowledge_irq1(adc_dma_chan);
+  }
+  adc_fifo_drain();
+  adc_select_input(primeira);
+  adc_set_round_robin(mascara);
+  adc_fifo_setup(true, true, 1, false, false);
+  adc_entradas = entradas;
+  adc_set_clkdiv(adc_divisor(taxa_hz));
+
+  uint ring_bits = 0;
+  while ((1u << ring_bits) < tamanho * sizeof(uint16_t))
+    ++ring_bits;
+
+  dma_channel_config c = dma_channel_get_default_config(adc_dma_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_ring(&c, true, ring_bits);
+  channel_config_set_dreq(&c, DREQ_ADC);
+  channel_config_set_chain_to(&c, adc_dma_controle);
+  dma_channel_set_irq1_enabled(adc_dma_chan, true);
+
+  dma_channel_config k = dma_channel_get_default_config(adc_dma_controle);
+  channel_config_set_transfer_data_size(&k, DMA_SIZE_32);
+  channel_config_set_read_increment(&k, false);
+  channel_config_set_write_increment(&k, false);
+  dma_channel_configure(adc_dma_controle, &k, &dma_hw->ch[adc_dma_chan].al1_transfer_count_trig,
+                        &adc_dma_recarga, 1, false);
+
+  adc_disparos = 0;
+  dma_channel_configure(adc_dma_chan, &c, anel, &adc_hw->fifo, ADC_DMA_CONTAGEM, true);
+  adc_inicio_us = time_us_64();
+  adc_run(true);
+}
+
+// Conversões gravadas = disparos completos * contagem + o que o disparo atual
+// já transferiu. Um disparo que terminou e ainda não foi contado pela
+// interrupção (flag pendente) conta aqui; entre o fim de um disparo e o
+// redisparo pelo controle, o registrador está em 0 e o próximo não começou.
+uint64_t hal_adc_stream_count(void) {
+  uint32_t disparos, restante;
+  bool pendente;
+  do {
+    disparos = adc_disparos;
+    pendente = dma_channel_get_irq1_status(adc_dma_chan);
+    restante = dma_channel_hw_addr(adc_dma_chan)->transfer_count;
+  } while (disparos != adc_disparos || pendente != dma_channel_get_irq1_status(adc_dma_chan));
+  if (pendente)
+    ++disparos;
+  if (restante == 0)
+    restante = ADC_DMA_CONTAGEM;
+  return (uint64_t)disparos * ADC_DMA_CONTAGEM + (ADC_DMA_CONTAGEM - restante);
+}
+
+uint64_t hal_adc_stream_start_us(void) {
+  return adc_inicio_us;
+}
+
+void hal_adc_stream_set_rate(uint32_t taxa_hz) {
+  if (adc_entradas == 0)
+    return;
+  if (taxa_hz == 0) {
+    // A conversão em andamento termina e o round-robin continua de onde parou
+    adc_run(false);
+    return;
+  }
+  adc_set_clkdiv(adc_divisor(taxa_hz));
+  adc_run(true);
+}
+
+// -----------------------------------------------------------------------------
+// I2C
+// -----------------------------------------------------------------------------
+// Estado da transferência assíncrona de cada controlador I2C. O DMA escreve
+// palavras de 16 bits em IC_DATA_CMD (byte de dados + bit de STOP), por isso
+// os bytes são expandidos para words[] ao iniciar a transferência. O fim vem
+// da interrupção do próprio controlador: STOP_DET quando o último byte saiu
+// no barramento, ou TX_ABRT quando a transferência foi abortada.
+typedef struct {
+  bool pronto;              // Canal de DMA e interrupção já configurados
+  int dma_chan;
+  volatile bool busy;
+  hal_i2c_done_cb_t done;
+  void *ctx;
+  uint32_t abort_source;    // IC_TX_ABRT_SOURCE do último aborto (depuração)
+  uint16_t words[HAL_I2C_ASYNC_MAX];
+} i2c_async_t;
+
+static i2c_async_t i2c_async[NUM_I2CS];
+
+#define I2C_ASYNC_INTR (I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS)
+
+void hal_i2c_init(i2c_inst_t *i2c, uint32_t freq_hz, uint sda, uint scl) {
+  i2c_init(i2c, freq_hz);
+  gpio_set_function(sda, GPIO_FUNC_I2C);
+  gpio_set_function(scl, GPIO_FUNC_I2C);
+  gpio_pull_up(sda);
+  gpio_pull_up(scl);
+}
+
+static void i2c_async_irq(uint indice) {
+  i2c_hw_t *hw = i2c_get_hw(i2c_get_instance(indice));
+  i2c_async_t *a = &i2c_async[indice];
+  uint32_t estado = hw->intr_stat;
+  bool ok = !(estado & I2C_IC_INTR_STAT_R_TX_ABRT_BITS);
+  if (!ok) {
+    // O controlador descarta o FIFO e fica travado até a leitura de
+    // IC_CLR_TX_ABRT; o DMA para antes, para não alimentar o FIFO travado
+    dma_channel_abort(a->dma_chan);
+    a->abort_source = hw->tx_abrt_source;
+    (void)hw->clr_tx_abrt;
+  }
+  (void)hw->clr_stop_det;
+  hw->intr_mask = 0;   // As escritas bloqueantes do SDK não usam a interrupção
+  if (!a->busy)
+    return;
+  a->busy = false;
+  if (a->done)
+    a->done(a->ctx, ok);
+}
+
+static void i2c0_irq(void) {
+  i2c_async_irq(0);
+}
+
+static void i2c1_irq(void) {
+  i2c_async_irq(1);
+}
+
+// Livre assim que a interrupção tratou o fim da transferência: o callback de
+// conclusão já pode iniciar a próxima, sem esperar uma nova consulta
+bool hal_i2c_busy(i2c_inst_t *i2c) {
+  return i2c_async[i2c_get_index(i2c)].busy;
+}
+
+int hal_i2c_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+  while (hal_i2c_busy(i2c))
+    tight_loop_contents();
+  return i2c_write_blocking(i2c, addr, src, len, false);
+}
+
+bool hal_i2c_write_async(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         hal_i2c_done_cb_t done, void *ctx) {
+  if (len == 0 || len > HAL_I2C_ASYNC_MAX || hal_i2c_busy(i2c))
+    return false;
+
+  uint indice = i2c_get_index(i2c);
+  i2c_async_t *a = &i2c_async[indice];
+  i2c_hw_t *hw = i2c_get_hw(i2c);
+  if (!a->pronto) {
+    a->dma_chan = dma_claim_unused_channel(true);
+    hw->intr_mask = 0;
+    irq_set_exclusive_handler(I2C0_IRQ + indice, indice ? i2c1_irq : i2c0_irq);
+    irq_set_enabled(I2C0_IRQ + indice, true);
+    a->pronto = true;
+  }
+
+  for (size_t i = 0; i < len; ++i)
+    a->words[i] = src[i];
+  a->words[len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  a->done = done;
+  a->ctx = ctx;
+  a->busy = true;
+
+  hw->enable = 0;
+  // STOP_DET pode chegar um instante antes de o controlador voltar ao
+  // repouso; ele só se desabilita (e aceita o novo endereço) ao terminar
+  while (hw->enable_status & I2C_IC_ENABLE_STATUS_IC_EN_BITS)
+    tight_loop_contents();
+  hw->tar = addr;
+  hw->enable = 1;
+  // Descarta STOP_DET e abortos de transferências anteriores (inclusive das
+  // bloqueantes) antes de habilitar a interrupção desta
+  (void)hw->clr_intr;
+  hw->intr_mask = I2C_ASYNC_INTR;
+
+  dma_channel_config c = dma_channel_get_default_config(a->dma_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+  dma_channel_configure(a->dma_chan, &c, &hw->data_cmd, a->words, len, true);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// FLASH (ÁREA DE DADOS)
+// -----------------------------------------------------------------------------
+#define FLASH_AREA_INICIO (PICO_FLASH_SIZE_BYTES - HAL_FLASH_AREA_SIZE)
+#define FLASH_TIMEOUT_MS  100
+
+typedef struct {
+  uint32_t offset;
+  const uint8_t *page;    // NULL = apagar o setor
+} flash_op_t;
+
+// Roda com o outro núcleo parado e as interrupções desligadas
+static void flash_executar(void *param) {
+  const flash_op_t *op = param;
+  if (op->page)
+    flash_range_program(FLASH_AREA_INICIO + op->offset, op->page, HAL_FLASH_PAGE_SIZE);
+  else
+    flash_range_erase(FLASH_AREA_INICIO + op->offset, HAL_FLASH_SECTOR_SIZE);
+}
+
+const uint8_t *hal_flash_read(uint32_t offset) {
+  return (const uint8_t *)(XIP_BASE + FLASH_AREA_INICIO + offset);
+}
+
+bool hal_flash_erase(uint32_t offset) {
+  flash_op_t op = { .offset = offset, .page = NULL };
+  return flash_safe_execute(flash_executar, &op, FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+bool hal_flash_program(uint32_t offset, const uint8_t *page) {
+  flash_op_t op = { .offset = offset, .page = page };
+  return flash_safe_execute(flash_executar, &op, FLASH_TIMEOUT_MS) == PICO_OK;
+}
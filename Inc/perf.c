@@ -0,0 +1,72 @@
+#include "perf.h"
+
+#if PERF_ATIVO
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+// Uma lista por núcleo: cada núcleo só insere na sua, e a inserção publica o
+// estágio com release para o relatório poder ser pedido de qualquer núcleo
+static perf_estagio_t *_Atomic listas[2];
+
+void perf_registrar(perf_estagio_t *e, uint32_t duracao_ns) {
+  if (!e->registrado) {
+    uint nucleo = hal_core_num();
+    e->registrado = true;
+    e->proximo = atomic_load_explicit(&listas[nucleo], memory_order_relaxed);
+    atomic_store_explicit(&listas[nucleo], e, memory_order_release);
+  }
+  e->execucoes++;
+  e->total_ns += duracao_ns;
+  if (duracao_ns < e->min_ns)
+    e->min_ns = duracao_ns;
+  if (duracao_ns > e->max_ns)
+    e->max_ns = duracao_ns;
+  uint8_t faixa = duracao_ns ? (uint8_t)(32 - __builtin_clz(duracao_ns)) : 0;
+  e->histograma[faixa < PERF_FAIXAS ? faixa : PERF_FAIXAS - 1]++;
+}
+
+// Nanossegundos em us com uma casa decimal
+static void imprimir_us(uint64_t ns) {
+  printf(" %8lu.%01lu", (unsigned long)(ns / 1000u), (unsigned long)(ns % 1000u / 100u));
+}
+
+void perf_relatorio(void) {
+  printf("estagio     nucleo   exec     min(us)     med(us)     max(us)  histograma (<limite: n)\n");
+  for (uint nucleo = 0; nucleo < 2; ++nucleo) {
+    for (perf_estagio_t *e = atomic_load_explicit(&listas[nucleo], memory_order_acquire); e; e = e->proximo) {
+      printf("%-12s %5u %6lu", e->nome, nucleo, (unsigned long)e->execucoes);
+      imprimir_us(e->execucoes ? e->min_ns : 0);
+      imprimir_us(e->execucoes ? e->total_ns / e->execucoes : 0);
+      imprimir_us(e->max_ns);
+      printf(" ");
+      for (uint8_t k = 0; k < PERF_FAIXAS; ++k) {
+        if (!e->histograma[k])
+          continue;
+        uint64_t limite = 1ull << k;   // Limite superior da faixa, em ns
+        if (limite < 1000u)
+          printf(" <%luns:%lu", (unsigned long)limite, (unsigned long)e->histograma[k]);
+        else if (limite < 1000000u)
+          printf(" <%luus:%lu", (unsigned long)(limite / 1000u), (unsigned long)e->histograma[k]);
+        else
+          printf(" <%lums:%lu", (unsigned long)(limite / 1000000u), (unsigned long)e->histograma[k]);
+      }
+      printf("\n");
+    }
+  }
+}
+
+void perf_zerar(void) {
+  for (uint nucleo = 0; nucleo < 2; ++nucleo) {
+    for (perf_estagio_t *e = atomic_load_explicit(&listas[nucleo], memory_order_acquire); e; e = e->proximo) {
+      e->execucoes = 0;
+      e->total_ns = 0;
+      e->min_ns = UINT32_MAX;
+      e->max_ns = 0;
+      for (uint8_t k = 0; k < PERF_FAIXAS; ++k)
+        e->histograma[k] = 0;
+    }
+  }
+}
+
+#endif
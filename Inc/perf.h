@@ -0,0 +1,59 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include "hal.h"
+
+// =============================================================================
+// INSTRUMENTAÇÃO DE DESEMPENHO POR ESTÁGIO
+// Cada estágio medido acumula mínimo, máximo, média e um histograma em
+// potências de 2 da duração (em nanossegundos, via hal_perf_ns). Uso:
+//   PERF_DEFINIR(leds);                                 // escopo de arquivo
+//   PERF_MEDIR(leds, atualizar_leds(u, d));             // dentro da função
+// ou PERF_INICIO(leds); ... PERF_FIM(leds); em trechos maiores.
+// PERF_RELATORIO() imprime todos os estágios já executados via stdio.
+// PERF_ZERAR() recomeça as medidas de todos (no console: relatorio zerar).
+// Com PERF_ATIVO 0 (padrão) as macros não geram código nenhum.
+// =============================================================================
+
+#ifndef PERF_ATIVO
+#define PERF_ATIVO 0
+#endif
+
+#if PERF_ATIVO
+
+#define PERF_FAIXAS 32   // Faixa k: duração em [2^(k-1), 2^k) ns; faixa 0: 0 ns
+
+typedef struct perf_estagio {
+  const char *nome;
+  uint32_t execucoes;
+  uint32_t min_ns;
+  uint32_t max_ns;
+  uint64_t total_ns;
+  uint32_t histograma[PERF_FAIXAS];
+  struct perf_estagio *proximo;   // Lista de estágios registrados no mesmo núcleo
+  bool registrado;
+} perf_estagio_t;
+
+#define PERF_DEFINIR(id) static perf_estagio_t perf_##id = { .nome = #id, .min_ns = UINT32_MAX }
+#define PERF_INICIO(id) uint32_t perf_inicio_##id = hal_perf_ns()
+#define PERF_FIM(id) perf_registrar(&perf_##id, hal_perf_ns() - perf_inicio_##id)
+#define PERF_MEDIR(id, ...) do { PERF_INICIO(id); __VA_ARGS__; PERF_FIM(id); } while (0)
+#define PERF_RELATORIO() perf_relatorio()
+#define PERF_ZERAR() perf_zerar()
+
+void perf_registrar(perf_estagio_t *e, uint32_t duracao_ns);
+void perf_relatorio(void);
+void perf_zerar(void);
+
+#else
+
+#define PERF_DEFINIR(id) struct perf_desligado_##id
+#define PERF_INICIO(id) do { } while (0)
+#define PERF_FIM(id) do { } while (0)
+#define PERF_MEDIR(id, ...) do { __VA_ARGS__; } while (0)
+#define PERF_RELATORIO() do { } while (0)
+#define PERF_ZERAR() do { } while (0)
+
+#endif
+
+#endif
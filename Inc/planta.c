@@ -0,0 +1,21 @@
+#include "planta.h"
+
+#define UMIDADE_MAX_Q16 ((int64_t)1000 << 16)
+
+void planta_iniciar(planta_t *p, int32_t umidade, int32_t tau_s, int32_t ganho, int32_t bomba_max) {
+  p->umidade_q16 = (int64_t)umidade << 16;
+  p->tau_s = tau_s;
+  p->ganho = ganho;
+  p->bomba_max = bomba_max;
+}
+
+int32_t planta_passo(planta_t *p, int32_t ambiente, int32_t bomba, uint32_t dt_us) {
+  int64_t secagem = (((int64_t)ambiente << 16) - p->umidade_q16) / p->tau_s;
+  int64_t irrigacao = ((int64_t)p->ganho << 16) * bomba / p->bomba_max;
+  p->umidade_q16 += (secagem + irrigacao) * dt_us / 1000000;
+  if (p->umidade_q16 < 0)
+    p->umidade_q16 = 0;
+  if (p->umidade_q16 > UMIDADE_MAX_Q16)
+    p->umidade_q16 = UMIDADE_MAX_Q16;
+  return (int32_t)((p->umidade_q16 + 0x8000) >> 16);
+}
@@ -0,0 +1,27 @@
+#ifndef PLANTA_H
+#define PLANTA_H
+
+#include <stdint.h>
+
+// =============================================================================
+// MODELO DA PLANTA (SOLO + BOMBA)
+// Primeira ordem: sem irrigação a umidade decai para a do ambiente com
+// constante de tempo tau_s; a bomba soma umidade proporcionalmente ao PWM.
+//   dU/dt = (ambiente - U) / tau + ganho * bomba / bomba_max
+// Serve para simular o laço fechado sem sensor nem bomba de verdade.
+// Umidades em décimos de porcento (0..1000).
+// =============================================================================
+
+typedef struct {
+  int64_t umidade_q16;     // Estado, em décimos de % Q16
+  int32_t tau_s;           // Constante de tempo da secagem (segundos)
+  int32_t ganho;           // Décimos de % por segundo com a bomba no máximo
+  int32_t bomba_max;       // Nível de PWM da bomba no máximo
+} planta_t;
+
+void planta_iniciar(planta_t *p, int32_t umidade, int32_t tau_s, int32_t ganho, int32_t bomba_max);
+
+// Avança dt_us e retorna a nova umidade
+int32_t planta_passo(planta_t *p, int32_t ambiente, int32_t bomba, uint32_t dt_us);
+
+#endif
@@ -1,116 +1,432 @@
+#include <stdio.h>
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
+// Painéis registrados por ssd1306_init, para a fila de envios de cada
+// barramento
+static ssd1306_t *ssd1306_panels[SSD1306_MAX_PANELS];
+static uint8_t ssd1306_panel_count;
+static uint8_t ssd1306_next_panel;   // Onde a próxima busca na fila começa
+
 // Implementação das funções (usando o ponteiro passado como parâmetro)
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
-  ssd->width = width;
-  ssd->height = height;
-  ssd->pages = height / 8U;
+void ssd1306_init(ssd1306_t *ssd, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+  ssd->pages = ssd->height / 8U;
   ssd->address = address;
+  ssd->external_vcc = external_vcc;
   ssd->i2c_port = i2c;
-  ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  memset(ssd->ram_buffer, 0, ssd->bufsize);
   ssd->ram_buffer[0] = 0x40;
+  ssd->flush_state = SSD1306_FLUSH_IDLE;
+  ssd->flush_done = NULL;
+  ssd->flush_failed = false;
+  ssd->flush_errors = 0;
   ssd->port_buffer[0] = 0x80;
+  ssd1306_clear_dirty(ssd);
+
+  for (uint8_t i = 0; i < ssd1306_panel_count; ++i)
+    if (ssd1306_panels[i] == ssd)
+      return;
+  if (ssd1306_panel_count < SSD1306_MAX_PANELS)
+    ssd1306_panels[ssd1306_panel_count++] = ssd;
 }
 
+// Sequências de comandos montadas na compilação. Cada uma começa pelo byte
+// de controle SSD1306_COMMAND_STREAM e vai inteira numa única transação I2C.
+_Static_assert(SSD1306_HEIGHT == 64 || SSD1306_HEIGHT == 32, "SSD1306_HEIGHT deve ser 64 ou 32");
+_Static_assert(SSD1306_WIDTH <= 128, "SSD1306_WIDTH deve ser no máximo 128");
+
+#define SSD1306_INIT_SEQUENCE(height)                                           \
+  {                                                                             \
+    SSD1306_COMMAND_STREAM,                                                     \
+    SET_DISP | 0x00,                                                            \
+    SET_MEM_ADDR, 0x00,   /* Horizontal: cada página é contígua no buffer */    \
+    SET_DISP_START_LINE | 0x00,                                                 \
+    SET_SEG_REMAP | (SSD1306_ROTATE_180 ? 0x00 : 0x01),                         \
+    SET_MUX_RATIO, (height) - 1,                                                \
+    SET_COM_OUT_DIR | (SSD1306_ROTATE_180 ? 0x00 : 0x08),                       \
+    SET_DISP_OFFSET, 0x00,                                                      \
+    SET_COM_PIN_CFG, (height) == 64 ? 0x12 : 0x02,                              \
+    SET_DISP_CLK_DIV, 0x80,                                                     \
+    SET_PRECHARGE, 0xF1,                                                        \
+    SET_VCOM_DESEL, 0x30,                                                       \
+    SET_CONTRAST, 0xFF,                                                         \
+    SET_ENTIRE_ON,                                                              \
+    SET_NORM_INV,                                                               \
+    SET_CHARGE_PUMP, 0x14,                                                      \
+    SET_DISP | 0x01,                                                            \
+  }
+
+static const uint8_t ssd1306_init_64[] = SSD1306_INIT_SEQUENCE(64);
+static const uint8_t ssd1306_init_32[] = SSD1306_INIT_SEQUENCE(32);
+
+// Janela de escrita do quadro inteiro na geometria padrão
+static const uint8_t ssd1306_full_window[] = {
+  SSD1306_COMMAND_STREAM,
+  SET_COL_ADDR, 0, SSD1306_WIDTH - 1,
+  SET_PAGE_ADDR, 0, SSD1306_HEIGHT / 8 - 1,
+};
+
+static const uint8_t ssd1306_display_off[] = {
+  SSD1306_COMMAND_STREAM, SET_DISP | 0x00, SET_CHARGE_PUMP, 0x10,
+};
+
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  if (ssd->height == 32)
+    ssd1306_command_stream(ssd, ssd1306_init_32, sizeof(ssd1306_init_32));
+  else
+    ssd1306_command_stream(ssd, ssd1306_init_64, sizeof(ssd1306_init_64));
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+  hal_i2c_write(
     ssd->i2c_port,
     ssd->address,
     ssd->port_buffer,
-    2,
-    false
+    2
   );
 }
 
+// Envia uma sequência já iniciada pelo byte de controle SSD1306_COMMAND_STREAM
+void ssd1306_command_stream(ssd1306_t *ssd, const uint8_t *stream, size_t len) {
+  hal_i2c_write(ssd->i2c_port, ssd->address, stream, len);
+}
+
+// Liga ou desliga o painel. Desligado, o SSD1306 entra em modo de repouso
+// (GDDRAM preservada) e a bomba de carga interna é desativada para poupar energia
+void ssd1306_display(ssd1306_t *ssd, bool ligado) {
+  if (ligado) {
+    const uint8_t on[] = {
+      SSD1306_COMMAND_STREAM, SET_CHARGE_PUMP, ssd->external_vcc ? 0x10 : 0x14, SET_DISP | 0x01,
+    };
+    ssd1306_command_stream(ssd, on, sizeof(on));
+  } else {
+    ssd1306_command_stream(ssd, ssd1306_display_off, sizeof(ssd1306_display_off));
+  }
+}
+
+// Define a janela de escrita (colunas x0..x1, páginas page0..page1) numa
+// única transação
+static void ssd1306_set_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  const uint8_t window[] = {
+    SSD1306_COMMAND_STREAM, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, page0, page1,
+  };
+  ssd1306_command_stream(ssd, window, sizeof(window));
+}
+
+// Envia len bytes do buffer a partir de ram_buffer[start] sem copiá-los: o byte
+// anterior recebe temporariamente o byte de controle 0x40 (dados).
+static void ssd1306_write_span(ssd1306_t *ssd, size_t start, size_t len) {
+  uint8_t *span = &ssd->ram_buffer[start - 1];
+  uint8_t saved = *span;
+  *span = 0x40;
+  hal_i2c_write(ssd->i2c_port, ssd->address, span, len + 1);
+  *span = saved;
+}
+
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
+  if (ssd->width == SSD1306_WIDTH && ssd->height == SSD1306_HEIGHT)
+    ssd1306_command_stream(ssd, ssd1306_full_window, sizeof(ssd1306_full_window));
+  else
+    ssd1306_set_window(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+  hal_i2c_write(
     ssd->i2c_port,
     ssd->address,
     ssd->ram_buffer,
-    ssd->bufsize,
-    false
+    ssd->bufsize
   );
+  ssd1306_clear_dirty(ssd);
+}
+
+// Custo aproximado, em bytes no barramento, de abrir uma janela de escrita:
+// a transação de comandos (endereço + controle + seis comandos) e o
+// cabeçalho (endereço + controle) da transação de dados.
+#define SSD1306_WINDOW_COST 10u
+
+// Envia apenas as faixas alteradas desde o último envio. Páginas sujas
+// consecutivas são agrupadas numa única janela de largura total (contígua no
+// buffer) quando isso custa menos bytes que uma janela por página.
+void ssd1306_send_dirty(ssd1306_t *ssd) {
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (ssd->dirty_x0[page] > ssd->dirty_x1[page]) {
+      ++page;
+      continue;
+    }
+    uint8_t last = page;
+    uint32_t separate = 0;
+    while (last < ssd->pages && ssd->dirty_x0[last] <= ssd->dirty_x1[last]) {
+      separate += SSD1306_WINDOW_COST + ssd->dirty_x1[last] - ssd->dirty_x0[last] + 1;
+      ++last;
+    }
+    uint32_t merged = SSD1306_WINDOW_COST + (uint32_t)(last - page) * ssd->width;
+    if (merged <= separate) {
+      ssd1306_set_window(ssd, 0, ssd->width - 1, page, last - 1);
+      ssd1306_write_span(ssd, 1 + page * ssd->width, (size_t)(last - page) * ssd->width);
+    } else {
+      for (uint8_t p = page; p < last; ++p) {
+        uint8_t x0 = ssd->dirty_x0[p];
+        uint8_t x1 = ssd->dirty_x1[p];
+        ssd1306_set_window(ssd, x0, x1, p, p);
+        ssd1306_write_span(ssd, 1 + p * ssd->width + x0, x1 - x0 + 1);
+      }
+    }
+    page = last;
+  }
+  ssd1306_clear_dirty(ssd);
+}
+
+static bool ssd1306_flush_start(ssd1306_t *ssd);
+
+// Chamada ao fim de cada janela (no alvo, na interrupção do I2C, depois do
+// STOP): a próxima janela do mesmo painel parte daqui e, ao fim do quadro, o
+// próximo painel da fila, sem esperar outra chamada do driver. Numa falha, o
+// resto do quadro é abandonado e as colunas enviadas voltam a ser sujas no
+// próximo envio.
+static void ssd1306_flush_complete(void *ctx, bool ok) {
+  ssd1306_t *ssd = ctx;
+  if (ok && ++ssd->front_next < ssd->front_windows) {
+    if (!ssd1306_flush_start(ssd))
+      ssd->flush_state = SSD1306_FLUSH_QUEUED;
+    return;
+  }
+  if (!ok) {
+    ssd->flush_errors++;
+    ssd->flush_failed = true;
+  }
+  ssd->flush_state = SSD1306_FLUSH_IDLE;
+  if (ssd->flush_done)
+    ssd->flush_done(ssd, ok);
+  ssd1306_flush_poll();
+}
+
+// Entrega ao DMA a janela front_next do buffer frontal; false se o
+// barramento está ocupado
+static bool ssd1306_flush_start(ssd1306_t *ssd) {
+  if (hal_i2c_busy(ssd->i2c_port))
+    return false;
+  const uint8_t *src = &ssd->front_buffer[ssd->front_start[ssd->front_next]];
+  size_t len = ssd->front_start[ssd->front_next + 1] - ssd->front_start[ssd->front_next];
+  ssd->flush_state = SSD1306_FLUSH_SENDING;
+  if (!hal_i2c_write_async(ssd->i2c_port, ssd->address, src, len, ssd1306_flush_complete, ssd)) {
+    // DMA indisponível: envia de forma bloqueante
+    ssd1306_flush_complete(ssd, hal_i2c_write(ssd->i2c_port, ssd->address, src, len) >= 0);
+  }
+  return true;
+}
+
+// Inicia os envios na fila cujo barramento está livre, a partir do painel
+// seguinte ao último atendido (revezamento entre painéis do mesmo barramento)
+void ssd1306_flush_poll(void) {
+  for (uint8_t n = 0; n < ssd1306_panel_count; ++n) {
+    uint8_t i = (uint8_t)((ssd1306_next_panel + n) % ssd1306_panel_count);
+    ssd1306_t *ssd = ssd1306_panels[i];
+    if (ssd->flush_state == SSD1306_FLUSH_QUEUED && ssd1306_flush_start(ssd))
+      ssd1306_next_panel = (uint8_t)((i + 1) % ssd1306_panel_count);
+  }
+}
+
+// Custo de uma janela no envio assíncrono: endereço, cabeçalho da janela e
+// byte de controle dos dados
+#define SSD1306_ASYNC_WINDOW_COST (SSD1306_WINDOW_HEADER + 2u)
+
+// Acrescenta ao buffer frontal a transação da janela x0..x1, page0..page1
+static void ssd1306_front_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  uint8_t *out = &ssd->front_buffer[ssd->front_start[ssd->front_windows]];
+  const uint8_t window[SSD1306_WINDOW_HEADER] = {
+    0x80, SET_COL_ADDR, 0x80, x0, 0x80, x1, 0x80, SET_PAGE_ADDR, 0x80, page0, 0x80, page1,
+  };
+  memcpy(out, window, sizeof(window));
+  out += SSD1306_WINDOW_HEADER;
+  *out++ = 0x40;
+  size_t cols = x1 - x0 + 1;
+  for (uint8_t page = page0; page <= page1; ++page) {
+    memcpy(out, &ssd->ram_buffer[1 + page * ssd->width + x0], cols);
+    out += cols;
+    ssd->front_x0[page] = x0;
+    ssd->front_x1[page] = x1;
+  }
+  ssd->front_windows++;
+  ssd->front_start[ssd->front_windows] = (uint16_t)(out - ssd->front_buffer);
+}
+
+// Inicia o envio assíncrono das faixas sujas, agrupadas como em
+// ssd1306_send_dirty: cada sequência de páginas sujas consecutivas vira uma
+// janela só (união das colunas) ou uma janela por página, o que custar menos
+// bytes. As janelas são copiadas para front_buffer (comandos com Co = 1 antes
+// dos dados) e entregues ao DMA uma transação por janela; o desenho pode
+// continuar em ram_buffer logo em seguida. Se outro painel ocupa o
+// barramento, o envio entra na fila. Retorna false, sem fazer nada, se o
+// envio anterior deste painel ainda não terminou.
+bool ssd1306_flush_async(ssd1306_t *ssd) {
+  ssd1306_flush_poll();
+  if (ssd->flush_state != SSD1306_FLUSH_IDLE)
+    return false;
+
+  if (ssd->flush_failed) {
+    ssd->flush_failed = false;
+    for (uint8_t page = 0; page < ssd->pages; ++page)
+      if (ssd->front_x0[page] <= ssd->front_x1[page])
+        ssd1306_mark_dirty(ssd, ssd->front_x0[page], ssd->front_x1[page], page, page);
+  }
+
+  memset(ssd->front_x0, 0xFF, sizeof(ssd->front_x0));
+  memset(ssd->front_x1, 0x00, sizeof(ssd->front_x1));
+  ssd->front_windows = 0;
+  ssd->front_start[0] = 0;
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (ssd->dirty_x0[page] > ssd->dirty_x1[page]) {
+      ++page;
+      continue;
+    }
+    uint8_t last = page;
+    uint8_t x0 = 0xFF, x1 = 0;
+    uint32_t separate = 0;
+    while (last < ssd->pages && ssd->dirty_x0[last] <= ssd->dirty_x1[last]) {
+      separate += SSD1306_ASYNC_WINDOW_COST + ssd->dirty_x1[last] - ssd->dirty_x0[last] + 1;
+      if (ssd->dirty_x0[last] < x0)
+        x0 = ssd->dirty_x0[last];
+      if (ssd->dirty_x1[last] > x1)
+        x1 = ssd->dirty_x1[last];
+      ++last;
+    }
+    uint32_t merged = SSD1306_ASYNC_WINDOW_COST + (uint32_t)(last - page) * (x1 - x0 + 1);
+    if (merged <= separate) {
+      ssd1306_front_window(ssd, x0, x1, page, last - 1);
+    } else {
+      for (uint8_t p = page; p < last; ++p)
+        ssd1306_front_window(ssd, ssd->dirty_x0[p], ssd->dirty_x1[p], p, p);
+    }
+    page = last;
+  }
+  if (ssd->front_windows == 0)
+    return true;  // Nada a enviar
+  ssd1306_clear_dirty(ssd);
+
+  ssd->front_next = 0;
+  ssd->flush_state = SSD1306_FLUSH_QUEUED;
+  ssd1306_flush_poll();
+  return true;
+}
+
+bool ssd1306_flush_busy(ssd1306_t *ssd) {
+  ssd1306_flush_poll();
+  return ssd->flush_state != SSD1306_FLUSH_IDLE;
+}
+
+void ssd1306_flush_wait(ssd1306_t *ssd) {
+  while (ssd1306_flush_busy(ssd))
+    tight_loop_contents();
+}
+
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb) {
+  ssd->flush_done = cb;
+}
+
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  for (uint8_t page = page0; page <= page1 && page < ssd->pages; ++page) {
+    if (x0 < ssd->dirty_x0[page])
+      ssd->dirty_x0[page] = x0;
+    if (x1 > ssd->dirty_x1[page])
+      ssd->dirty_x1[page] = x1;
+  }
+}
+
+void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  memset(ssd->dirty_x0, 0xFF, sizeof(ssd->dirty_x0));
+  memset(ssd->dirty_x1, 0x00, sizeof(ssd->dirty_x1));
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint8_t page = y >> 3;
+  uint8_t *byte = &ssd->ram_buffer[page * ssd->width + x + 1];
+  uint8_t old = *byte;
   if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
+    *byte |= (1 << (y & 0b111));
   else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+    *byte &= ~(1 << (y & 0b111));
+  if (*byte != old) {
+    if (x < ssd->dirty_x0[page])
+      ssd->dirty_x0[page] = x;
+    if (x > ssd->dirty_x1[page])
+      ssd->dirty_x1[page] = x;
+  }
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Acesso em palavras de 32 bits ao buffer de bytes sem violar o aliasing estrito
+typedef uint32_t __attribute__((may_alias)) ssd1306_word_t;
+
+// Aplica mask (bits da página) às colunas x0..x1 de uma página, ligando ou
+// desligando os pixels. O trecho alinhado é processado 32 bits por vez e a
+// página só é marcada como suja se algum byte mudou.
+static void ssd1306_span(ssd1306_t *ssd, uint8_t page, uint8_t x0, uint8_t x1, uint8_t mask, bool value) {
+  uint8_t *p = &ssd->ram_buffer[1 + page * ssd->width + x0];
+  uint8_t *end = p + (x1 - x0 + 1);
+  uint32_t changed = 0;
+
+  while (p < end && ((uintptr_t)p & 3u)) {
+    uint8_t old = *p;
+    *p = value ? (old | mask) : (old & ~mask);
+    changed |= old ^ *p++;
+  }
+  uint32_t mask32 = mask * 0x01010101u;
+  for (; end - p >= 4; p += 4) {
+    ssd1306_word_t *w = (ssd1306_word_t *)p;
+    uint32_t old = *w;
+    *w = value ? (old | mask32) : (old & ~mask32);
+    changed |= old ^ *w;
+  }
+  while (p < end) {
+    uint8_t old = *p;
+    *p = value ? (old | mask) : (old & ~mask);
+    changed |= old ^ *p++;
+  }
+
+  if (changed)
+    ssd1306_mark_dirty(ssd, x0, x1, page, page);
+}
+
+// Bits da página page ocupados pelas linhas y0..y1
+static uint8_t ssd1306_page_mask(uint8_t page, uint8_t y0, uint8_t y1) {
+  uint8_t first = (y0 >> 3) == page ? (y0 & 0b111) : 0;
+  uint8_t last = (y1 >> 3) == page ? (y1 & 0b111) : 7;
+  return (uint8_t)((0xFF << first) & (0xFF >> (7 - last)));
+}
+
+// Preenche o retângulo [x0, x1] x [y0, y1], já recortado à tela
+static void ssd1306_fill_area(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool value) {
+  for (uint8_t page = y0 >> 3; page <= (y1 >> 3); ++page)
+    ssd1306_span(ssd, page, x0, x1, ssd1306_page_mask(page, y0, y1), value);
+}
 
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  for (uint8_t page = 0; page < ssd->pages; ++page)
+    ssd1306_span(ssd, page, 0, ssd->width - 1, 0xFF, value);
 }
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (width == 0 || height == 0 || left >= ssd->width || top >= ssd->height)
+    return;
+  int right = left + width - 1;
+  int bottom = top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    ssd1306_fill_area(ssd, left, right < ssd->width ? right : ssd->width - 1,
+                      top, bottom < ssd->height ? bottom : ssd->height - 1, value);
+    return;
   }
+
+  // Contorno: bordas fora da tela são descartadas, as demais recortadas
+  ssd1306_hline(ssd, left, right < ssd->width ? right : ssd->width - 1, top, value);
+  if (bottom < ssd->height)
+    ssd1306_hline(ssd, left, right < ssd->width ? right : ssd->width - 1, bottom, value);
+  ssd1306_vline(ssd, left, top, bottom < ssd->height ? bottom : ssd->height - 1, value);
+  if (right < ssd->width)
+    ssd1306_vline(ssd, right, top, bottom < ssd->height ? bottom : ssd->height - 1, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -142,40 +458,116 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x0 > x1) {
+    uint8_t t = x0;
+    x0 = x1;
+    x1 = t;
+  }
+  if (y >= ssd->height || x0 >= ssd->width)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  ssd1306_span(ssd, y >> 3, x0, x1, 1 << (y & 0b111), value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y0 > y1) {
+    uint8_t t = y0;
+    y0 = y1;
+    y1 = t;
+  }
+  if (x >= ssd->width || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  ssd1306_fill_area(ssd, x, x, y0, y1, value);
+}
+
+// Desloca as colunas x0..x1 das páginas page0..page1 columns posições para a
+// esquerda; as columns colunas da direita ficam com o conteúdo antigo, para o
+// chamador redesenhar. Toda a faixa é marcada como suja.
+void ssd1306_shift_left(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1, uint8_t columns) {
+  if (x0 > x1 || x0 >= ssd->width || page0 > page1 || page0 >= ssd->pages)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (page1 >= ssd->pages)
+    page1 = ssd->pages - 1;
+  if (columns == 0 || columns > x1 - x0)
+    return;
+  for (uint8_t page = page0; page <= page1; ++page) {
+    uint8_t *row = &ssd->ram_buffer[1 + page * ssd->width + x0];
+    memmove(row, row + columns, (size_t)(x1 - x0 + 1 - columns));
+  }
+  ssd1306_mark_dirty(ssd, x0, x1, page0, page1);
 }
 
-// Função para desenhar um caractere
+// Escreve count bytes (um por página, a partir de page0) na coluna x
+void ssd1306_put_column(ssd1306_t *ssd, uint8_t x, uint8_t page0, const uint8_t *bytes, uint8_t count) {
+  if (x >= ssd->width)
+    return;
+  uint8_t first = 0xFF, last = 0;
+  for (uint8_t i = 0; i < count && page0 + i < ssd->pages; ++i) {
+    uint8_t *byte = &ssd->ram_buffer[1 + (page0 + i) * ssd->width + x];
+    if (*byte == bytes[i])
+      continue;
+    *byte = bytes[i];
+    if (first == 0xFF)
+      first = i;
+    last = i;
+  }
+  if (first != 0xFF)
+    ssd1306_mark_dirty(ssd, x, x, page0 + first, page0 + last);
+}
+
+// Função para desenhar um caractere (opaco: o fundo do glifo também é escrito)
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
-  char ver=c;
-  if (c >= 'A' && c <= 'Z')
-  {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
-  }else  if (c >= '0' && c <= '9')
-  {
-    index = (c - '0' + 1) * 8; // Adiciona o deslocamento necessário
-  }
-  // para letras minusculas
-  else if(c >= 'a' && c <= 'z') 
-    index = (c - 'a' + 37) * 8;
-  else if(c == ' ')
-    index = 0;
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR)
+    c = ' ';
+  const uint8_t *glyph = &font[(c - FONT_FIRST_CHAR) * FONT_WIDTH];
+  uint8_t cols = (ssd->width - x < FONT_WIDTH) ? ssd->width - x : FONT_WIDTH;
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t *row = &ssd->ram_buffer[1 + page * ssd->width + x];
+
+  // Alinhado à página: o glifo é exatamente um trecho da linha da página
+  if (shift == 0) {
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < cols; ++i) {
+      changed |= row[i] ^ glyph[i];
+      row[i] = glyph[i];
     }
+    if (changed)
+      ssd1306_mark_dirty(ssd, x, x + cols - 1, page, page);
+    return;
+  }
+
+  // Desalinhado: a parte de cima vai para a página atual e o restante para a
+  // página seguinte, deslocados e mesclados com máscara
+  uint8_t top_mask = 0xFF << shift;
+  uint8_t changed = 0;
+  for (uint8_t i = 0; i < cols; ++i) {
+    uint8_t old = row[i];
+    row[i] = (old & ~top_mask) | (uint8_t)(glyph[i] << shift);
+    changed |= old ^ row[i];
+  }
+  if (changed)
+    ssd1306_mark_dirty(ssd, x, x + cols - 1, page, page);
+
+  if (page + 1 >= ssd->pages)
+    return;
+  row += ssd->width;
+  changed = 0;
+  for (uint8_t i = 0; i < cols; ++i) {
+    uint8_t old = row[i];
+    row[i] = (old & top_mask) | (glyph[i] >> (8 - shift));
+    changed |= old ^ row[i];
   }
+  if (changed)
+    ssd1306_mark_dirty(ssd, x, x + cols - 1, page + 1, page + 1);
 }
 
 // Função para desenhar uma string
@@ -1,9 +1,36 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
+#include "hal.h"
+
+// Geometria padrão e orientação dos painéis, fixas na compilação (ex.:
+// -DSSD1306_HEIGHT=32). Cada painel tem a própria geometria (SSD1306_DEFINE);
+// alturas de 64 e 32 linhas têm sequência de inicialização pronta.
+#ifndef SSD1306_WIDTH
+#define SSD1306_WIDTH 128
+#endif
+#ifndef SSD1306_HEIGHT
+#define SSD1306_HEIGHT 64       // 64 ou 32
+#endif
+#ifndef SSD1306_ROTATE_180
+#define SSD1306_ROTATE_180 0    // 1 = painel montado de cabeça para baixo
+#endif
+#define SSD1306_MAX_PAGES 8
+
+#define SSD1306_MAX_PANELS 4    // Painéis que podem dividir barramentos
+
+// Byte de controle de uma transação só de comandos (Co = 0, D/C = 0)
+#define SSD1306_COMMAND_STREAM 0x00
 
-#define WIDTH 128
-#define HEIGHT 64
+// Buffers de um painel: o de desenho tem um byte de controle antes das
+// páginas; o frontal, uma transação por janela (no máximo uma por página),
+// cada uma com a janela de escrita (SSD1306_WINDOW_HEADER bytes) e o byte de
+// controle antes dos dados
+#define SSD1306_WINDOW_HEADER 12
+#define SSD1306_BUFFER_SIZE(width, height) ((size_t)(width) * ((height) / 8) + 1)
+#define SSD1306_FRONT_SIZE(width, height) \
+  ((SSD1306_WINDOW_HEADER + 1) * ((height) / 8) + SSD1306_BUFFER_SIZE(width, height) - 1)
 
 
 typedef enum {
@@ -26,23 +53,76 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
-typedef struct {
+typedef struct ssd1306 ssd1306_t;
+typedef void (*ssd1306_flush_cb_t)(ssd1306_t *ssd, bool ok);
+
+// Estado do envio assíncrono de um painel
+enum {
+  SSD1306_FLUSH_IDLE,
+  SSD1306_FLUSH_QUEUED,     // Buffer frontal pronto, esperando o barramento
+  SSD1306_FLUSH_SENDING,
+};
+
+struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t *ram_buffer;      // SSD1306_BUFFER_SIZE(width, height) bytes
   size_t bufsize;
   uint8_t port_buffer[2];
-} ssd1306_t;
+  // Faixa de colunas alteradas em cada página desde o último envio
+  // (dirty_x0 > dirty_x1 indica página limpa)
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];
+  // Envio assíncrono: o desenho continua em ram_buffer (buffer de fundo)
+  // enquanto o DMA transmite a cópia em front_buffer (buffer frontal), uma
+  // transação com janela e dados por faixa de páginas sujas; a conclusão de
+  // cada uma inicia a seguinte. Com o barramento ocupado por outro painel, o
+  // envio fica na fila (SSD1306_FLUSH_QUEUED) e parte, em revezamento, quando
+  // o quadro em trânsito termina.
+  uint8_t *front_buffer;    // SSD1306_FRONT_SIZE(width, height) bytes
+  uint16_t front_start[SSD1306_MAX_PAGES + 1];   // Janela i: front_start[i] .. front_start[i + 1]
+  uint8_t front_windows;
+  volatile uint8_t front_next;                   // Janela em trânsito
+  // Colunas de cada página no envio em andamento; se ele falhar, voltam a
+  // ser sujas no próximo ssd1306_flush_async
+  uint8_t front_x0[SSD1306_MAX_PAGES];
+  uint8_t front_x1[SSD1306_MAX_PAGES];
+  volatile bool flush_failed;
+  volatile uint32_t flush_errors;   // Envios assíncronos abortados (NACK)
+  volatile uint8_t flush_state;
+  ssd1306_flush_cb_t flush_done;
+};
 
+// Painel com buffers fornecidos pelo chamador
+#define SSD1306_PANEL(width_, height_, ram, front)                                   \
+  { .width = (width_), .height = (height_), .ram_buffer = (ram),                     \
+    .bufsize = SSD1306_BUFFER_SIZE(width_, height_), .front_buffer = (front) }
 
-extern ssd1306_t ssd;
+// Painel com buffers estáticos dimensionados na compilação, sem heap
+#define SSD1306_DEFINE(name, width, height)                                          \
+  _Static_assert((height) == 64 || (height) == 32, "altura do painel: 64 ou 32");    \
+  _Static_assert((width) > 0 && (width) <= 128, "largura do painel: até 128");       \
+  static uint8_t name##_ram[SSD1306_BUFFER_SIZE(width, height)];                     \
+  static uint8_t name##_front[SSD1306_FRONT_SIZE(width, height)];                    \
+  static ssd1306_t name = SSD1306_PANEL(width, height, name##_ram, name##_front)
 
-
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+// Prepara o painel já definido (geometria e buffers) no endereço e barramento
+// dados e o registra para a fila de envios do barramento
+void ssd1306_init(ssd1306_t *ssd, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_command_stream(ssd1306_t *ssd, const uint8_t *stream, size_t len);
+void ssd1306_display(ssd1306_t *ssd, bool ligado);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_dirty(ssd1306_t *ssd);
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1);
+void ssd1306_clear_dirty(ssd1306_t *ssd);
+bool ssd1306_flush_async(ssd1306_t *ssd);
+bool ssd1306_flush_busy(ssd1306_t *ssd);
+void ssd1306_flush_poll(void);
+void ssd1306_flush_wait(ssd1306_t *ssd);
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -50,6 +130,11 @@ void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+// Operações por coluna de páginas inteiras (gráficos rolantes)
+void ssd1306_shift_left(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1, uint8_t columns);
+void ssd1306_put_column(ssd1306_t *ssd, uint8_t x, uint8_t page0, const uint8_t *bytes, uint8_t count);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
-void ssd1306_text(ssd1306_t *ssd, const char *text, uint8_t x, uint8_t y, bool value);
\ No newline at end of file
+void ssd1306_text(ssd1306_t *ssd, const char *text, uint8_t x, uint8_t y, bool value);
+
+#endif
@@ -0,0 +1,201 @@
+#include <string.h>
+#include "telemetria.h"
+#include "crc16.h"
+
+#define SINCRONIA_0   0xA5
+#define SINCRONIA_1   0x5A
+#define CABECALHO     4       // Sincronia + comprimento
+#define RODAPE        2       // CRC
+
+// -----------------------------------------------------------------------------
+// VARINTS (7 bits por byte, bit 7 = continua) E ZIGZAG
+// -----------------------------------------------------------------------------
+static uint8_t *escrever_varint(uint8_t *p, uint32_t v) {
+  while (v >= 0x80) {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t dezigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Lê um varint de no máximo 5 bytes; NULL se a carga acabar antes
+static const uint8_t *ler_varint(const uint8_t *p, const uint8_t *fim, uint32_t *v) {
+  uint32_t x = 0;
+  for (int deslocamento = 0; deslocamento < 35; deslocamento += 7) {
+    if (p >= fim)
+      return NULL;
+    uint8_t b = *p++;
+    x |= (uint32_t)(b & 0x7F) << deslocamento;
+    if (!(b & 0x80)) {
+      *v = x;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// QUADROS
+// -----------------------------------------------------------------------------
+size_t telemetria_codificar(const registro_t *r, uint8_t n, uint8_t *quadro) {
+  uint8_t *p = quadro + CABECALHO;
+  *p++ = TELEMETRIA_TIPO_LOTE;
+  *p++ = n;
+  for (uint8_t i = 0; i < n; ++i) {
+    if (i == 0) {
+      p = escrever_varint(p, r[0].sequencia);
+      p = escrever_varint(p, r[0].instante_us);
+      p = escrever_varint(p, zigzag(r[0].umidade));
+      p = escrever_varint(p, r[0].desejada);
+      p = escrever_varint(p, r[0].bomba);
+    } else {
+      // Subtrações em uint32_t: a volta do contador de tempo sai de graça
+      p = escrever_varint(p, r[i].sequencia - r[i - 1].sequencia - 1);
+      p = escrever_varint(p, r[i].instante_us - r[i - 1].instante_us);
+      p = escrever_varint(p, zigzag(r[i].umidade - r[i - 1].umidade));
+      p = escrever_varint(p, zigzag(r[i].desejada - r[i - 1].desejada));
+      p = escrever_varint(p, zigzag(r[i].bomba - r[i - 1].bomba));
+    }
+    *p++ = r[i].flags;
+  }
+
+  size_t carga = (size_t)(p - quadro) - CABECALHO;
+  quadro[0] = SINCRONIA_0;
+  quadro[1] = SINCRONIA_1;
+  quadro[2] = (uint8_t)carga;
+  quadro[3] = (uint8_t)(carga >> 8);
+  uint16_t crc = crc16_ccitt(quadro + 2, carga + 2);
+  *p++ = (uint8_t)crc;
+  *p++ = (uint8_t)(crc >> 8);
+  return (size_t)(p - quadro);
+}
+
+size_t telemetria_tamanho_quadro(const uint8_t *dados, size_t disponiveis) {
+  if (disponiveis < CABECALHO || dados[0] != SINCRONIA_0 || dados[1] != SINCRONIA_1)
+    return 0;
+  size_t carga = dados[2] | (size_t)dados[3] << 8;
+  if (carga < 2 || CABECALHO + carga + RODAPE > TELEMETRIA_QUADRO_MAX)
+    return 0;
+  return CABECALHO + carga + RODAPE;
+}
+
+bool telemetria_decodificar(const uint8_t *quadro, size_t tamanho, registro_t *r, uint8_t *n) {
+  if (telemetria_tamanho_quadro(quadro, tamanho) != tamanho)
+    return false;
+  size_t carga = tamanho - CABECALHO - RODAPE;
+  uint16_t crc = (uint16_t)(quadro[tamanho - 2] | quadro[tamanho - 1] << 8);
+  if (crc16_ccitt(quadro + 2, carga + 2) != crc)
+    return false;
+
+  const uint8_t *p = quadro + CABECALHO;
+  const uint8_t *fim = p + carga;
+  if (*p++ != TELEMETRIA_TIPO_LOTE)
+    return false;
+  uint8_t quantidade = *p++;
+  if (quantidade > TELEMETRIA_LOTE)
+    return false;
+
+  for (uint8_t i = 0; i < quantidade; ++i) {
+    uint32_t v[5];
+    for (int k = 0; k < 5; ++k)
+      if (!(p = ler_varint(p, fim, &v[k])))
+        return false;
+    if (p >= fim)
+      return false;
+    if (i == 0) {
+      r[0].sequencia = v[0];
+      r[0].instante_us = v[1];
+      r[0].umidade = (int16_t)dezigzag(v[2]);
+      r[0].desejada = (uint16_t)v[3];
+      r[0].bomba = (uint16_t)v[4];
+    } else {
+      r[i].sequencia = r[i - 1].sequencia + v[0] + 1;
+      r[i].instante_us = r[i - 1].instante_us + v[1];
+      r[i].umidade = (int16_t)(r[i - 1].umidade + dezigzag(v[2]));
+      r[i].desejada = (uint16_t)(r[i - 1].desejada + dezigzag(v[3]));
+      r[i].bomba = (uint16_t)(r[i - 1].bomba + dezigzag(v[4]));
+    }
+    r[i].flags = *p++;
+  }
+  *n = quantidade;
+  return p == fim;
+}
+
+// -----------------------------------------------------------------------------
+// PRODUTOR
+// -----------------------------------------------------------------------------
+bool telemetria_registrar(telemetria_t *t, const registro_t *r) {
+  registro_t numerado = *r;
+  // A sequência avança mesmo quando a fila recusa, para a perda aparecer
+  // como lacuna no decodificador
+  numerado.sequencia = t->proxima_sequencia++;
+  return fila_spsc_enviar(t->fila, &numerado);
+}
+
+// -----------------------------------------------------------------------------
+// CONSUMIDOR
+// -----------------------------------------------------------------------------
+static void fechar_lote(telemetria_t *t) {
+  uint8_t quadro[TELEMETRIA_QUADRO_MAX];
+  uint32_t tamanho = (uint32_t)telemetria_codificar(t->lote, t->no_lote, quadro);
+  if (TELEMETRIA_ANEL - (t->cabeca - t->cauda) < tamanho) {
+    t->descartados += t->no_lote;
+  } else {
+    // Cópia em até dois trechos (antes e depois da volta do anel)
+    uint32_t inicio = t->cabeca & (TELEMETRIA_ANEL - 1);
+    uint32_t primeiro = TELEMETRIA_ANEL - inicio;
+    if (primeiro > tamanho)
+      primeiro = tamanho;
+    memcpy(&t->anel[inicio], quadro, primeiro);
+    memcpy(t->anel, quadro + primeiro, tamanho - primeiro);
+    t->cabeca += tamanho;
+    t->quadros++;
+  }
+  t->no_lote = 0;
+}
+
+void telemetria_processar(telemetria_t *t, bool forcar) {
+  while (fila_spsc_receber(t->fila, &t->lote[t->no_lote]))
+    if (++t->no_lote == TELEMETRIA_LOTE)
+      fechar_lote(t);
+  if (forcar && t->no_lote)
+    fechar_lote(t);
+}
+
+uint32_t telemetria_escoar(telemetria_t *t, uint32_t max) {
+  // Só quadros inteiros (pelo menos um por chamada), para o texto do printf
+  // entre duas chamadas não cair no meio de um quadro
+  uint32_t enviados = 0;
+  while (t->cabeca != t->cauda) {
+    uint32_t carga = t->anel[(t->cauda + 2) & (TELEMETRIA_ANEL - 1)] |
+                     (uint32_t)t->anel[(t->cauda + 3) & (TELEMETRIA_ANEL - 1)] << 8;
+    uint32_t tamanho = CABECALHO + carga + RODAPE;
+    if (enviados && enviados + tamanho > max)
+      break;
+    // Até dois trechos contíguos (antes e depois da volta do anel)
+    uint32_t inicio = t->cauda & (TELEMETRIA_ANEL - 1);
+    uint32_t primeiro = TELEMETRIA_ANEL - inicio;
+    if (primeiro > tamanho)
+      primeiro = tamanho;
+    t->saida(&t->anel[inicio], primeiro);
+    if (tamanho > primeiro)
+      t->saida(t->anel, tamanho - primeiro);
+    t->cauda += tamanho;
+    enviados += tamanho;
+  }
+  t->bytes += enviados;
+  return enviados;
+}
+
+uint32_t telemetria_perdidos(const telemetria_t *t) {
+  return t->fila->descartadas + t->descartados;
+}
@@ -0,0 +1,95 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include "hal.h"
+#include "fila_spsc.h"
+
+// =============================================================================
+// TELEMETRIA BINÁRIA EM LOTES
+// O produtor (núcleo 0) grava registros de tamanho fixo numa fila sem travas;
+// o consumidor (núcleo 1) junta até TELEMETRIA_LOTE registros num quadro,
+// comprimidos por diferença em relação ao registro anterior (varint com
+// zigzag), e põe o quadro num anel de bytes que é escoado em blocos para a
+// saída (UART/USB).
+//
+// Quadro:  A5 5A | comprimento (2, LE) | carga | CRC-16/CCITT (2, LE)
+// O CRC cobre o comprimento e a carga. O decodificador procura A5 5A e valida
+// comprimento e CRC, então o fluxo tolera texto misturado (printf) e bytes
+// perdidos. Carga:
+//   tipo (1) = TELEMETRIA_TIPO_LOTE | n (1)
+//   1º registro: sequência, instante, umidade (zigzag), desejada, bomba
+//                (varints) e flags (1 byte)
+//   demais:      saltos de sequência - 1, Δinstante, Δumidade, Δdesejada,
+//                Δbomba (varints, deltas em zigzag) e flags (1 byte)
+// A sequência cresce 1 por registro no produtor, então lacunas na sequência
+// decodificada medem exatamente as perdas.
+// =============================================================================
+
+#define TELEMETRIA_LOTE        32     // Registros por quadro
+#define TELEMETRIA_ANEL        2048   // Bytes no anel de saída (potência de 2)
+#define TELEMETRIA_TIPO_LOTE   0x01
+// Pior caso: cabeçalho, tipo, n e CRC (8) + 20 bytes por registro (dois
+// varints de 32 bits, três de 16 bits em zigzag e as flags)
+#define TELEMETRIA_QUADRO_MAX  (8 + TELEMETRIA_LOTE * 20)
+
+// Flags do registro
+#define TELEMETRIA_LIGADO      0x01
+#define TELEMETRIA_MANUAL      0x02
+#define TELEMETRIA_ZONA(z)     ((uint8_t)((z) << 2))   // Zona nos bits 2..7
+
+typedef struct {
+  uint32_t sequencia;       // Preenchida por telemetria_registrar
+  uint32_t instante_us;     // Dá a volta a cada ~71 min; só as diferenças importam
+  int16_t umidade;          // Décimos de porcento
+  uint16_t desejada;        // Décimos de porcento
+  uint16_t bomba;           // Nível de PWM
+  uint8_t flags;
+} registro_t;
+
+typedef void (*telemetria_saida_t)(const uint8_t *dados, size_t tamanho);
+
+typedef struct {
+  fila_spsc_t *fila;               // Registros do produtor para o consumidor
+  telemetria_saida_t saida;
+
+  // Produtor
+  uint32_t proxima_sequencia;
+
+  // Consumidor
+  registro_t lote[TELEMETRIA_LOTE];
+  uint8_t no_lote;
+  uint8_t anel[TELEMETRIA_ANEL];
+  uint32_t cabeca, cauda;          // Índices livres no anel (só o consumidor usa)
+  uint32_t quadros;
+  uint32_t bytes;
+  uint32_t descartados;            // Registros perdidos por anel cheio
+} telemetria_t;
+
+// Fila e estado para capacidade registros em trânsito entre os núcleos
+#define TELEMETRIA_DEFINIR(nome, cap, funcao_saida)                       \
+  FILA_SPSC_DEFINIR(nome##_fila, registro_t, cap);                       \
+  static telemetria_t nome = { .fila = &nome##_fila, .saida = (funcao_saida) }
+
+// Produtor: numera e enfileira o registro; false se a fila estiver cheia
+bool telemetria_registrar(telemetria_t *t, const registro_t *r);
+
+// Consumidor: fecha quadros com os registros enfileirados. Com forcar, fecha
+// também um lote incompleto (para não reter registros por muito tempo).
+void telemetria_processar(telemetria_t *t, bool forcar);
+
+// Consumidor: envia quadros inteiros do anel para a saída até somar max bytes
+// (sempre ao menos um, se houver); retorna quantos bytes
+uint32_t telemetria_escoar(telemetria_t *t, uint32_t max);
+
+// Registros perdidos até agora (fila cheia + anel cheio)
+uint32_t telemetria_perdidos(const telemetria_t *t);
+
+// Codificação e decodificação de um quadro completo (do A5 ao CRC)
+size_t telemetria_codificar(const registro_t *r, uint8_t n, uint8_t *quadro);
+bool telemetria_decodificar(const uint8_t *quadro, size_t tamanho, registro_t *r, uint8_t *n);
+
+// Tamanho do quadro que começa em dados (0 se ainda incompleto ou se o
+// cabeçalho não for válido)
+size_t telemetria_tamanho_quadro(const uint8_t *dados, size_t disponiveis);
+
+#endif
@@ -0,0 +1,127 @@
+#include <string.h>
+#include "ui.h"
+
+// Desenha str a partir de (x, y) numa única linha; retorna a largura em pixels
+static uint8_t ui_texto(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+  uint8_t inicio = x;
+  while (*str && x < ssd->width) {
+    ssd1306_draw_char(ssd, *str++, x, y);
+    x = (x + 8 < ssd->width) ? x + 8 : ssd->width;
+  }
+  return x - inicio;
+}
+
+// Converte valor para decimal em buf (mínimo 6 bytes), sem usar snprintf
+static const char *ui_decimal(uint16_t valor, char *buf) {
+  char *p = buf + 5;
+  *p = '\0';
+  do {
+    *--p = '0' + valor % 10;
+    valor /= 10;
+  } while (valor);
+  return p;
+}
+
+// Apaga o que sobrou de um texto anterior mais largo que o atual
+static void ui_apagar_sobra(ssd1306_t *ssd, ui_widget_t *w, uint8_t colunas) {
+  if (w->colunas > colunas)
+    ssd1306_rect(ssd, w->y, w->x + colunas, w->colunas - colunas, 8, false, true);
+  w->colunas = colunas;
+}
+
+static uint16_t ui_largura_barra(const ui_widget_t *w, uint16_t valor) {
+  uint16_t interno = w->largura - 2;
+  if (valor >= w->maximo)
+    return interno;
+  return (uint32_t)valor * interno / w->maximo;
+}
+
+static bool ui_desenhar(ssd1306_t *ssd, ui_widget_t *w) {
+  switch (w->tipo) {
+    case UI_ROTULO:
+      if (w->valido)
+        return false;
+      ssd1306_text(ssd, w->texto, w->x, w->y, true);
+      break;
+
+    case UI_NUMERO: {
+      uint16_t valor = *w->valor;
+      if (w->valido && valor == w->desenhado)
+        return false;
+      // O prefixo só é desenhado uma vez; depois, apenas os dígitos e o sufixo
+      uint8_t colunas = 0;
+      if (!w->valido)
+        colunas = ui_texto(ssd, w->texto, w->x, w->y);
+      else
+        colunas = strlen(w->texto) * 8;
+      char buf[6];
+      colunas += ui_texto(ssd, ui_decimal(valor, buf), w->x + colunas, w->y);
+      if (w->extra)
+        colunas += ui_texto(ssd, w->extra, w->x + colunas, w->y);
+      ui_apagar_sobra(ssd, w, colunas);
+      w->desenhado = valor;
+      break;
+    }
+
+    case UI_ALTERNATIVA: {
+      uint16_t valor = *w->condicao ? 1 : 0;
+      if (w->valido && valor == w->desenhado)
+        return false;
+      uint8_t colunas = ui_texto(ssd, valor ? w->texto : w->extra, w->x, w->y);
+      ui_apagar_sobra(ssd, w, colunas);
+      w->desenhado = valor;
+      break;
+    }
+
+    case UI_BARRA:
+    case UI_MEDIDOR: {
+      uint16_t preenchido = ui_largura_barra(w, *w->valor);
+      uint8_t marca = 0;
+      if (w->tipo == UI_MEDIDOR) {
+        // A marca ocupa uma coluna do interior, mesmo com a referência no máximo
+        uint16_t m = ui_largura_barra(w, *w->referencia);
+        marca = (uint8_t)(m < w->largura - 2 ? m : w->largura - 3);
+      }
+      if (w->valido && preenchido == w->desenhado && marca == w->colunas)
+        return false;
+      if (!w->valido) {
+        ssd1306_rect(ssd, w->y, w->x, w->largura, w->altura, false, true);
+        ssd1306_rect(ssd, w->y, w->x, w->largura, w->altura, true, false);
+        w->desenhado = 0;
+      } else if (w->tipo == UI_MEDIDOR && marca != w->colunas) {
+        // Devolve à coluna da marca antiga o estado da barra
+        ssd1306_vline(ssd, w->x + 1 + w->colunas, w->y + 1, w->y + w->altura - 2,
+                      w->colunas < w->desenhado);
+      }
+      // Só a diferença entre a barra anterior e a nova é redesenhada
+      uint16_t de = preenchido < w->desenhado ? preenchido : w->desenhado;
+      uint16_t ate = preenchido < w->desenhado ? w->desenhado : preenchido;
+      if (ate > de)
+        ssd1306_rect(ssd, w->y + 1, w->x + 1 + de, ate - de, w->altura - 2,
+                     preenchido > w->desenhado, true);
+      // A marca tem a cor oposta à da barra sob ela, para aparecer nos dois lados
+      if (w->tipo == UI_MEDIDOR) {
+        ssd1306_vline(ssd, w->x + 1 + marca, w->y + 1, w->y + w->altura - 2, marca >= preenchido);
+        w->colunas = marca;
+      }
+      w->desenhado = preenchido;
+      break;
+    }
+  }
+  w->valido = true;
+  return true;
+}
+
+void ui_invalidar(ui_tela_t *tela) {
+  for (uint8_t i = 0; i < tela->quantidade; ++i) {
+    tela->widgets[i].valido = false;
+    tela->widgets[i].colunas = 0;
+  }
+}
+
+uint8_t ui_atualizar(ssd1306_t *ssd, ui_tela_t *tela) {
+  uint8_t redesenhados = 0;
+  for (uint8_t i = 0; i < tela->quantidade; ++i)
+    redesenhados += ui_desenhar(ssd, &tela->widgets[i]);
+  return redesenhados;
+}
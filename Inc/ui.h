@@ -0,0 +1,64 @@
+#ifndef UI_H
+#define UI_H
+
+#include "ssd1306.h"
+
+// =============================================================================
+// CAMADA DE INTERFACE RETIDA (WIDGETS)
+// Cada widget fica ligado a uma variável do programa e guarda o último valor
+// desenhado. ui_atualizar() só redesenha os widgets cujo valor mudou, e só essa
+// área é marcada como suja no framebuffer; um quadro sem mudanças não custa
+// desenho nem tráfego I2C.
+// =============================================================================
+
+typedef enum {
+  UI_ROTULO,        // Texto fixo
+  UI_NUMERO,        // Prefixo fixo + valor inteiro + sufixo
+  UI_ALTERNATIVA,   // Um de dois textos, conforme uma variável booleana
+  UI_BARRA,         // Barra horizontal proporcional a um valor
+  UI_MEDIDOR        // Barra com uma marca na posição de um valor de referência
+} ui_tipo_t;
+
+typedef struct {
+  ui_tipo_t tipo;
+  uint8_t x, y;
+  uint8_t largura, altura;          // UI_BARRA: tamanho da barra
+  const char *texto;                // Rótulo, prefixo ou texto para "verdadeiro"
+  const char *extra;                // Sufixo ou texto para "falso"
+  const volatile uint16_t *valor;   // UI_NUMERO, UI_BARRA e UI_MEDIDOR
+  const volatile uint16_t *referencia;  // UI_MEDIDOR: posição da marca
+  const volatile bool *condicao;    // UI_ALTERNATIVA
+  uint16_t maximo;                  // UI_BARRA e UI_MEDIDOR: valor da barra cheia
+  uint16_t desenhado;               // Valor exibido na última atualização
+  uint8_t colunas;                  // Largura em pixels do texto exibido
+                                    // (UI_MEDIDOR: coluna da marca exibida)
+  bool valido;                      // false força o redesenho completo
+} ui_widget_t;
+
+typedef struct {
+  ui_widget_t *widgets;
+  uint8_t quantidade;
+} ui_tela_t;
+
+#define UI_ROTULO(px, py, txt) \
+  { .tipo = UI_ROTULO, .x = (px), .y = (py), .texto = (txt) }
+#define UI_NUMERO(px, py, prefixo, var, sufixo) \
+  { .tipo = UI_NUMERO, .x = (px), .y = (py), .texto = (prefixo), .extra = (sufixo), .valor = (var) }
+#define UI_ALTERNATIVA(px, py, var, se_verdadeiro, se_falso) \
+  { .tipo = UI_ALTERNATIVA, .x = (px), .y = (py), .texto = (se_verdadeiro), .extra = (se_falso), .condicao = (var) }
+#define UI_BARRA(px, py, l, a, var, max) \
+  { .tipo = UI_BARRA, .x = (px), .y = (py), .largura = (l), .altura = (a), .valor = (var), .maximo = (max) }
+
+#define UI_MEDIDOR(px, py, l, a, var, ref, max) \
+  { .tipo = UI_MEDIDOR, .x = (px), .y = (py), .largura = (l), .altura = (a), .valor = (var), \
+    .referencia = (ref), .maximo = (max) }
+
+#define UI_TELA(vetor) { (vetor), sizeof(vetor) / sizeof((vetor)[0]) }
+
+// Força o redesenho de todos os widgets na próxima atualização
+void ui_invalidar(ui_tela_t *tela);
+
+// Redesenha os widgets alterados; retorna quantos foram redesenhados
+uint8_t ui_atualizar(ssd1306_t *ssd, ui_tela_t *tela);
+
+#endif
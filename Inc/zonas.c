@@ -0,0 +1,55 @@
+#include "zonas.h"
+
+void zonas_iniciar(zonas_t *z, uint8_t quantidade, int32_t desejada, int32_t saida_min) {
+  if (quantidade > ZONAS_MAX)
+    quantidade = ZONAS_MAX;
+  z->quantidade = quantidade;
+  z->na_janela = 0;
+  for (uint8_t i = 0; i < ZONAS_MAX; ++i) {
+    z->desejada[i] = desejada;
+    z->janela_inicio_min[i] = z->janela_fim_min[i] = 0;
+    z->umidade[i] = 0;
+    z->integral_q16[i] = 0;
+    z->medida_anterior[i] = 0;
+    z->saida[i] = saida_min;
+  }
+}
+
+void zonas_definir_janela(zonas_t *z, uint8_t zona, uint16_t inicio_min, uint16_t fim_min) {
+  if (zona >= z->quantidade)
+    return;
+  z->janela_inicio_min[zona] = inicio_min % 1440;
+  z->janela_fim_min[zona] = fim_min % 1440;
+}
+
+bool zonas_na_janela(const zonas_t *z, uint8_t zona, uint16_t minuto_do_dia) {
+  uint16_t inicio = z->janela_inicio_min[zona], fim = z->janela_fim_min[zona];
+  if (inicio == fim)
+    return true;
+  if (inicio < fim)
+    return minuto_do_dia >= inicio && minuto_do_dia < fim;
+  return minuto_do_dia >= inicio || minuto_do_dia < fim;
+}
+
+void zonas_controlar(zonas_t *z, const pid_config_t *config, bool ativo, uint16_t minuto_do_dia) {
+  uint64_t na_janela = 0;
+  for (uint8_t i = 0; i < z->quantidade && ativo; ++i)
+    if (zonas_na_janela(z, i, minuto_do_dia))
+      na_janela |= 1ull << i;
+
+  pid_passo_vetor(config, z->quantidade, z->desejada, z->umidade, z->integral_q16,
+                  z->medida_anterior, z->saida);
+
+  // Zonas fora da janela: controlador reiniciado, sem salto do derivativo
+  // quando voltarem
+  if (na_janela != (z->quantidade == 64 ? ~0ull : (1ull << z->quantidade) - 1)) {
+    for (uint8_t i = 0; i < z->quantidade; ++i) {
+      if (!(na_janela & (1ull << i))) {
+        z->integral_q16[i] = 0;
+        z->saida[i] = config->saida_min;
+        z->medida_anterior[i] = z->umidade[i];
+      }
+    }
+  }
+  z->na_janela = na_janela;
+}
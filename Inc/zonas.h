@@ -0,0 +1,47 @@
+#ifndef ZONAS_H
+#define ZONAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "controle.h"
+
+// =============================================================================
+// ZONAS DE IRRIGAÇÃO
+// Estado de todas as zonas como estrutura de vetores: cada grandeza fica num
+// vetor contíguo, e o passo de controle percorre todas as zonas num laço só
+// (pid_passo_vetor), com os mesmos ganhos. Cada zona tem setpoint e uma
+// janela diária em que a bomba pode ligar; fora dela, o controlador da zona
+// fica reiniciado e a saída no mínimo.
+// =============================================================================
+
+#define ZONAS_MAX 64
+
+typedef struct {
+  uint8_t quantidade;
+  uint64_t na_janela;                     // Bit por zona, do último passo
+
+  // Configuração
+  int32_t desejada[ZONAS_MAX];            // Setpoint, em décimos de porcento
+  uint16_t janela_inicio_min[ZONAS_MAX];  // Janela diária (minutos do dia);
+  uint16_t janela_fim_min[ZONAS_MAX];     // início == fim: o dia todo
+
+  // Medida e estado do controle
+  int32_t umidade[ZONAS_MAX];             // Décimos de porcento
+  int64_t integral_q16[ZONAS_MAX];
+  int32_t medida_anterior[ZONAS_MAX];
+  int32_t saida[ZONAS_MAX];
+} zonas_t;
+
+// quantidade zonas com o mesmo setpoint, janela do dia todo e saída em saida_min
+void zonas_iniciar(zonas_t *z, uint8_t quantidade, int32_t desejada, int32_t saida_min);
+
+void zonas_definir_janela(zonas_t *z, uint8_t zona, uint16_t inicio_min, uint16_t fim_min);
+
+// A janela da zona contém o minuto do dia? (janelas podem passar da meia-noite)
+bool zonas_na_janela(const zonas_t *z, uint8_t zona, uint16_t minuto_do_dia);
+
+// Um passo de controle de todas as zonas. Com ativo false (sistema desligado
+// ou modo manual), todas ficam como fora da janela.
+void zonas_controlar(zonas_t *z, const pid_config_t *config, bool ativo, uint16_t minuto_do_dia);
+
+#endif
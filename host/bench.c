@@ -0,0 +1,744 @@
+// =============================================================================
+// BENCHMARKS DO DESENHO NO SSD1306 (E DE ROTINAS QUENTES DO FIRMWARE)
+// Cada caso é repetido até somar alguns milissegundos; de várias rodadas ficam
+// o menor tempo por iteração (o mais estável, usado na comparação) e a
+// mediana. Casos com unidade "bytes" são determinísticos (tráfego I2C medido
+// no barramento simulado).
+//
+//   bench                          mede e imprime
+//   bench --gravar base.txt        mede e grava a linha de base
+//   bench --base base.txt [--limite 25]
+//                                  compara com a base e retorna 1 se algum caso
+//                                  piorou além da tolerância
+//
+// Comparação: os tempos são divididos pelo de um laço de calibração medido na
+// mesma execução, o que desconta a frequência e a carga da máquina. Cada caso
+// tem a própria tolerância (última coluna da base; sem ela, --limite), e um
+// caso acima dela é medido de novo antes de contar como regressão. Casos em
+// bytes são a trava rígida: qualquer aumento é regressão.
+//
+// Na placa (BENCH_ALVO no CMake) rodam os casos de tempo, impressos na
+// serial também em ciclos de clk_sys.
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "ssd1306.h"
+#include "ui.h"
+#include "grafico.h"
+#include "filtro.h"
+#include "telemetria.h"
+#include "zonas.h"
+#include "console.h"
+#include "desenho_pixel.h"
+#ifdef HAL_HOST
+#include "hal_host.h"
+#include "traco.h"
+#else
+#include "hardware/clocks.h"
+#endif
+#if defined(HAL_HOST) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CICLOS_TSC 1
+#endif
+
+#define RODADAS         15
+#define RODADA_MIN_NS   10000000u  // Duração mínima de cada rodada
+#define MAX_CASOS       48
+#define PASSADAS        5          // Voltas intercaladas por todos os casos
+#define CONFIRMACOES    3          // Novas medidas de um caso acima da tolerância
+
+SSD1306_DEFINE(painel, SSD1306_WIDTH, SSD1306_HEIGHT);
+
+// -----------------------------------------------------------------------------
+// CASOS
+// -----------------------------------------------------------------------------
+static uint32_t contador;   // Varia os argumentos entre iterações
+
+static void caso_fill(void) {
+  ssd1306_fill(&painel, (contador++ & 1) != 0);
+}
+
+static void caso_rect_cheio(void) {
+  ssd1306_rect(&painel, 3, 5, 117, 57, (contador++ & 1) != 0, true);
+}
+
+static void caso_rect_contorno(void) {
+  ssd1306_rect(&painel, 3, 5, 117, 57, (contador++ & 1) != 0, false);
+}
+
+static void caso_hline(void) {
+  uint8_t y = (uint8_t)(contador++ % 64);
+  ssd1306_hline(&painel, 3, 124, y, (y & 1) != 0);
+}
+
+static void caso_vline(void) {
+  uint8_t x = (uint8_t)(contador++ % 128);
+  ssd1306_vline(&painel, x, 2, 61, (x & 1) != 0);
+}
+
+// As mesmas primitivas pixel a pixel (desenho_pixel.h), para comparação
+static void caso_fill_pixel(void) {
+  pixel_fill(&painel, (contador++ & 1) != 0);
+}
+
+static void caso_rect_cheio_pixel(void) {
+  pixel_rect(&painel, 3, 5, 117, 57, (contador++ & 1) != 0, true);
+}
+
+static void caso_rect_contorno_pixel(void) {
+  pixel_rect(&painel, 3, 5, 117, 57, (contador++ & 1) != 0, false);
+}
+
+static void caso_hline_pixel(void) {
+  uint8_t y = (uint8_t)(contador++ % 64);
+  pixel_hline(&painel, 3, 124, y, (y & 1) != 0);
+}
+
+static void caso_vline_pixel(void) {
+  uint8_t x = (uint8_t)(contador++ % 128);
+  pixel_vline(&painel, x, 2, 61, (x & 1) != 0);
+}
+
+static void caso_linha(void) {
+  // Diagonais com inclinações variadas, cruzando a tela toda
+  uint8_t k = (uint8_t)(contador++ % 64);
+  ssd1306_line(&painel, 0, k, 127, 63 - k, (k & 1) != 0);
+}
+
+static void caso_texto_tela(void) {
+  // 8 linhas de 16 caracteres, alinhadas às páginas
+  static const char *linhas[2] = { "0123456789ABCDEF", "abcdefghijklmnop" };
+  const char *s = linhas[contador++ & 1];
+  for (uint8_t y = 0; y < 64; y += 8)
+    ssd1306_draw_string(&painel, s, 0, y);
+}
+
+static void caso_texto_desalinhado(void) {
+  // Mesma quantidade de texto fora da grade de páginas (y % 8 != 0)
+  static const char *linhas[2] = { "0123456789ABCDEF", "abcdefghijklmnop" };
+  const char *s = linhas[contador++ & 1];
+  for (uint8_t y = 3; y < 56; y += 8)
+    ssd1306_draw_string(&painel, s, 0, y);
+}
+
+// Tela de status igual à do firmware
+static volatile uint16_t umidade = 42, desejada = 50;
+static volatile bool manual = false;
+static ui_widget_t widgets[] = {
+  UI_NUMERO(0, 0, "Umidade: ", &umidade, "%"),
+  UI_NUMERO(0, 20, "Desejada: ", &desejada, "%"),
+  UI_ROTULO(0, 40, "Modo: "),
+  UI_ALTERNATIVA(48, 40, &manual, "Manual", "Auto"),
+  UI_MEDIDOR(0, 54, 128, 10, &umidade, &desejada, 100),
+};
+static ui_tela_t tela = UI_TELA(widgets);
+
+static void caso_quadro_completo(void) {
+  umidade = (uint16_t)(contador++ % 101);
+  ssd1306_fill(&painel, false);
+  ui_invalidar(&tela);
+  ui_atualizar(&painel, &tela);
+}
+
+static void caso_quadro_incremental(void) {
+  umidade = (uint16_t)(contador++ % 101);
+  ui_atualizar(&painel, &tela);
+}
+
+// Gráfico de tendência igual ao do firmware (128x56, faixa 0..100, setpoint
+// pontilhado) com a série cheia; a umidade oscila devagar
+static grafico_serie_t serie;
+static grafico_t grafico = GRAFICO(&serie, 0, 8, 128, 56, 0, 100);
+
+static int16_t amostra_tendencia(uint32_t i) {
+  return (int16_t)(50 + (int32_t)((i * 7u) % 61) - 30 + (int32_t)(i % 5));
+}
+
+static void preparar_grafico(void) {
+  grafico_serie_limpar(&serie);
+  for (uint32_t i = 0; i < GRAFICO_AMOSTRAS; ++i)
+    grafico_serie_adicionar(&serie, amostra_tendencia(i));
+  grafico.referencia = 50;
+}
+
+// Do zero com segmentos de reta: apaga a área e liga cada par de amostras
+static void caso_grafico_linhas(void) {
+  grafico_serie_adicionar(&serie, amostra_tendencia(contador++));
+  ssd1306_rect(&painel, 8, 0, 128, 56, false, true);
+  uint32_t primeira = serie.total - 128;
+  uint8_t anterior = 0;
+  for (uint8_t c = 0; c < 128; ++c) {
+    int16_t v = serie.amostras[(primeira + c) & (GRAFICO_AMOSTRAS - 1)];
+    uint8_t y = (uint8_t)(8 + 55 - v * 55 / 100);
+    if (c > 0)
+      ssd1306_line(&painel, c - 1, anterior, c, y, true);
+    anterior = y;
+  }
+  for (uint8_t c = 0; c < 128; c += 4)
+    ssd1306_pixel(&painel, c, 8 + 55 - 50 * 55 / 100, true);
+}
+
+// Do zero coluna a coluna
+static void caso_grafico_redesenho(void) {
+  grafico_serie_adicionar(&serie, amostra_tendencia(contador++));
+  grafico_invalidar(&grafico);
+  grafico_atualizar(&painel, &grafico);
+}
+
+// Uma amostra nova: rola e desenha só a última coluna
+static void caso_grafico_rolar(void) {
+  grafico_serie_adicionar(&serie, amostra_tendencia(contador++));
+  grafico_atualizar(&painel, &grafico);
+}
+
+static filtro_t filtro;
+static const filtro_config_t config_filtro = {
+  .calibrar = true, .mediana = 5, .media = 16, .ema_shift = 4, .histerese = 3,
+};
+
+static void caso_filtro_amostra(void) {
+  filtro_processar(&filtro, (int32_t)(2000 + (contador++ * 7919u) % 97));
+}
+
+// A mesma cadeia sobre o traço gravado (host/traco_umidade.txt): ruído,
+// zumbido e picos reais fazem a mediana errar mais desvios que a sequência
+// sintética acima. Medido por amostra (registrar_filtro_traco()) (só no host,
+// que lê o arquivo)
+#ifdef HAL_HOST
+static uint16_t traco[4096];
+static size_t traco_tamanho;
+
+static void passar_traco(void) {
+  for (size_t i = 0; i < traco_tamanho; ++i)
+    filtro_processar(&filtro, traco[i]);
+}
+#endif
+
+// Lote de telemetria parecido com o do firmware: 100 Hz com jitter, umidade
+// variando devagar e a bomba em degraus
+static registro_t lote[TELEMETRIA_LOTE];
+static uint8_t quadro[TELEMETRIA_QUADRO_MAX];
+
+static void preparar_lote(void) {
+  uint32_t instante = 5000000;
+  for (int i = 0; i < TELEMETRIA_LOTE; ++i) {
+    instante += 10000 + (uint32_t)(i * 37) % 50;
+    lote[i] = (registro_t){
+      .sequencia = 1000u + (uint32_t)i, .instante_us = instante,
+      .umidade = (int16_t)(423 + i / 4), .desejada = 500,
+      .bomba = (uint16_t)(1800 + (i / 10) * 120), .flags = TELEMETRIA_LIGADO,
+    };
+  }
+}
+
+static void caso_telemetria_lote(void) {
+  lote[0].umidade = (int16_t)(423 + (contador++ & 7));
+  telemetria_codificar(lote, TELEMETRIA_LOTE, quadro);
+}
+
+static void caso_telemetria_decodificar(void) {
+  registro_t r[TELEMETRIA_LOTE];
+  uint8_t n;
+  telemetria_decodificar(quadro, telemetria_tamanho_quadro(quadro, sizeof(quadro)), r, &n);
+}
+
+// Passo de controle de n zonas (todas ativas e na janela); o custo deve
+// crescer linearmente com n
+static zonas_t zonas;
+static const pid_config_t config_pid = {
+  .kp_q16 = 20 << 16, .ki_q16 = 22000, .kd_q16 = 0,
+  .saida_min = 0, .saida_max = 4095, .taxa_max = 409, .periodo_us = 100000,
+};
+
+static void passo_zonas(uint8_t n) {
+  zonas.quantidade = n;
+  for (uint8_t i = 0; i < n; ++i)
+    zonas.umidade[i] = 400 + (int32_t)((contador + i * 7) & 63);
+  contador++;
+  zonas_controlar(&zonas, &config_pid, true, 600);
+}
+
+#define CASO_ZONAS(n) static void caso_zonas_##n(void) { passo_zonas(n); }
+CASO_ZONAS(1)
+CASO_ZONAS(2)
+CASO_ZONAS(4)
+CASO_ZONAS(8)
+CASO_ZONAS(16)
+CASO_ZONAS(32)
+CASO_ZONAS(64)
+
+// Linha inteira pelo console (anel, separação das palavras, busca na tabela
+// e conversão dos argumentos), com uma tabela do tamanho da do firmware
+static int32_t argumento;
+static uint16_t horario;
+
+static void comando_nada(uint8_t argc, char **argv) {
+  (void)argc;
+  (void)argv;
+}
+
+static void comando_inteiros(uint8_t argc, char **argv) {
+  for (uint8_t i = 1; i < argc; ++i)
+    console_inteiro(argv[i], 0, 100, &argumento);
+}
+
+static void comando_horarios(uint8_t argc, char **argv) {
+  console_inteiro(argv[1], 1, 64, &argumento);
+  for (uint8_t i = 2; i < argc; ++i)
+    console_horario(argv[i], &horario);
+}
+
+static const console_comando_t comandos[] = {
+  CONSOLE_COMANDO("estado",     comando_nada,     0, 0, ""),
+  CONSOLE_COMANDO("sistema",    comando_nada,     1, 1, ""),
+  CONSOLE_COMANDO("modo",       comando_nada,     1, 1, ""),
+  CONSOLE_COMANDO("zona",       comando_inteiros, 1, 1, ""),
+  CONSOLE_COMANDO("desejada",   comando_inteiros, 1, 2, ""),
+  CONSOLE_COMANDO("janela",     comando_horarios, 3, 3, ""),
+  CONSOLE_COMANDO("relogio",    comando_horarios, 0, 1, ""),
+  CONSOLE_COMANDO("limiar",     comando_inteiros, 1, 1, ""),
+  CONSOLE_COMANDO("telemetria", comando_nada,     1, 1, ""),
+  CONSOLE_COMANDO("relatorio",  comando_nada,     0, 0, ""),
+};
+static console_t console = CONSOLE(comandos);
+
+static void enviar_linha(const char *linha) {
+  while (*linha)
+    console_alimentar(&console, (uint8_t)*linha++);
+  console_processar(&console, 1);
+}
+
+static void caso_console_desejada(void) {
+  enviar_linha("desejada 2 55\n");
+}
+
+static void caso_console_janela(void) {
+  enviar_linha("janela 12 06:00 08:30\n");
+}
+
+// Laço de calibração: quatro cadeias independentes de multiplicações e somas
+// gravadas num buffer do tamanho de um quadro. Como os casos, depende da vazão
+// do núcleo (e não só da latência), que cai quando outro processo divide o
+// núcleo físico; os casos de tempo são comparados com a base divididos por ele
+static volatile uint32_t semente_calibracao = 1;
+static uint32_t area_calibracao[256];
+
+static void caso_calibracao(void) {
+  uint32_t a = semente_calibracao, b = a + 1, c = a + 2, d = a + 3;
+  for (int i = 0; i < 256; i += 4) {
+    a = a * 1664525u + 1013904223u;
+    b = b * 1664525u + 1013904223u;
+    c = c * 1664525u + 1013904223u;
+    d = d * 1664525u + 1013904223u;
+    area_calibracao[i] ^= a;
+    area_calibracao[i + 1] ^= b;
+    area_calibracao[i + 2] ^= c;
+    area_calibracao[i + 3] ^= d;
+  }
+  semente_calibracao = a ^ b ^ c ^ d;
+}
+
+typedef struct {
+  const char *nome;
+  void (*executar)(void);
+} caso_t;
+
+static const caso_t casos[] = {
+  { "fill",               caso_fill },
+  { "rect_cheio",         caso_rect_cheio },
+  { "rect_contorno",      caso_rect_contorno },
+  { "hline",              caso_hline },
+  { "vline",              caso_vline },
+  { "fill_pixel",         caso_fill_pixel },
+  { "rect_cheio_pixel",   caso_rect_cheio_pixel },
+  { "rect_contorno_pixel", caso_rect_contorno_pixel },
+  { "hline_pixel",        caso_hline_pixel },
+  { "vline_pixel",        caso_vline_pixel },
+  { "linha",              caso_linha },
+  { "texto_tela",         caso_texto_tela },
+  { "texto_desalinhado",  caso_texto_desalinhado },
+  { "quadro_completo",    caso_quadro_completo },
+  { "quadro_incremental", caso_quadro_incremental },
+  { "grafico_linhas",     caso_grafico_linhas },
+  { "grafico_redesenho",  caso_grafico_redesenho },
+  { "grafico_rolar",      caso_grafico_rolar },
+  { "filtro_amostra",     caso_filtro_amostra },
+  { "telemetria_lote",    caso_telemetria_lote },
+  { "telemetria_decod",   caso_telemetria_decodificar },
+  { "zonas_1",            caso_zonas_1 },
+  { "zonas_2",            caso_zonas_2 },
+  { "zonas_4",            caso_zonas_4 },
+  { "zonas_8",            caso_zonas_8 },
+  { "zonas_16",           caso_zonas_16 },
+  { "zonas_32",           caso_zonas_32 },
+  { "zonas_64",           caso_zonas_64 },
+  { "console_desejada",   caso_console_desejada },
+  { "console_janela",     caso_console_janela },
+};
+#define QUANTIDADE_CASOS (sizeof(casos) / sizeof(casos[0]))
+
+static void preparar(void) {
+  calibracao_t calibracao;
+  calibracao_definir(&calibracao, 0, 0, 4095, 1000);
+  filtro_iniciar(&filtro, &config_filtro, &calibracao);
+  preparar_lote();
+  telemetria_codificar(lote, TELEMETRIA_LOTE, quadro);
+  preparar_grafico();
+  zonas_iniciar(&zonas, ZONAS_MAX, 500, config_pid.saida_min);
+}
+
+// -----------------------------------------------------------------------------
+// RESULTADOS
+// -----------------------------------------------------------------------------
+typedef struct {
+  char nome[32];
+  double valor;             // Menor tempo (ou a contagem exata)
+  double mediana;
+  double relativo;          // Menor tempo sobre o da calibração
+  char unidade[8];
+  void (*executar)(void);   // NULL nos casos exatos
+  double divisor;           // Iterações por chamada de executar()
+  bool ciclos;              // Medido pelo TSC em vez do relógio
+  uint32_t n;               // Chamadas por rodada
+  uint8_t rodadas;
+  double tempos[RODADAS];   // Por chamada, em cada rodada
+} resultado_t;
+
+static resultado_t resultados[MAX_CASOS];
+static int quantidade_resultados;
+
+static void registrar(const char *nome, double valor, const char *unidade) {
+  resultado_t *r = &resultados[quantidade_resultados++];
+  memset(r, 0, sizeof(*r));
+  snprintf(r->nome, sizeof(r->nome), "%s", nome);
+  snprintf(r->unidade, sizeof(r->unidade), "%s", unidade);
+  r->valor = r->mediana = valor;
+  r->divisor = 1;
+  printf("%-22s %12.1f %s\n", nome, valor, unidade);
+}
+
+// Caso de tempo: medido depois por medir_tempos()
+static void registrar_caso(const char *nome, void (*executar)(void), double divisor, bool ciclos) {
+  resultado_t *r = &resultados[quantidade_resultados++];
+  memset(r, 0, sizeof(*r));
+  snprintf(r->nome, sizeof(r->nome), "%s", nome);
+  snprintf(r->unidade, sizeof(r->unidade), "%s", ciclos ? "ciclos" : "ns");
+  r->executar = executar;
+  r->divisor = divisor;
+  r->ciclos = ciclos;
+}
+
+static int comparar_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Duração de n chamadas, em nanossegundos ou em ciclos do contador de tempo
+// do processador (TSC, que conta na frequência nominal)
+static double cronometrar(void (*executar)(void), uint32_t n, bool ciclos) {
+#ifdef CICLOS_TSC
+  if (ciclos) {
+    uint64_t inicio = __rdtsc();
+    for (uint32_t i = 0; i < n; ++i)
+      executar();
+    return (double)(__rdtsc() - inicio);
+  }
+#else
+  (void)ciclos;
+#endif
+  uint32_t inicio = hal_perf_ns();
+  for (uint32_t i = 0; i < n; ++i)
+    executar();
+  return (double)(uint32_t)(hal_perf_ns() - inicio);
+}
+
+// Mais rodadas de um caso, cada uma com chamadas que somam pelo menos
+// RODADA_MIN_NS. Cada lote parte do painel apagado e sem regiões sujas
+static void medir_rodadas(resultado_t *r, int quantidade) {
+  ssd1306_fill(&painel, false);
+  ssd1306_clear_dirty(&painel);
+  if (r->n == 0) {
+    r->n = 1;
+    while (cronometrar(r->executar, r->n, false) < RODADA_MIN_NS / 4 && r->n < (1u << 24))
+      r->n *= 2;
+    r->n *= 4;
+  }
+  for (int i = 0; i < quantidade && r->rodadas < RODADAS; ++i)
+    r->tempos[r->rodadas++] = cronometrar(r->executar, r->n, r->ciclos) / r->n / r->divisor;
+}
+
+// Menor tempo e mediana entre as rodadas já medidas
+static void resumir(resultado_t *r) {
+  double tempos[RODADAS];
+  memcpy(tempos, r->tempos, r->rodadas * sizeof(double));
+  qsort(tempos, r->rodadas, sizeof(double), comparar_double);
+  r->valor = tempos[0];
+  r->mediana = tempos[r->rodadas / 2];
+}
+
+// Os casos de tempo (e as calibrações, os primeiros: resultados[0] em ns e,
+// no x86, resultados[1] em ciclos) são medidos em PASSADAS
+// voltas intercaladas: uma rajada de carga da máquina, que dura segundos,
+// cai em poucas rodadas de cada caso, e o menor tempo escapa dela
+static void medir_tempos(void) {
+  printf("%-22s %12s %12s %-6s %10s\n", "caso", "minimo", "mediana", "", "relativo");
+  for (int p = 0; p < PASSADAS; ++p)
+    for (int i = 0; i < quantidade_resultados; ++i)
+      if (resultados[i].executar)
+        medir_rodadas(&resultados[i], RODADAS / PASSADAS);
+  for (int i = 0; i < quantidade_resultados; ++i) {
+    resultado_t *r = &resultados[i];
+    if (!r->executar)
+      continue;
+    resumir(r);
+    r->relativo = r->valor / resultados[r->ciclos].valor;
+#ifdef HAL_HOST
+    printf("%-22s %12.1f %12.1f %-6s %10.4f\n", r->nome, r->valor, r->mediana, r->unidade, r->relativo);
+#else
+    // Na placa: também em ciclos de clk_sys
+    double ghz = clock_get_hz(clk_sys) / 1e9;
+    printf("%-22s %12.1f %12.1f %-6s %10.4f %10.1f ciclos\n", r->nome, r->valor, r->mediana,
+           r->unidade, r->relativo, r->valor * ghz);
+#endif
+  }
+}
+
+static void registrar_casos(void) {
+  registrar_caso("calibracao", caso_calibracao, 1, false);
+#ifdef CICLOS_TSC
+  registrar_caso("calibracao_ciclos", caso_calibracao, 1, true);
+#endif
+  for (size_t i = 0; i < QUANTIDADE_CASOS; ++i)
+    registrar_caso(casos[i].nome, casos[i].executar, 1, false);
+}
+
+#ifdef HAL_HOST
+// Tráfego I2C de um envio das regiões sujas
+static uint32_t bytes_envio(void) {
+  hal_host_i2c_reset_stats();
+  ssd1306_send_dirty(&painel);
+  return hal_host_i2c_stats().bytes;
+}
+
+static void medir_trafego(void) {
+  hal_host_i2c_reset_stats();
+  ssd1306_config(&painel);
+  hal_host_i2c_stats_t init = hal_host_i2c_stats();
+  registrar("i2c_init", init.bytes, "bytes");
+  registrar("i2c_init_transacoes", init.transactions, "trans");
+
+  ssd1306_fill(&painel, false);
+  ssd1306_send_data(&painel);
+
+  umidade = 42;
+  ui_invalidar(&tela);
+  ui_atualizar(&painel, &tela);
+  registrar("i2c_quadro_status", bytes_envio(), "bytes");
+
+  umidade = 43;
+  ui_atualizar(&painel, &tela);
+  registrar("i2c_muda_umidade", bytes_envio(), "bytes");
+
+  ui_atualizar(&painel, &tela);
+  registrar("i2c_sem_mudanca", bytes_envio(), "bytes");
+
+  // A rolagem suja a área inteira do gráfico: o custo dela está no I2C
+  ssd1306_fill(&painel, false);
+  ssd1306_send_data(&painel);
+  preparar_grafico();
+  grafico_invalidar(&grafico);
+  grafico_atualizar(&painel, &grafico);
+  ssd1306_send_dirty(&painel);
+  grafico_serie_adicionar(&serie, amostra_tendencia(GRAFICO_AMOSTRAS));
+  grafico_atualizar(&painel, &grafico);
+  registrar("i2c_grafico_rolar", bytes_envio(), "bytes");
+}
+
+// Tempo e, no x86, ciclos por amostra da cadeia de filtros sobre o traço gravado
+static void registrar_filtro_traco(void) {
+  traco_tamanho = traco_carregar("host/traco_umidade.txt", traco, sizeof(traco) / sizeof(traco[0]));
+  if (traco_tamanho == 0) {
+    fprintf(stderr, "host/traco_umidade.txt não encontrado: filtro_traco ignorado\n");
+    return;
+  }
+  registrar_caso("filtro_traco", passar_traco, traco_tamanho, false);
+#ifdef CICLOS_TSC
+  registrar_caso("filtro_traco_ciclos", passar_traco, traco_tamanho, true);
+#endif
+}
+#endif
+
+// Tamanho de um lote completo codificado (e a vazão que ele exige a 100 Hz)
+static void medir_telemetria(void) {
+  preparar_lote();
+  size_t tamanho = telemetria_codificar(lote, TELEMETRIA_LOTE, quadro);
+  registrar("telemetria_quadro", tamanho, "bytes");
+  registrar("telemetria_100hz", tamanho * 100.0 / TELEMETRIA_LOTE, "B/s");
+}
+
+#ifdef HAL_HOST
+// -----------------------------------------------------------------------------
+// LINHA DE BASE
+// -----------------------------------------------------------------------------
+static bool temporal(const resultado_t *r) {
+  return strcmp(r->unidade, "ns") == 0 || strcmp(r->unidade, "ciclos") == 0;
+}
+
+static const resultado_t *procurar(const char *nome) {
+  for (int i = 0; i < quantidade_resultados; ++i)
+    if (strcmp(resultados[i].nome, nome) == 0)
+      return &resultados[i];
+  return NULL;
+}
+
+// Tolerância gravada para um caso de tempo: o limite pedido, alargado até o
+// dobro dele nos casos em que a dispersão medida (mediana sobre o mínimo) é
+// grande, em passos de 5%
+static double tolerancia_gravada(const resultado_t *r, double limite_pct) {
+  double dispersao = r->valor > 0 ? (r->mediana - r->valor) * 100.0 / r->valor : 0;
+  double tolerancia = 2 * dispersao;
+  if (tolerancia < limite_pct)
+    tolerancia = limite_pct;
+  if (tolerancia > 2 * limite_pct)
+    tolerancia = 2 * limite_pct;
+  return 5.0 * (int)((tolerancia + 4.999) / 5.0);
+}
+
+// Casos de tempo são gravados relativos ao laço de calibração (unidade "cal"),
+// o que torna a base pouco dependente da máquina; contagens, como medidas
+static bool gravar_base(const char *caminho, double limite_pct) {
+  FILE *f = fopen(caminho, "w");
+  if (!f)
+    return false;
+  fprintf(f, "# caso valor unidade [tolerancia_pct]\n");
+  fprintf(f, "# cal: tempo em voltas do laco de calibracao; contagens sao exatas\n");
+  for (int i = 0; i < quantidade_resultados; ++i) {
+    const resultado_t *r = &resultados[i];
+    if (r->executar == caso_calibracao)
+      fprintf(f, "# %s: %.1f %s\n", r->nome, r->valor, r->unidade);
+    else if (temporal(r))
+      fprintf(f, "%s %.4f cal %.0f\n", r->nome, r->relativo, tolerancia_gravada(r, limite_pct));
+    else
+      fprintf(f, "%s %.1f %s\n", r->nome, r->valor, r->unidade);
+  }
+  return fclose(f) == 0;
+}
+
+// Retorna quantos casos pioraram além da tolerância (-1 se a base não abrir)
+static int comparar_base(const char *caminho, double limite_pct) {
+  FILE *f = fopen(caminho, "r");
+  if (!f)
+    return -1;
+  int regressoes = 0;
+  char linha[128];
+  printf("\n%-22s %12s %12s %8s %6s\n", "caso", "base", "atual", "delta", "tol");
+  while (fgets(linha, sizeof(linha), f)) {
+    char nome[32], unidade[8];
+    double base, tolerancia = limite_pct;
+    if (linha[0] == '#' || sscanf(linha, "%31s %lf %7s %lf", nome, &base, unidade, &tolerancia) < 3)
+      continue;
+    resultado_t *r = (resultado_t *)procurar(nome);
+    if (!r) {
+      printf("%-22s %12.1f %12s   ausente\n", nome, base, "-");
+      continue;
+    }
+    bool pior;
+    double atual, delta;
+    if (strcmp(unidade, "cal") == 0 && r->executar) {
+      atual = r->relativo;
+      delta = base > 0 ? (atual - base) * 100.0 / base : 0;
+      // Acima da tolerância: mede de novo e fica com a melhor medida, para
+      // não acusar uma rajada de carga da máquina
+      for (int c = 0; c < CONFIRMACOES && delta > tolerancia; ++c) {
+        double anterior = r->valor;
+        r->rodadas = 0;
+        medir_rodadas(r, RODADAS);
+        resumir(r);
+        if (r->valor > anterior)
+          r->valor = anterior;
+        atual = r->relativo = r->valor / resultados[r->ciclos].valor;
+        delta = (atual - base) * 100.0 / base;
+      }
+      pior = delta > tolerancia;
+      printf("%-22s %12.4f %12.4f %+7.1f%% %5.0f%%%s\n", nome, base, atual, delta, tolerancia,
+             pior ? "  REGRESSAO" : "");
+    } else {
+      // Contagens exatas (na precisão gravada): qualquer aumento é regressão
+      atual = r->valor;
+      delta = base > 0 ? (atual - base) * 100.0 / base : (atual > 0 ? 100.0 : 0.0);
+      pior = atual > base + 0.05;
+      printf("%-22s %12.1f %12.1f %+7.1f%% %6s%s\n", nome, base, atual, delta, "exato",
+             pior ? "  REGRESSAO" : "");
+    }
+    regressoes += pior;
+  }
+  fclose(f);
+  return regressoes;
+}
+
+// -----------------------------------------------------------------------------
+// PRINCIPAL
+// -----------------------------------------------------------------------------
+int main(int argc, char **argv) {
+  const char *base = NULL;
+  const char *gravar = NULL;
+  double limite_pct = 25.0;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--base") == 0 && i + 1 < argc)
+      base = argv[++i];
+    else if (strcmp(argv[i], "--gravar") == 0 && i + 1 < argc)
+      gravar = argv[++i];
+    else if (strcmp(argv[i], "--limite") == 0 && i + 1 < argc)
+      limite_pct = atof(argv[++i]);
+    else {
+      fprintf(stderr, "uso: %s [--base arquivo [--limite pct]] [--gravar arquivo [--limite pct]]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  ssd1306_init(&painel, false, 0x3C, i2c1);
+  ssd1306_config(&painel);
+  preparar();
+  registrar_casos();
+  registrar_filtro_traco();
+  medir_tempos();
+  medir_trafego();
+  medir_telemetria();
+
+  if (gravar && !gravar_base(gravar, limite_pct)) {
+    fprintf(stderr, "não foi possível gravar %s\n", gravar);
+    return 2;
+  }
+  if (base) {
+    int regressoes = comparar_base(base, limite_pct);
+    if (regressoes < 0) {
+      fprintf(stderr, "não foi possível abrir %s\n", base);
+      return 2;
+    }
+    printf("%d caso(s) acima da tolerância\n", regressoes);
+    return regressoes ? 1 : 0;
+  }
+  return 0;
+}
+#else
+// -----------------------------------------------------------------------------
+// PRINCIPAL (PLACA)
+// -----------------------------------------------------------------------------
+// Sem arquivos nem barramento: só os tempos, repetidos a cada 10 s para quem
+// abrir a serial depois do boot
+int main(void) {
+  hal_stdio_init();
+  ssd1306_init(&painel, false, 0x3C, i2c1);
+  preparar();
+  for (;;) {
+    printf("\nclk_sys: %lu Hz\n", (unsigned long)clock_get_hz(clk_sys));
+    quantidade_resultados = 0;
+    registrar_casos();
+    medir_tempos();
+    medir_telemetria();
+    hal_sleep_until_us(hal_time_us() + 10000000);
+  }
+}
+#endif
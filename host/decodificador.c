@@ -0,0 +1,115 @@
+// =============================================================================
+// DECODIFICADOR DA TELEMETRIA BINÁRIA (Inc/telemetria.h)
+// Lê o fluxo da serial (ou o arquivo gravado pelo host com
+// HAL_HOST_TELEMETRIA), ressincroniza nos quadros válidos, ignora o texto
+// misturado e confere a sequência dos registros.
+//
+//   decodificador [--csv] [arquivo]     (sem arquivo: entrada padrão)
+//
+// Com --csv, os registros saem em CSV na saída padrão; o resumo vai sempre
+// para a saída de erro. Retorna 1 se houve registros perdidos ou quadros
+// corrompidos.
+// =============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telemetria.h"
+
+typedef struct {
+  uint32_t quadros;
+  uint32_t corrompidos;       // Cabeçalho válido, mas CRC ou carga errados
+  uint32_t registros;
+  uint32_t perdidos;          // Lacunas na sequência
+  uint32_t bytes_quadros;
+  uint32_t bytes_ignorados;   // Texto e lixo entre os quadros
+  bool tem_anterior;
+  registro_t primeiro, ultimo;
+} resumo_t;
+
+static void consumir_registros(resumo_t *s, const registro_t *r, uint8_t n, bool csv) {
+  for (uint8_t i = 0; i < n; ++i) {
+    if (!s->tem_anterior) {
+      s->primeiro = r[i];
+      s->tem_anterior = true;
+    } else if (r[i].sequencia != s->ultimo.sequencia + 1) {
+      s->perdidos += r[i].sequencia - s->ultimo.sequencia - 1;
+    }
+    s->ultimo = r[i];
+    s->registros++;
+    if (csv)
+      printf("%lu,%lu,%d,%u,%u,%u\n", (unsigned long)r[i].sequencia,
+             (unsigned long)r[i].instante_us, r[i].umidade, r[i].desejada, r[i].bomba,
+             r[i].flags);
+  }
+}
+
+int main(int argc, char **argv) {
+  bool csv = false;
+  const char *caminho = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--csv") == 0)
+      csv = true;
+    else if (!caminho && argv[i][0] != '-')
+      caminho = argv[i];
+    else {
+      fprintf(stderr, "uso: %s [--csv] [arquivo]\n", argv[0]);
+      return 2;
+    }
+  }
+  FILE *f = caminho ? fopen(caminho, "rb") : stdin;
+  if (!f) {
+    fprintf(stderr, "não foi possível abrir %s\n", caminho);
+    return 2;
+  }
+  if (csv)
+    printf("sequencia,instante_us,umidade_decimos,desejada_decimos,bomba,flags\n");
+
+  // Janela de leitura: sempre cabe ao menos um quadro máximo depois do início
+  static uint8_t janela[4 * TELEMETRIA_QUADRO_MAX];
+  size_t inicio = 0, fim = 0;
+  bool acabou = false;
+  resumo_t s = { 0 };
+  registro_t registros[TELEMETRIA_LOTE];
+
+  while (!acabou || inicio < fim) {
+    if (!acabou && fim - inicio < TELEMETRIA_QUADRO_MAX) {
+      memmove(janela, janela + inicio, fim - inicio);
+      fim -= inicio;
+      inicio = 0;
+      size_t lidos = fread(janela + fim, 1, sizeof(janela) - fim, f);
+      fim += lidos;
+      acabou = lidos == 0;
+      continue;
+    }
+    size_t tamanho = telemetria_tamanho_quadro(janela + inicio, fim - inicio);
+    uint8_t n;
+    if (tamanho && tamanho <= fim - inicio) {
+      if (telemetria_decodificar(janela + inicio, tamanho, registros, &n)) {
+        consumir_registros(&s, registros, n, csv);
+        s.quadros++;
+        s.bytes_quadros += tamanho;
+        inicio += tamanho;
+        continue;
+      }
+      s.corrompidos++;
+    }
+    // Não há quadro válido aqui: avança um byte e procura a próxima sincronia
+    s.bytes_ignorados++;
+    inicio++;
+  }
+  if (f != stdin)
+    fclose(f);
+
+  fprintf(stderr, "quadros: %lu (%lu corrompidos), registros: %lu, perdidos: %lu\n",
+          (unsigned long)s.quadros, (unsigned long)s.corrompidos, (unsigned long)s.registros,
+          (unsigned long)s.perdidos);
+  if (s.registros > 1) {
+    double duracao_s = (uint32_t)(s.ultimo.instante_us - s.primeiro.instante_us) / 1e6;
+    double por_registro = (double)s.bytes_quadros / s.registros;
+    fprintf(stderr, "%.2f bytes/registro (%zu sem compressão), %.1f registros/s, %.0f bytes/s; "
+            "%lu bytes de texto ignorados\n",
+            por_registro, sizeof(registro_t), duracao_s > 0 ? (s.registros - 1) / duracao_s : 0.0,
+            duracao_s > 0 ? s.bytes_quadros / duracao_s : 0.0, (unsigned long)s.bytes_ignorados);
+  }
+  return s.perdidos || s.corrompidos ? 1 : 0;
+}
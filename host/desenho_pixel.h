@@ -0,0 +1,46 @@
+#ifndef DESENHO_PIXEL_H
+#define DESENHO_PIXEL_H
+
+// =============================================================================
+// DESENHO DE REFERÊNCIA PIXEL A PIXEL
+// As primitivas de ssd1306.c na forma ingênua, um ssd1306_pixel() por ponto,
+// com o mesmo recorte à tela. Servem de oráculo para os testes das versões
+// que trabalham 32 bits por vez e de comparação nos benchmarks.
+// =============================================================================
+#include "ssd1306.h"
+
+static inline void pixel_area(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+  for (int y = y0; y <= y1 && y < ssd->height; ++y)
+    for (int x = x0; x <= x1 && x < ssd->width; ++x)
+      ssd1306_pixel(ssd, (uint8_t)x, (uint8_t)y, value);
+}
+
+static inline void pixel_fill(ssd1306_t *ssd, bool value) {
+  pixel_area(ssd, 0, ssd->width - 1, 0, ssd->height - 1, value);
+}
+
+static inline void pixel_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+  pixel_area(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y, y, value);
+}
+
+static inline void pixel_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  pixel_area(ssd, x, x, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+}
+
+static inline void pixel_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width,
+                              uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0)
+    return;
+  int right = left + width - 1;
+  int bottom = top + height - 1;
+  if (fill) {
+    pixel_area(ssd, left, right, top, bottom, value);
+    return;
+  }
+  pixel_area(ssd, left, right, top, top, value);
+  pixel_area(ssd, left, right, bottom, bottom, value);
+  pixel_area(ssd, left, left, top, bottom, value);
+  pixel_area(ssd, right, right, top, bottom, value);
+}
+
+#endif
@@ -0,0 +1,837 @@
+#define _POSIX_C_SOURCE 199309L   // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal.h"
+#include "hal_host.h"
+
+// =============================================================================
+// IMPLEMENTAÇÃO DA HAL PARA O HOST (PERIFÉRICOS SIMULADOS)
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+// PAINEL SSD1306 EMULADO
+// -----------------------------------------------------------------------------
+#define MAX_PANELS 2
+
+typedef struct {
+  bool used;
+  uint8_t address;
+  bool display_on;
+  uint8_t mem_mode;                   // 0 = horizontal, 1 = vertical, 2 = página
+  uint8_t col_start, col_end, col;
+  uint8_t page_start, page_end, page;
+  uint8_t cmd[3];                     // Comando em montagem (opcode + parâmetros)
+  uint8_t cmd_len, cmd_need;
+  uint8_t ram[HAL_HOST_PANEL_PAGES][HAL_HOST_PANEL_COLUMNS];
+} panel_t;
+
+static panel_t panels[MAX_PANELS];
+
+static panel_t *panel_for(uint8_t addr) {
+  for (int i = 0; i < MAX_PANELS; ++i)
+    if (panels[i].used && panels[i].address == addr)
+      return &panels[i];
+  for (int i = 0; i < MAX_PANELS; ++i) {
+    if (!panels[i].used) {
+      memset(&panels[i], 0, sizeof(panels[i]));
+      panels[i].used = true;
+      panels[i].address = addr;
+      panels[i].mem_mode = 2;  // Padrão do SSD1306 após o reset
+      panels[i].col_end = HAL_HOST_PANEL_COLUMNS - 1;
+      panels[i].page_end = HAL_HOST_PANEL_PAGES - 1;
+      return &panels[i];
+    }
+  }
+  return NULL;
+}
+
+// Quantidade de parâmetros que seguem cada opcode
+static uint8_t command_params(uint8_t op) {
+  switch (op) {
+    case 0x21: case 0x22:
+      return 2;
+    case 0x20: case 0x81: case 0xA8: case 0xD3: case 0xDA:
+    case 0xD5: case 0xD9: case 0xDB: case 0x8D:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+static void panel_execute(panel_t *p) {
+  uint8_t op = p->cmd[0];
+  if (op == 0x20) {
+    p->mem_mode = p->cmd[1] & 0x03;
+  } else if (op == 0x21) {
+    p->col_start = p->col = p->cmd[1] & 0x7F;
+    p->col_end = p->cmd[2] & 0x7F;
+  } else if (op == 0x22) {
+    p->page_start = p->page = p->cmd[1] & 0x07;
+    p->page_end = p->cmd[2] & 0x07;
+  } else if ((op & 0xFE) == 0xAE) {
+    p->display_on = op & 0x01;
+  } else if (op >= 0xB0 && op <= 0xB7) {
+    p->page = op & 0x07;
+  } else if (op <= 0x0F) {
+    p->col = (p->col & 0xF0) | op;
+  } else if (op >= 0x10 && op <= 0x17) {
+    p->col = (p->col & 0x0F) | ((op & 0x07) << 4);
+  }
+}
+
+static void panel_command_byte(panel_t *p, uint8_t b) {
+  if (p->cmd_len == 0) {
+    p->cmd_need = command_params(b);
+  }
+  p->cmd[p->cmd_len++] = b;
+  if (p->cmd_len > p->cmd_need) {
+    panel_execute(p);
+    p->cmd_len = 0;
+  }
+}
+
+static void panel_data_byte(panel_t *p, uint8_t b) {
+  p->ram[p->page & 0x07][p->col & 0x7F] = b;
+  if (p->mem_mode == 1) {
+    if (p->page++ >= p->page_end) {
+      p->page = p->page_start;
+      if (p->col++ >= p->col_end)
+        p->col = p->col_start;
+    }
+  } else if (p->mem_mode == 0) {
+    if (p->col++ >= p->col_end) {
+      p->col = p->col_start;
+      if (p->page++ >= p->page_end)
+        p->page = p->page_start;
+    }
+  } else {
+    p->col = (p->col + 1) & 0x7F;
+  }
+}
+
+// Decodifica uma transação: bytes de controle com Co=1 valem para um único byte;
+// com Co=0 todo o restante da transação é comando (D/C=0) ou dado (D/C=1).
+static void panel_transaction(panel_t *p, const uint8_t *src, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    uint8_t control = src[i++];
+    bool data = control & 0x40;
+    if (control & 0x80) {
+      if (i < len) {
+        if (data)
+          panel_data_byte(p, src[i]);
+        else
+          panel_command_byte(p, src[i]);
+        ++i;
+      }
+      continue;
+    }
+    for (; i < len; ++i) {
+      if (data)
+        panel_data_byte(p, src[i]);
+      else
+        panel_command_byte(p, src[i]);
+    }
+  }
+}
+
+const uint8_t *hal_host_panel_ram(uint8_t addr) {
+  panel_t *p = panel_for(addr);
+  return p ? &p->ram[0][0] : NULL;
+}
+
+bool hal_host_panel_display_on(uint8_t addr) {
+  panel_t *p = panel_for(addr);
+  return p && p->display_on;
+}
+
+void hal_host_panel_reset(void) {
+  memset(panels, 0, sizeof(panels));
+}
+
+bool hal_host_panel_write_pbm(uint8_t addr, const char *caminho) {
+  panel_t *p = panel_for(addr);
+  FILE *f = p ? fopen(caminho, "wb") : NULL;
+  if (!f)
+    return false;
+  // PBM binário (P4): linhas de pixels empacotadas com o bit mais
+  // significativo primeiro, 1 = pixel aceso (preto na imagem)
+  fprintf(f, "P4\n%d %d\n", HAL_HOST_PANEL_COLUMNS, HAL_HOST_PANEL_PAGES * 8);
+  for (int y = 0; y < HAL_HOST_PANEL_PAGES * 8; ++y) {
+    uint8_t linha[HAL_HOST_PANEL_COLUMNS / 8] = {0};
+    for (int x = 0; x < HAL_HOST_PANEL_COLUMNS; ++x)
+      if ((p->ram[y / 8][x] >> (y % 8)) & 1)
+        linha[x / 8] |= 0x80 >> (x % 8);
+    fwrite(linha, 1, sizeof(linha), f);
+  }
+  return fclose(f) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// TEMPO SIMULADO
+// -----------------------------------------------------------------------------
+static uint64_t time_now_us;
+static uint64_t run_until_us;
+static bool run_configured;
+
+// Núcleo 1 simulado: roda nos intervalos em que o núcleo 0 dorme
+static uint64_t (*core1_passo)(void);
+static uint64_t core1_proximo_us;
+static uint core1_nucleo_atual;
+
+uint hal_core_num(void) {
+  return core1_nucleo_atual;
+}
+
+uint32_t hal_perf_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint64_t hal_time_us(void) {
+  return time_now_us;
+}
+
+static bool acordar;
+static uint64_t quantum_us;
+
+// Instante t arredondado para cima até a grade do avanço rápido, sem passar
+// do fim da execução
+static uint64_t quantizar(uint64_t t) {
+  if (quantum_us == 0 || t == UINT64_MAX || t % quantum_us == 0)
+    return t;
+  uint64_t q = (t / quantum_us + 1) * quantum_us;
+  return run_configured && t <= run_until_us && q > run_until_us ? run_until_us : q;
+}
+
+// Com o quantum menor, o sono em andamento (arredondado na grade antiga) é
+// interrompido nos dois núcleos, que voltam a dormir na grade nova
+void hal_host_time_quantum(uint64_t quantum) {
+  if (quantum < quantum_us) {
+    acordar = true;
+    if (core1_proximo_us > time_now_us)
+      core1_proximo_us = time_now_us;
+  }
+  quantum_us = quantum;
+}
+
+static void (*alarme)(void);
+static uint64_t alarme_us;
+
+void hal_wake(void) {
+  acordar = true;
+}
+
+void hal_host_alarm(uint64_t instante_us, void (*tratar)(void)) {
+  alarme = tratar;
+  alarme_us = instante_us;
+}
+
+void hal_sleep_until_us(uint64_t t) {
+  // Acordado por "interrupção": retorna sem avançar o relógio
+  if (acordar) {
+    acordar = false;
+    return;
+  }
+  t = quantizar(t);
+  // Passos do núcleo 1 e o alarme, em ordem de instante, até t
+  for (;;) {
+    bool nucleo1 = core1_passo && core1_proximo_us <= t;
+    bool alarme_vence = alarme && alarme_us <= t;
+    if (nucleo1 && (!alarme_vence || core1_proximo_us <= alarme_us)) {
+      if (core1_proximo_us > time_now_us)
+        time_now_us = core1_proximo_us;
+      core1_nucleo_atual = 1;
+      core1_proximo_us = quantizar(core1_passo());
+      core1_nucleo_atual = 0;
+    } else if (alarme_vence) {
+      if (alarme_us > time_now_us)
+        time_now_us = alarme_us;
+      void (*tratar)(void) = alarme;
+      alarme = NULL;
+      tratar();
+      if (acordar) {
+        acordar = false;
+        while (hal_host_i2c_complete())
+          ;
+        return;
+      }
+    } else {
+      break;
+    }
+  }
+  if (t > time_now_us)
+    time_now_us = t;
+  // Qualquer transferência em andamento (e as que ela encadear) termina
+  // enquanto a CPU dorme
+  while (hal_host_i2c_complete())
+    ;
+}
+
+void hal_core1_launch(uint64_t (*passo)(void)) {
+  core1_passo = passo;
+  core1_proximo_us = time_now_us;
+}
+
+void hal_host_time_set_us(uint64_t t) {
+  time_now_us = t;
+}
+
+// Antecipar o fim acorda o núcleo 0, para o sono em andamento não passar dele
+void hal_host_run_for_us(uint64_t dt) {
+  if (run_configured && time_now_us + dt < run_until_us)
+    acordar = true;
+  run_until_us = time_now_us + dt;
+  run_configured = true;
+}
+
+// -----------------------------------------------------------------------------
+// SISTEMA
+// -----------------------------------------------------------------------------
+static void flash_ao_terminar(void);
+
+void hal_stdio_init(void) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+// Sem HAL_HOST_TELEMETRIA, o fluxo binário é descartado para não sujar o
+// terminal; com ela, vai para o arquivo indicado
+void hal_stdio_write(const uint8_t *dados, size_t tamanho) {
+  static FILE *arquivo;
+  static bool aberto;
+  if (!aberto) {
+    const char *caminho = getenv("HAL_HOST_TELEMETRIA");
+    arquivo = caminho ? fopen(caminho, "wb") : NULL;
+    aberto = true;
+  }
+  if (arquivo) {
+    fwrite(dados, 1, tamanho, arquivo);
+    fflush(arquivo);
+  }
+}
+
+// Entrada roteirizada: o arquivo em HAL_HOST_CONSOLE chega como por uma
+// serial de 115200 bauds (um byte a cada ~87 us simulados). Uma linha
+// "@<segundos>" não é entregue: segura as seguintes até esse instante.
+#define CONSOLE_BYTE_US 87
+#define CONSOLE_INJETADOS 256
+
+static struct {
+  char bytes[CONSOLE_INJETADOS];
+  uint32_t cabeca, cauda;
+  uint64_t chegada_us;  // Instante em que o próximo byte termina de chegar
+} injetados;
+static uint64_t console_proximo_us;
+
+bool hal_host_stdio_inject(const char *texto) {
+  size_t n = strlen(texto);
+  if (n > CONSOLE_INJETADOS - (injetados.cabeca - injetados.cauda))
+    return false;
+  if (injetados.cauda == injetados.cabeca)
+    injetados.chegada_us = time_now_us + CONSOLE_BYTE_US;
+  for (size_t i = 0; i < n; ++i)
+    injetados.bytes[injetados.cabeca++ % CONSOLE_INJETADOS] = texto[i];
+  return true;
+}
+
+int hal_stdio_read(void) {
+  static FILE *arquivo;
+  static bool aberto;
+  static bool inicio_de_linha = true;
+  // Os bytes injetados chegam um a cada CONSOLE_BYTE_US desde a injeção e
+  // esperam no FIFO, como numa UART, mesmo que o firmware leia pouco
+  if (injetados.cauda != injetados.cabeca) {
+    if (time_now_us < injetados.chegada_us)
+      return -1;
+    injetados.chegada_us += CONSOLE_BYTE_US;
+    console_proximo_us = time_now_us + CONSOLE_BYTE_US;
+    return (uint8_t)injetados.bytes[injetados.cauda++ % CONSOLE_INJETADOS];
+  }
+  uint64_t proximo_us = console_proximo_us;
+  if (time_now_us < proximo_us)
+    return -1;
+  if (!aberto) {
+    const char *caminho = getenv("HAL_HOST_CONSOLE");
+    arquivo = caminho ? fopen(caminho, "r") : NULL;
+    aberto = true;
+  }
+  if (!arquivo)
+    return -1;
+  int byte = fgetc(arquivo);
+  while (inicio_de_linha && byte == '@') {
+    char linha[32];
+    double segundos = fgets(linha, sizeof(linha), arquivo) ? atof(linha) : 0.0;
+    uint64_t instante_us = (uint64_t)(segundos * 1e6);
+    if (instante_us > time_now_us) {
+      console_proximo_us = instante_us;
+      return -1;
+    }
+    byte = fgetc(arquivo);
+  }
+  if (byte == EOF) {
+    fclose(arquivo);
+    arquivo = NULL;
+    return -1;
+  }
+  inicio_de_linha = byte == '\n';
+  console_proximo_us = time_now_us + CONSOLE_BYTE_US;
+  return byte;
+}
+
+bool hal_running(void) {
+  if (!run_configured) {
+    const char *segundos = getenv("HAL_HOST_DURACAO_S");
+    hal_host_run_for_us((uint64_t)((segundos ? atof(segundos) : 60.0) * 1e6));
+  }
+  if (time_now_us < run_until_us)
+    return true;
+  flash_ao_terminar();
+  const char *pbm = getenv("HAL_HOST_PBM");
+  if (pbm) {
+    for (int i = 0; i < MAX_PANELS; ++i)
+      if (panels[i].used && hal_host_panel_write_pbm(panels[i].address, pbm))
+        break;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// GPIO E PWM
+// -----------------------------------------------------------------------------
+static struct {
+  bool output;
+  bool pull_up;
+  bool driven;            // Entrada forçada externamente (hal_host_gpio_drive)
+  bool level;
+  uint32_t irq_edges;
+  bool pwm;
+  uint16_t pwm_wrap;
+  uint16_t pwm_level;
+} gpios[HAL_HOST_GPIOS];
+static hal_gpio_irq_cb_t gpio_irq_cb;
+static void (*pwm_observador)(uint pin, uint16_t nivel);
+
+void hal_gpio_init_output(uint pin) {
+  if (pin < HAL_HOST_GPIOS) {
+    memset(&gpios[pin], 0, sizeof(gpios[pin]));
+    gpios[pin].output = true;
+  }
+}
+
+void hal_gpio_init_input(uint pin, bool pull_up) {
+  if (pin < HAL_HOST_GPIOS) {
+    memset(&gpios[pin], 0, sizeof(gpios[pin]));
+    gpios[pin].pull_up = pull_up;
+    gpios[pin].level = pull_up;
+  }
+}
+
+void hal_gpio_put(uint pin, bool value) {
+  if (pin < HAL_HOST_GPIOS && gpios[pin].output)
+    gpios[pin].level = value;
+}
+
+bool hal_gpio_get(uint pin) {
+  return pin < HAL_HOST_GPIOS && gpios[pin].level;
+}
+
+void hal_gpio_set_irq(uint pin, uint32_t edges, hal_gpio_irq_cb_t cb) {
+  if (pin < HAL_HOST_GPIOS)
+    gpios[pin].irq_edges = edges;
+  gpio_irq_cb = cb;
+}
+
+void hal_host_gpio_drive(uint pin, bool level) {
+  if (pin >= HAL_HOST_GPIOS || gpios[pin].output)
+    return;
+  bool anterior = gpios[pin].level;
+  gpios[pin].driven = true;
+  gpios[pin].level = level;
+  uint32_t borda = level ? HAL_GPIO_EDGE_RISE : HAL_GPIO_EDGE_FALL;
+  // A "interrupção" roda na hora, como se tivesse preemptado o programa
+  if (anterior != level && (gpios[pin].irq_edges & borda) && gpio_irq_cb)
+    gpio_irq_cb(pin, borda);
+}
+
+void hal_host_gpio_release(uint pin) {
+  if (pin < HAL_HOST_GPIOS && !gpios[pin].output) {
+    hal_host_gpio_drive(pin, gpios[pin].pull_up);
+    gpios[pin].driven = false;
+  }
+}
+
+bool hal_host_gpio_level(uint pin) {
+  return hal_gpio_get(pin);
+}
+
+void hal_pwm_init(uint pin, uint16_t wrap) {
+  if (pin < HAL_HOST_GPIOS) {
+    memset(&gpios[pin], 0, sizeof(gpios[pin]));
+    gpios[pin].output = true;
+    gpios[pin].pwm = true;
+    gpios[pin].pwm_wrap = wrap;
+  }
+}
+
+void hal_pwm_set(uint pin, uint16_t level) {
+  if (pin >= HAL_HOST_GPIOS || !gpios[pin].pwm || gpios[pin].pwm_level == level)
+    return;
+  gpios[pin].pwm_level = level;
+  if (pwm_observador)
+    pwm_observador(pin, level);
+}
+
+void hal_host_pwm_observe(void (*observador)(uint pin, uint16_t nivel)) {
+  pwm_observador = observador;
+}
+
+uint32_t hal_host_pwm_duty_permil(uint pin) {
+  if (pin >= HAL_HOST_GPIOS || !gpios[pin].pwm)
+    return 0;
+  // Nível acima de wrap mantém a saída alta o período todo
+  uint32_t nivel = gpios[pin].pwm_level;
+  uint32_t periodo = (uint32_t)gpios[pin].pwm_wrap + 1;
+  return nivel >= periodo ? 1000 : nivel * 1000 / periodo;
+}
+
+void hal_host_time_advance_us(uint64_t dt) {
+  time_now_us += dt;
+}
+
+// -----------------------------------------------------------------------------
+// ADC: FONTE DE REPRODUÇÃO
+// -----------------------------------------------------------------------------
+static struct {
+  const uint16_t *amostras[HAL_HOST_ADC_INPUTS];
+  size_t quantidade[HAL_HOST_ADC_INPUTS];
+  hal_host_adc_source_t fonte[HAL_HOST_ADC_INPUTS];
+  void *contexto[HAL_HOST_ADC_INPUTS];
+  uint8_t ordem[HAL_HOST_ADC_INPUTS];   // Entradas na ordem do round-robin
+  uint8_t entradas;
+  uint32_t taxa_total_hz;
+  volatile uint16_t *anel;
+  uint32_t tamanho;
+  uint64_t inicio_us;
+  uint64_t geradas;
+  uint64_t base;        // Contagem no último ajuste de taxa
+  uint64_t base_us;     // Instante do último ajuste de taxa
+} adc;
+
+void hal_host_adc_set_replay(uint8_t entrada, const uint16_t *amostras, size_t quantidade) {
+  if (entrada < HAL_HOST_ADC_INPUTS) {
+    adc.amostras[entrada] = amostras;
+    adc.quantidade[entrada] = quantidade;
+  }
+}
+
+void hal_host_adc_set_source(uint8_t entrada, hal_host_adc_source_t fonte, void *contexto) {
+  if (entrada < HAL_HOST_ADC_INPUTS) {
+    adc.fonte[entrada] = fonte;
+    adc.contexto[entrada] = contexto;
+  }
+}
+
+void hal_adc_init(uint8_t mascara) {
+  (void)mascara;
+}
+
+static uint16_t adc_replay(uint8_t entrada, uint32_t indice) {
+  if (!adc.amostras[entrada] || adc.quantidade[entrada] == 0)
+    return HAL_HOST_ADC_REPOUSO;
+  return adc.amostras[entrada][indice % adc.quantidade[entrada]] & 0x0FFF;
+}
+
+void hal_adc_stream_start(uint8_t mascara, uint32_t taxa_hz, volatile uint16_t *anel, uint32_t tamanho) {
+  adc.entradas = 0;
+  for (uint8_t i = 0; i < HAL_HOST_ADC_INPUTS; ++i)
+    if (mascara & (1u << i))
+      adc.ordem[adc.entradas++] = i;
+  adc.taxa_total_hz = taxa_hz * adc.entradas;
+  adc.anel = anel;
+  adc.tamanho = tamanho;
+  adc.inicio_us = time_now_us;
+  adc.geradas = 0;
+  adc.base = 0;
+  adc.base_us = time_now_us;
+}
+
+uint64_t hal_adc_stream_count(void) {
+  if (!adc.anel || adc.entradas == 0)
+    return 0;
+  // Gera as conversões que o ADC teria feito até agora; se o atraso passar de
+  // uma volta, só a última volta precisa ser escrita no anel
+  uint64_t devidas = adc.base + (time_now_us - adc.base_us) * adc.taxa_total_hz / 1000000u;
+  uint64_t k = adc.geradas;
+  if (devidas - k > adc.tamanho)
+    k = devidas - adc.tamanho;
+  if (k < devidas) {
+    // Posição no round-robin e instante da conversão k, avançados a cada
+    // conversão em vez de recalculados (divisões de 64 bits)
+    uint8_t posicao = (uint8_t)(k % adc.entradas);
+    uint32_t indice = (uint32_t)(k / adc.entradas);
+    double passo_us = 1e6 / adc.taxa_total_hz;
+    double instante_us = adc.base_us + (double)(k - adc.base) * passo_us;
+    for (; k < devidas; ++k, instante_us += passo_us) {
+      uint8_t entrada = adc.ordem[posicao];
+      adc.anel[k & (adc.tamanho - 1)] =
+          adc.fonte[entrada] ? adc.fonte[entrada](entrada, (uint64_t)instante_us, adc.contexto[entrada]) & 0x0FFF
+                             : adc_replay(entrada, indice);
+      if (++posicao == adc.entradas) {
+        posicao = 0;
+        ++indice;
+      }
+    }
+  }
+  adc.geradas = devidas;
+  return devidas;
+}
+
+uint64_t hal_adc_stream_start_us(void) {
+  return adc.inicio_us;
+}
+
+void hal_adc_stream_set_rate(uint32_t taxa_hz) {
+  // Grava o que foi convertido na taxa antiga e recomeça a contagem a partir daí
+  adc.base = hal_adc_stream_count();
+  adc.base_us = time_now_us;
+  adc.taxa_total_hz = taxa_hz * adc.entradas;
+}
+
+// -----------------------------------------------------------------------------
+// I2C
+// -----------------------------------------------------------------------------
+static hal_host_i2c_stats_t i2c_stats;
+
+static struct {
+  bool busy;
+  uint8_t addr;
+  const uint8_t *src;
+  size_t len;
+  hal_i2c_done_cb_t done;
+  void *ctx;
+} i2c_async;
+
+// Endereços que não respondem (NACK), um bit por endereço de 7 bits
+static uint8_t i2c_nack[128 / 8];
+
+static hal_host_i2c_observer_t i2c_observer;
+static void *i2c_observer_ctx;
+
+struct i2c_inst {
+  uint32_t freq_hz;
+};
+i2c_inst_t hal_host_i2c0_inst, hal_host_i2c1_inst;
+
+void hal_i2c_init(i2c_inst_t *i2c, uint32_t freq_hz, uint sda, uint scl) {
+  (void)sda;
+  (void)scl;
+  i2c->freq_hz = freq_hz;
+}
+
+// Sem ACK no endereço, o controlador aborta antes do primeiro byte de dados
+static bool i2c_transfer(uint8_t addr, const uint8_t *src, size_t len) {
+  i2c_stats.transactions++;
+  if (i2c_nack[addr / 8] & (1u << (addr % 8)))
+    return false;
+  i2c_stats.bytes += len;
+  if (i2c_observer)
+    i2c_observer(addr, src, len, i2c_observer_ctx);
+  panel_t *p = panel_for(addr);
+  if (p)
+    panel_transaction(p, src, len);
+  return true;
+}
+
+int hal_i2c_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+  (void)i2c;
+  while (hal_host_i2c_complete())
+    ;
+  return i2c_transfer(addr, src, len) ? (int)len : -1;
+}
+
+bool hal_i2c_write_async(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         hal_i2c_done_cb_t done, void *ctx) {
+  (void)i2c;
+  if (len == 0 || len > HAL_I2C_ASYNC_MAX || i2c_async.busy)
+    return false;
+  i2c_async.busy = true;
+  i2c_async.addr = addr;
+  i2c_async.src = src;
+  i2c_async.len = len;
+  i2c_async.done = done;
+  i2c_async.ctx = ctx;
+  return true;
+}
+
+bool hal_i2c_busy(i2c_inst_t *i2c) {
+  (void)i2c;
+  return i2c_async.busy;
+}
+
+const uint8_t *hal_host_i2c_pending(size_t *len) {
+  if (!i2c_async.busy)
+    return NULL;
+  if (len)
+    *len = i2c_async.len;
+  return i2c_async.src;
+}
+
+bool hal_host_i2c_complete(void) {
+  if (!i2c_async.busy)
+    return false;
+  bool ok = i2c_transfer(i2c_async.addr, i2c_async.src, i2c_async.len);
+  i2c_async.busy = false;
+  if (i2c_async.done)
+    i2c_async.done(i2c_async.ctx, ok);
+  return true;
+}
+
+void hal_host_i2c_nack(uint8_t addr, bool nack) {
+  if (nack)
+    i2c_nack[addr / 8] |= (uint8_t)(1u << (addr % 8));
+  else
+    i2c_nack[addr / 8] &= (uint8_t)~(1u << (addr % 8));
+}
+
+void tight_loop_contents(void) {
+  hal_host_i2c_complete();
+}
+
+void hal_host_i2c_reset_stats(void) {
+  memset(&i2c_stats, 0, sizeof(i2c_stats));
+}
+
+hal_host_i2c_stats_t hal_host_i2c_stats(void) {
+  return i2c_stats;
+}
+
+void hal_host_i2c_observe(hal_host_i2c_observer_t observador, void *contexto) {
+  i2c_observer = observador;
+  i2c_observer_ctx = contexto;
+}
+
+uint32_t hal_host_i2c_bus_time_us(uint32_t freq_hz) {
+  // START + endereço/ACK (9) + STOP ~= 11 bits por transação
+  uint64_t bits = (uint64_t)i2c_stats.transactions * 11u + (uint64_t)i2c_stats.bytes * 9u;
+  return (uint32_t)(bits * 1000000u / freq_hz);
+}
+
+// -----------------------------------------------------------------------------
+// FLASH (ÁREA DE DADOS)
+// -----------------------------------------------------------------------------
+#define FLASH_SETORES (HAL_FLASH_AREA_SIZE / HAL_FLASH_SECTOR_SIZE)
+
+static struct {
+  bool pronta;
+  uint8_t dados[HAL_FLASH_AREA_SIZE];
+  uint32_t apagamentos[FLASH_SETORES];
+  uint32_t programacoes;
+  int64_t operacoes_ate_corte;    // < 0: sem corte agendado
+  bool sem_energia;
+} flash;
+
+// Na primeira operação: área apagada, ou a imagem salva em HAL_HOST_FLASH
+static void flash_preparar(void) {
+  if (flash.pronta)
+    return;
+  flash.pronta = true;
+  flash.operacoes_ate_corte = -1;
+  memset(flash.dados, 0xFF, sizeof(flash.dados));
+  const char *caminho = getenv("HAL_HOST_FLASH");
+  FILE *f = caminho ? fopen(caminho, "rb") : NULL;
+  if (f) {
+    if (fread(flash.dados, 1, sizeof(flash.dados), f) != sizeof(flash.dados))
+      memset(flash.dados, 0xFF, sizeof(flash.dados));
+    fclose(f);
+  }
+}
+
+// Conta a operação contra o corte agendado; retorna quantos bytes dela
+// chegam à flash (todos, metade no corte ou nenhum sem energia)
+static uint32_t flash_energia(uint32_t tamanho) {
+  if (flash.sem_energia)
+    return 0;
+  if (flash.operacoes_ate_corte == 0) {
+    flash.sem_energia = true;
+    return tamanho / 2;
+  }
+  if (flash.operacoes_ate_corte > 0)
+    flash.operacoes_ate_corte--;
+  return tamanho;
+}
+
+const uint8_t *hal_flash_read(uint32_t offset) {
+  flash_preparar();
+  return &flash.dados[offset];
+}
+
+bool hal_flash_erase(uint32_t offset) {
+  flash_preparar();
+  if (offset % HAL_FLASH_SECTOR_SIZE || offset >= HAL_FLASH_AREA_SIZE)
+    return false;
+  uint32_t n = flash_energia(HAL_FLASH_SECTOR_SIZE);
+  memset(&flash.dados[offset], 0xFF, n);
+  if (n)
+    flash.apagamentos[offset / HAL_FLASH_SECTOR_SIZE]++;
+  return n == HAL_FLASH_SECTOR_SIZE;
+}
+
+bool hal_flash_program(uint32_t offset, const uint8_t *page) {
+  flash_preparar();
+  if (offset % HAL_FLASH_PAGE_SIZE || offset >= HAL_FLASH_AREA_SIZE)
+    return false;
+  uint32_t n = flash_energia(HAL_FLASH_PAGE_SIZE);
+  for (uint32_t i = 0; i < n; ++i)
+    flash.dados[offset + i] &= page[i];   // Programar só zera bits
+  if (n)
+    flash.programacoes++;
+  return n == HAL_FLASH_PAGE_SIZE;
+}
+
+// Com HAL_HOST_FLASH, a área é salva ao fim para a próxima execução
+static void flash_ao_terminar(void) {
+  const char *caminho = getenv("HAL_HOST_FLASH");
+  if (caminho && flash.pronta)
+    hal_host_flash_save(caminho);
+}
+
+void hal_host_flash_cut_after(int64_t operacoes) {
+  flash_preparar();
+  flash.operacoes_ate_corte = operacoes;
+  flash.sem_energia = false;
+}
+
+void hal_host_flash_power_on(void) {
+  flash_preparar();
+  flash.operacoes_ate_corte = -1;
+  flash.sem_energia = false;
+}
+
+void hal_host_flash_wipe(void) {
+  flash_preparar();
+  memset(&flash, 0, sizeof(flash));
+  flash.pronta = true;
+  flash.operacoes_ate_corte = -1;
+  memset(flash.dados, 0xFF, sizeof(flash.dados));
+}
+
+uint32_t hal_host_flash_erase_count(uint32_t setor) {
+  return setor < FLASH_SETORES ? flash.apagamentos[setor] : 0;
+}
+
+uint32_t hal_host_flash_program_count(void) {
+  return flash.programacoes;
+}
+
+bool hal_host_flash_save(const char *caminho) {
+  FILE *f = fopen(caminho, "wb");
+  if (!f)
+    return false;
+  flash_preparar();
+  size_t escritos = fwrite(flash.dados, 1, sizeof(flash.dados), f);
+  return fclose(f) == 0 && escritos == sizeof(flash.dados);
+}
@@ -0,0 +1,150 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+// =============================================================================
+// FUNÇÕES EXCLUSIVAS DA HAL DO HOST
+// Dão acesso ao estado dos periféricos simulados (contadores do barramento,
+// memória do painel SSD1306 emulado, ...) para testes e benchmarks.
+// =============================================================================
+#include "hal.h"
+
+// -----------------------------------------------------------------------------
+// TEMPO SIMULADO
+// -----------------------------------------------------------------------------
+// hal_sleep_until_us() salta o relógio direto para o instante pedido, então
+// o programa roda de forma determinística e muito mais rápido que o real.
+void hal_host_time_set_us(uint64_t t);
+void hal_host_time_advance_us(uint64_t dt);
+
+// Duração da execução: hal_running() passa a retornar false depois de dt
+// microssegundos simulados a partir de agora. Sem esta chamada, a duração vem
+// da variável de ambiente HAL_HOST_DURACAO_S (padrão: 60 s). Ao terminar, se
+// HAL_HOST_PBM estiver definida, o primeiro painel é gravado nesse arquivo.
+// Os bytes de hal_stdio_write() vão para o arquivo em HAL_HOST_TELEMETRIA
+// (descartados se ela não estiver definida); a flash simulada é salva em
+// HAL_HOST_FLASH, se definida. hal_stdio_read() lê o roteiro de
+// HAL_HOST_CONSOLE, com linhas "@<segundos>" marcando quando continuar.
+void hal_host_run_for_us(uint64_t dt);
+
+// Alarme único do ambiente simulado: tratar() roda quando o relógio alcança
+// instante_us, em ordem com os passos do núcleo 1, como uma interrupção; se
+// ele acordar o núcleo 0 (hal_wake), o sono em andamento termina ali.
+// Agendar outro alarme substitui o pendente.
+void hal_host_alarm(uint64_t instante_us, void (*tratar)(void));
+
+// Avanço rápido: com quantum_us > 0, o sono de cada núcleo termina no
+// primeiro múltiplo de quantum_us a partir do instante pedido. Cada tarefa
+// roda então no máximo uma vez por quantum (o escalonador descarta as
+// liberações perdidas) e o ADC só escreve a última volta do anel, então o
+// custo por hora simulada cai na proporção do quantum. O alarme continua
+// exato. 0 (padrão) desliga; diminuir o quantum acorda os dois núcleos, para
+// o sono já arredondado não atrasar o que vem a seguir.
+void hal_host_time_quantum(uint64_t quantum_us);
+
+// Põe texto na entrada da serial, à frente do roteiro de HAL_HOST_CONSOLE: os
+// bytes chegam a 115200 bauds a partir de agora e esperam num FIFO até serem lidos;
+// false se não couber
+bool hal_host_stdio_inject(const char *texto);
+
+// -----------------------------------------------------------------------------
+// GPIO E PWM
+// -----------------------------------------------------------------------------
+#define HAL_HOST_GPIOS 30
+
+// Força o nível de uma entrada, como um botão externo; uma borda habilitada
+// chama a rotina de interrupção imediatamente. release volta ao pull-up.
+void hal_host_gpio_drive(uint pin, bool level);
+void hal_host_gpio_release(uint pin);
+bool hal_host_gpio_level(uint pin);
+
+// Ciclo de trabalho atual do PWM do pino, em milésimos
+uint32_t hal_host_pwm_duty_permil(uint pin);
+
+// Observador das saídas PWM: chamado quando o nível de um pino muda
+void hal_host_pwm_observe(void (*observador)(uint pin, uint16_t nivel));
+
+// -----------------------------------------------------------------------------
+// ADC: FONTE DE REPRODUÇÃO
+// -----------------------------------------------------------------------------
+// Cada entrada reproduz, em laço, o vetor de amostras informado (por exemplo,
+// um traço gravado da placa). As amostras são geradas sob demanda conforme o
+// relógio simulado avança, na taxa configurada em hal_adc_stream_start().
+#define HAL_HOST_ADC_INPUTS 5
+#define HAL_HOST_ADC_REPOUSO 2048   // Leitura das entradas sem vetor (meio da escala)
+
+void hal_host_adc_set_replay(uint8_t entrada, const uint16_t *amostras, size_t quantidade);
+
+// Fonte por função, no lugar do vetor: cada conversão chama fonte() com o
+// instante simulado em que ela aconteceu (fonte NULL volta ao vetor)
+typedef uint16_t (*hal_host_adc_source_t)(uint8_t entrada, uint64_t instante_us, void *contexto);
+void hal_host_adc_set_source(uint8_t entrada, hal_host_adc_source_t fonte, void *contexto);
+
+// -----------------------------------------------------------------------------
+// I2C
+// -----------------------------------------------------------------------------
+typedef struct {
+  uint32_t transactions;  // Transações (START ... STOP)
+  uint32_t bytes;         // Bytes de dados, sem contar o byte de endereço
+} hal_host_i2c_stats_t;
+
+void hal_host_i2c_reset_stats(void);
+hal_host_i2c_stats_t hal_host_i2c_stats(void);
+
+// Tempo estimado de barramento, em microssegundos, para o tráfego acumulado:
+// 9 bits por byte (dados + ACK), mais endereço, START e STOP por transação.
+uint32_t hal_host_i2c_bus_time_us(uint32_t freq_hz);
+
+// Transferência assíncrona pendente: fica retida até hal_host_i2c_complete()
+// (ou até a próxima escrita bloqueante), o que permite verificar a ordem entre
+// troca de buffers e conclusão. hal_host_i2c_pending() devolve o buffer em
+// trânsito, ou NULL se não houver transferência pendente.
+const uint8_t *hal_host_i2c_pending(size_t *len);
+bool hal_host_i2c_complete(void);
+
+// Dispositivo ausente ou travado: as transações para addr recebem NACK no
+// endereço; a escrita bloqueante retorna erro e a assíncrona termina com
+// ok = false, sem bytes de dados no barramento
+void hal_host_i2c_nack(uint8_t addr, bool nack);
+
+// Transcrição do barramento: cada transação que chega ao dispositivo (ACK no
+// endereço) é entregue ao observador com os bytes de dados, na ordem em que
+// vão para o fio, antes do painel emulado interpretá-la. NULL desliga.
+typedef void (*hal_host_i2c_observer_t)(uint8_t addr, const uint8_t *dados, size_t tamanho, void *contexto);
+void hal_host_i2c_observe(hal_host_i2c_observer_t observador, void *contexto);
+
+// -----------------------------------------------------------------------------
+// PAINEL SSD1306 EMULADO
+// Interpreta o fluxo de comandos e dados recebido em cada endereço I2C e mantém
+// a GDDRAM do painel (8 páginas x 128 colunas, organizada por página).
+// -----------------------------------------------------------------------------
+#define HAL_HOST_PANEL_PAGES    8
+#define HAL_HOST_PANEL_COLUMNS  128
+
+const uint8_t *hal_host_panel_ram(uint8_t addr);
+bool hal_host_panel_display_on(uint8_t addr);
+void hal_host_panel_reset(void);
+
+// Grava a GDDRAM do painel como imagem PBM binária (P4) de 128x64
+bool hal_host_panel_write_pbm(uint8_t addr, const char *caminho);
+
+// -----------------------------------------------------------------------------
+// FLASH SIMULADA NA RAM
+// Começa apagada, ou com a imagem do arquivo em HAL_HOST_FLASH (salva de volta
+// quando hal_running() termina), para o estado sobreviver entre execuções.
+// -----------------------------------------------------------------------------
+// Queda de energia: as próximas operacoes apagamentos/programações completam;
+// a seguinte chega só pela metade e as demais falham sem efeito até
+// hal_host_flash_power_on() (o "reboot")
+void hal_host_flash_cut_after(int64_t operacoes);
+void hal_host_flash_power_on(void);
+
+// Volta a área inteira a 0xFF e zera os contadores
+void hal_host_flash_wipe(void);
+
+// Desgaste: apagamentos por setor e total de páginas programadas
+uint32_t hal_host_flash_erase_count(uint32_t setor);
+uint32_t hal_host_flash_program_count(void);
+
+bool hal_host_flash_save(const char *caminho);
+
+#endif
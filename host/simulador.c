@@ -0,0 +1,973 @@
+// =============================================================================
+// SIMULADOR DE PONTA A PONTA
+// Roda o firmware inteiro (main renomeada para firmware_main) sobre a HAL do
+// host, em tempo simulado, dirigido por um roteiro: formas de onda no ADC,
+// botões, linhas no console, instantâneos do display e verificações das
+// saídas. Os pinos vêm da fiação do diagram.json do Wokwi: o roteiro fala em
+// "btn1" ou "joystick1:HORZ", e os LEDs do diagrama são registrados pelo
+// nome ("rgb1:R", seguindo os resistores até o GPIO).
+//
+//   simulador [--diagrama diagram.json] [--duracao 24h] [--leds leds.csv]
+//             [--serial serial.txt] [--semente n] [--passo 1m]
+//             [--quadros diretório] roteiro.txt
+//
+// Sem --diagrama, usa o diagram.json da raiz do projeto (DIRETORIO_FONTES),
+// de qualquer diretório. Os quadros com caminho relativo vão para o
+// diretório de --quadros (padrão: o atual).
+//
+// --passo liga o avanço rápido (hal_host_time_quantum): os núcleos acordam
+// no máximo uma vez por passo, cada tarefa vê o tempo decorrido desde a
+// última execução e o filtro do sensor recebe só as amostras mais recentes
+// do anel. Com 1m, um dia simulado custa poucos milissegundos; serve para
+// derivas lentas diante do passo (horas), não para a dinâmica do filtro ou
+// do PI, que roda um passo por acordar. Os comandos do roteiro continuam
+// nos instantes exatos, e o avanço fica suspenso por alguns segundos depois
+// de cada botão ou linha do console, para o antirrebote, o duplo clique e a
+// pressão longa verem os tempos reais.
+//
+// Roteiro: um comando por linha; "#" comenta. "@<tempo>" (sozinho ou antes
+// do comando) marca o instante dos comandos seguintes; tempos aceitam ms, s
+// (padrão), m, h e d. "cada <período> <comando>" repete o comando a partir
+// do instante atual.
+//
+//   adc <alvo> constante <valor> [ruido <amplitude>]
+//   adc <alvo> seno <centro> <amplitude> <período> [ruido <amplitude>]
+//   adc <alvo> rampa <de> <até> <duração> [ruido <amplitude>]
+//   aperta <alvo> [<duração>]      solta o botão depois (padrão: 100 ms)
+//   solta <alvo>
+//   console <texto>                linha na serial do firmware
+//   observa <nome> <alvo>          registra também uma saída fora do diagrama
+//   quadro <arquivo.pbm> [display] %t no nome vira o instante em segundos
+//   verifica <saída> liga|desliga
+//   verifica <saída> transicoes <máximo>
+//   fim
+//
+// Alvos: "parte:pino" do diagrama, uma parte só ("btn1", o pino dela ligado
+// a um GPIO) ou "pico:GPn" direto. Sai com 1 se alguma verificação falhar.
+// =============================================================================
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "hal_host.h"
+
+int firmware_main();
+
+#define MAX_PONTAS      256     // Pinos citados no diagrama
+#define MAX_PARTES      64
+#define MAX_EVENTOS     256
+#define MAX_SAIDAS      16
+#define NOME_MAX        32
+#define LINHA_MAX       160
+#define APERTO_PADRAO_US 100000
+#define ENTRADA_EXATA_US 2000000  // Tempo exato depois de um botão ou do console
+
+static FILE *relatorio;        // Saída do simulador (a do firmware vai para --serial)
+static const char *arquivo_roteiro;
+static const char *diretorio_quadros;
+static unsigned linha_atual;
+
+static void erro_roteiro(const char *mensagem, const char *detalhe) {
+  fprintf(stderr, "%s:%u: %s%s%s\n", arquivo_roteiro, linha_atual, mensagem,
+          detalhe ? ": " : "", detalhe ? detalhe : "");
+  exit(2);
+}
+
+// -----------------------------------------------------------------------------
+// DIAGRAMA (diagram.json)
+// Só o necessário do JSON: tipo, id e atributos das partes, e as duas pontas
+// de cada ligação. As pontas ligadas formam redes (união e busca); resistores
+// e os dois lados de cada contato de um botão contam como fio.
+// -----------------------------------------------------------------------------
+typedef struct {
+  char tipo[NOME_MAX];
+  char id[NOME_MAX];
+  uint8_t endereco_i2c;
+} parte_t;
+
+static parte_t partes[MAX_PARTES];
+static int quantidade_partes;
+static char pontas[MAX_PONTAS][NOME_MAX];
+static int rede[MAX_PONTAS];
+static int quantidade_pontas;
+static char placa[NOME_MAX] = "pico";
+
+static int raiz(int i) {
+  while (rede[i] != i)
+    i = rede[i] = rede[rede[i]];
+  return i;
+}
+
+static int ponta(const char *nome) {
+  for (int i = 0; i < quantidade_pontas; ++i)
+    if (strcmp(pontas[i], nome) == 0)
+      return i;
+  if (quantidade_pontas == MAX_PONTAS) {
+    fprintf(stderr, "diagrama: pinos demais\n");
+    exit(2);
+  }
+  snprintf(pontas[quantidade_pontas], NOME_MAX, "%s", nome);
+  rede[quantidade_pontas] = quantidade_pontas;
+  return quantidade_pontas++;
+}
+
+static void ligar(const char *a, const char *b) {
+  int ra = raiz(ponta(a)), rb = raiz(ponta(b));
+  rede[ra] = rb;
+}
+
+typedef struct {
+  const char *p;
+} json_t;
+
+static void json_espacos(json_t *j) {
+  while (*j->p == ' ' || *j->p == '\n' || *j->p == '\r' || *j->p == '\t')
+    j->p++;
+}
+
+static bool json_literal(json_t *j, char c) {
+  json_espacos(j);
+  if (*j->p != c)
+    return false;
+  j->p++;
+  return true;
+}
+
+// Texto entre aspas (escapes simples); destino pode ser NULL
+static bool json_texto(json_t *j, char *destino, size_t tamanho) {
+  if (!json_literal(j, '"'))
+    return false;
+  size_t n = 0;
+  while (*j->p && *j->p != '"') {
+    char c = *j->p++;
+    if (c == '\\' && *j->p)
+      c = *j->p++;
+    if (destino && n + 1 < tamanho)
+      destino[n++] = c;
+  }
+  if (destino)
+    destino[n] = '\0';
+  return json_literal(j, '"');
+}
+
+static bool json_pular(json_t *j) {
+  json_espacos(j);
+  if (*j->p == '"')
+    return json_texto(j, NULL, 0);
+  if (*j->p == '{' || *j->p == '[') {
+    char fecha = *j->p++ == '{' ? '}' : ']';
+    if (json_literal(j, fecha))
+      return true;
+    do {
+      if (fecha == '}' && !(json_texto(j, NULL, 0) && json_literal(j, ':')))
+        return false;
+      if (!json_pular(j))
+        return false;
+    } while (json_literal(j, ','));
+    return json_literal(j, fecha);
+  }
+  // Número, true, false ou null
+  const char *inicio = j->p;
+  while (*j->p && !strchr(",}] \n\r\t", *j->p))
+    j->p++;
+  return j->p != inicio;
+}
+
+// Percorre os membros de um objeto: membro() consome o valor de cada chave
+static bool json_objeto(json_t *j, bool (*membro)(json_t *j, const char *chave, void *contexto),
+                        void *contexto) {
+  if (!json_literal(j, '{'))
+    return false;
+  if (json_literal(j, '}'))
+    return true;
+  do {
+    char chave[NOME_MAX];
+    if (!json_texto(j, chave, sizeof(chave)) || !json_literal(j, ':') || !membro(j, chave, contexto))
+      return false;
+  } while (json_literal(j, ','));
+  return json_literal(j, '}');
+}
+
+static bool membro_atributos(json_t *j, const char *chave, void *contexto) {
+  parte_t *parte = contexto;
+  if (strcmp(chave, "i2cAddress") != 0)
+    return json_pular(j);
+  char texto[NOME_MAX];
+  if (!json_texto(j, texto, sizeof(texto)))
+    return false;
+  parte->endereco_i2c = (uint8_t)strtoul(texto, NULL, 0);
+  return true;
+}
+
+static bool membro_parte(json_t *j, const char *chave, void *contexto) {
+  parte_t *parte = contexto;
+  if (strcmp(chave, "type") == 0)
+    return json_texto(j, parte->tipo, sizeof(parte->tipo));
+  if (strcmp(chave, "id") == 0)
+    return json_texto(j, parte->id, sizeof(parte->id));
+  if (strcmp(chave, "attrs") == 0)
+    return json_objeto(j, membro_atributos, parte);
+  return json_pular(j);
+}
+
+static bool membro_diagrama(json_t *j, const char *chave, void *contexto) {
+  (void)contexto;
+  if (strcmp(chave, "parts") == 0) {
+    if (!json_literal(j, '['))
+      return false;
+    if (json_literal(j, ']'))
+      return true;
+    do {
+      parte_t parte = { 0 };
+      if (!json_objeto(j, membro_parte, &parte))
+        return false;
+      if (quantidade_partes < MAX_PARTES)
+        partes[quantidade_partes++] = parte;
+    } while (json_literal(j, ','));
+    return json_literal(j, ']');
+  }
+  if (strcmp(chave, "connections") == 0) {
+    if (!json_literal(j, '['))
+      return false;
+    if (json_literal(j, ']'))
+      return true;
+    do {
+      // [ "parte:pino", "parte:pino", cor, rota ]
+      char a[NOME_MAX], b[NOME_MAX];
+      if (!json_literal(j, '[') || !json_texto(j, a, sizeof(a)) || !json_literal(j, ',') ||
+          !json_texto(j, b, sizeof(b)))
+        return false;
+      while (json_literal(j, ','))
+        if (!json_pular(j))
+          return false;
+      if (!json_literal(j, ']'))
+        return false;
+      ligar(a, b);
+    } while (json_literal(j, ','));
+    return json_literal(j, ']');
+  }
+  return json_pular(j);
+}
+
+static void carregar_diagrama(const char *caminho) {
+  FILE *f = fopen(caminho, "rb");
+  if (!f) {
+    fprintf(stderr, "%s: não foi possível abrir\n", caminho);
+    exit(2);
+  }
+  fseek(f, 0, SEEK_END);
+  long tamanho = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *texto = malloc((size_t)tamanho + 1);
+  size_t lidos = fread(texto, 1, (size_t)tamanho, f);
+  texto[lidos] = '\0';
+  fclose(f);
+
+  json_t j = { texto };
+  if (!json_objeto(&j, membro_diagrama, NULL)) {
+    fprintf(stderr, "%s: JSON inválido perto do byte %ld\n", caminho, (long)(j.p - texto));
+    exit(2);
+  }
+  free(texto);
+
+  char a[NOME_MAX + 8], b[NOME_MAX + 8];
+  for (int i = 0; i < quantidade_partes; ++i) {
+    const parte_t *p = &partes[i];
+    if (strncmp(p->tipo, "board-pi-pico", 13) == 0)
+      snprintf(placa, sizeof(placa), "%s", p->id);
+    if (strcmp(p->tipo, "wokwi-resistor") == 0) {
+      snprintf(a, sizeof(a), "%s:1", p->id);
+      snprintf(b, sizeof(b), "%s:2", p->id);
+      ligar(a, b);
+    }
+    if (strcmp(p->tipo, "wokwi-pushbutton") == 0) {
+      for (char lado = '1'; lado <= '2'; ++lado) {
+        snprintf(a, sizeof(a), "%s:%c.l", p->id, lado);
+        snprintf(b, sizeof(b), "%s:%c.r", p->id, lado);
+        ligar(a, b);
+      }
+    }
+  }
+}
+
+// GPIO da rede da ponta; -1 se ela não chega a nenhum
+static int gpio_da_ponta(int i) {
+  size_t n = strlen(placa);
+  for (int k = 0; k < quantidade_pontas; ++k) {
+    if (raiz(k) != raiz(i) || strncmp(pontas[k], placa, n) != 0 || strncmp(pontas[k] + n, ":GP", 3) != 0)
+      continue;
+    return atoi(pontas[k] + n + 3);
+  }
+  return -1;
+}
+
+// "pico:GPn", "parte:pino" ou "parte" (o primeiro pino dela ligado a um GPIO)
+static int resolver_gpio(const char *alvo) {
+  size_t n = strlen(placa);
+  if (strncmp(alvo, placa, n) == 0 && strncmp(alvo + n, ":GP", 3) == 0)
+    return atoi(alvo + n + 3);
+  if (strchr(alvo, ':')) {
+    for (int i = 0; i < quantidade_pontas; ++i)
+      if (strcmp(pontas[i], alvo) == 0)
+        return gpio_da_ponta(i);
+    return -1;
+  }
+  size_t tamanho = strlen(alvo);
+  for (int i = 0; i < quantidade_pontas; ++i) {
+    if (strncmp(pontas[i], alvo, tamanho) != 0 || pontas[i][tamanho] != ':')
+      continue;
+    int gpio = gpio_da_ponta(i);
+    if (gpio >= 0)
+      return gpio;
+  }
+  return -1;
+}
+
+static int gpio_do_alvo(const char *alvo) {
+  int gpio = resolver_gpio(alvo);
+  if (gpio < 0 || gpio >= HAL_HOST_GPIOS)
+    erro_roteiro("alvo não ligado a um GPIO no diagrama", alvo);
+  return gpio;
+}
+
+// Entrada do ADC ligada ao alvo (GPIO 26 a 29)
+static uint8_t entrada_do_alvo(const char *alvo) {
+  int gpio = gpio_do_alvo(alvo);
+  if (gpio < 26 || gpio > 29)
+    erro_roteiro("alvo não está num pino do ADC", alvo);
+  return (uint8_t)(gpio - 26);
+}
+
+static const parte_t *display(const char *id) {
+  for (int i = 0; i < quantidade_partes; ++i)
+    if (strcmp(partes[i].tipo, "board-ssd1306") == 0 && (!id || strcmp(partes[i].id, id) == 0))
+      return &partes[i];
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// SAÍDAS REGISTRADAS
+// Os LEDs do diagrama e as saídas pedidas com "observa". Acesa = ciclo de
+// trabalho do PWM acima de zero; cada transição vai para o CSV de --leds.
+// -----------------------------------------------------------------------------
+typedef struct {
+  char nome[NOME_MAX + 8];  // "parte:pino"
+  uint8_t gpio;
+  bool acesa;
+  uint32_t transicoes;
+  uint64_t desde_us;        // Instante da última transição
+  uint64_t acesa_us;        // Tempo aceso acumulado
+  uint64_t permil_us;       // Integral do ciclo de trabalho (milésimos x us)
+  uint64_t nivel_desde_us;
+  uint32_t permil;
+} saida_t;
+
+static saida_t saidas[MAX_SAIDAS];
+static int quantidade_saidas;
+static FILE *csv;
+
+static void observar(const char *nome, int gpio) {
+  if (quantidade_saidas == MAX_SAIDAS)
+    erro_roteiro("saídas demais", nome);
+  saida_t *s = &saidas[quantidade_saidas++];
+  snprintf(s->nome, sizeof(s->nome), "%s", nome);
+  s->gpio = (uint8_t)gpio;
+}
+
+static void observar_leds_do_diagrama(void) {
+  static const char *canais[] = { "R", "G", "B" };
+  char nome[NOME_MAX + 8];
+  for (int i = 0; i < quantidade_partes; ++i) {
+    const parte_t *p = &partes[i];
+    bool rgb = strcmp(p->tipo, "wokwi-rgb-led") == 0;
+    if (!rgb && strcmp(p->tipo, "wokwi-led") != 0)
+      continue;
+    for (int c = 0; c < (rgb ? 3 : 1); ++c) {
+      snprintf(nome, sizeof(nome), "%s:%s", p->id, rgb ? canais[c] : "A");
+      int gpio = resolver_gpio(nome);
+      if (gpio >= 0 && quantidade_saidas < MAX_SAIDAS)
+        observar(nome, gpio);
+    }
+  }
+}
+
+static void acumular(saida_t *s, uint64_t agora) {
+  s->permil_us += (uint64_t)s->permil * (agora - s->nivel_desde_us);
+  s->nivel_desde_us = agora;
+  if (s->acesa)
+    s->acesa_us += agora - s->desde_us;
+  s->desde_us = agora;
+}
+
+static void pwm_mudou(uint pin, uint16_t nivel) {
+  (void)nivel;
+  uint64_t agora = hal_time_us();
+  for (int i = 0; i < quantidade_saidas; ++i) {
+    saida_t *s = &saidas[i];
+    if (s->gpio != pin)
+      continue;
+    uint32_t permil = hal_host_pwm_duty_permil(pin);
+    s->permil_us += (uint64_t)s->permil * (agora - s->nivel_desde_us);
+    s->nivel_desde_us = agora;
+    s->permil = permil;
+    if ((permil > 0) == s->acesa)
+      continue;
+    if (s->acesa)
+      s->acesa_us += agora - s->desde_us;
+    s->desde_us = agora;
+    s->acesa = permil > 0;
+    s->transicoes++;
+    if (csv)
+      fprintf(csv, "%.3f,%s,%u\n", agora / 1e6, s->nome, (unsigned)permil);
+  }
+}
+
+static saida_t *saida(const char *nome) {
+  for (int i = 0; i < quantidade_saidas; ++i)
+    if (strcmp(saidas[i].nome, nome) == 0)
+      return &saidas[i];
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// FORMAS DE ONDA DO ADC
+// Uma amostra por conversão simulada (milhões por hora simulada): o seno vem
+// de uma tabela interpolada, com a fase em ponto fixo de 64 bits (o estouro
+// da multiplicação é o próprio módulo do período), e o ruído usa
+// multiplicação em vez de divisão.
+// -----------------------------------------------------------------------------
+#define SENO_PONTOS 1024
+
+typedef enum { ONDA_CONSTANTE, ONDA_SENO, ONDA_RAMPA } onda_tipo_t;
+
+typedef struct {
+  onda_tipo_t tipo;
+  double a, b;              // Constante: a; seno: centro e amplitude; rampa: de e até
+  uint64_t periodo_us;      // Seno: período; rampa: duração
+  uint64_t passo_fase;      // Seno: 2^64 / período (fase por microssegundo)
+  double inclinacao;        // Rampa: variação por microssegundo
+  uint64_t inicio_us;
+  uint32_t ruido;           // Amplitude do ruído uniforme somado
+  uint32_t estado;          // Gerador do ruído (xorshift)
+} onda_t;
+
+static onda_t ondas[HAL_HOST_ADC_INPUTS];
+static float seno[SENO_PONTOS + 1];
+static uint32_t semente = 1;
+
+static uint32_t xorshift(uint32_t *x) {
+  *x ^= *x << 13;
+  *x ^= *x >> 17;
+  *x ^= *x << 5;
+  return *x;
+}
+
+static uint16_t amostra_onda(uint8_t entrada, uint64_t instante_us, void *contexto) {
+  (void)entrada;
+  onda_t *o = contexto;
+  uint64_t t = instante_us > o->inicio_us ? instante_us - o->inicio_us : 0;
+  double v = o->a;
+  if (o->tipo == ONDA_SENO) {
+    uint64_t fase = t * o->passo_fase;
+    uint32_t i = (uint32_t)(fase >> 54);
+    float fracao = (float)((fase >> 22) & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+    v += o->b * (seno[i] + (seno[i + 1] - seno[i]) * fracao);
+  } else if (o->tipo == ONDA_RAMPA) {
+    v = t >= o->periodo_us ? o->b : o->a + o->inclinacao * (double)t;
+  }
+  if (o->ruido)
+    v += (int32_t)(((uint64_t)xorshift(&o->estado) * (2 * o->ruido + 1)) >> 32) - (int32_t)o->ruido;
+  return v <= 0 ? 0 : v >= 4095 ? 4095 : (uint16_t)(v + 0.5);
+}
+
+// -----------------------------------------------------------------------------
+// AVANÇO RÁPIDO
+// O quantum de --passo vale enquanto o roteiro só mexe em formas de onda;
+// botões e console o suspendem até ENTRADA_EXATA_US depois do último deles.
+// -----------------------------------------------------------------------------
+static uint64_t passo_us;
+static uint64_t exato_ate_us;   // 0 = avanço rápido ativo (ou desligado)
+
+static void suspender_avanco(void) {
+  if (passo_us == 0)
+    return;
+  exato_ate_us = hal_time_us() + ENTRADA_EXATA_US;
+  hal_host_time_quantum(0);
+}
+
+static void retomar_avanco(uint64_t agora) {
+  if (exato_ate_us && agora >= exato_ate_us) {
+    exato_ate_us = 0;
+    hal_host_time_quantum(passo_us);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// ROTEIRO
+// -----------------------------------------------------------------------------
+typedef struct {
+  uint64_t instante_us;
+  uint64_t periodo_us;      // 0 = uma vez
+  unsigned linha;
+  bool feito;
+  char texto[LINHA_MAX];    // Comando e argumentos
+} evento_t;
+
+static evento_t eventos[MAX_EVENTOS];
+static int quantidade_eventos;
+static uint64_t fim_us = UINT64_MAX;
+static uint32_t falhas;
+
+// Pressões em andamento: soltas no instante marcado
+static struct {
+  uint8_t gpio;
+  uint64_t solta_us;
+} apertos[8];
+static int quantidade_apertos;
+
+// "1.5h", "250ms", "30" (segundos)
+static bool ler_tempo(const char *texto, uint64_t *us) {
+  char *fim;
+  double v = strtod(texto, &fim);
+  if (fim == texto || v < 0)
+    return false;
+  double escala = 1e6;
+  if (strcmp(fim, "ms") == 0)
+    escala = 1e3;
+  else if (strcmp(fim, "m") == 0)
+    escala = 60e6;
+  else if (strcmp(fim, "h") == 0)
+    escala = 3600e6;
+  else if (strcmp(fim, "d") == 0)
+    escala = 86400e6;
+  else if (*fim && strcmp(fim, "s") != 0)
+    return false;
+  *us = (uint64_t)(v * escala + 0.5);
+  return true;
+}
+
+static uint64_t tempo(const char *texto) {
+  uint64_t us;
+  if (!texto || !ler_tempo(texto, &us))
+    erro_roteiro("tempo inválido", texto);
+  return us;
+}
+
+static double numero(const char *texto) {
+  char *fim;
+  double v = texto ? strtod(texto, &fim) : 0;
+  if (!texto || fim == texto || *fim)
+    erro_roteiro("número inválido", texto);
+  return v;
+}
+
+// Separa as palavras de linha; retorna quantas
+static int palavras(char *linha, char **argv, int max) {
+  int argc = 0;
+  for (char *p = strtok(linha, " \t"); p && argc < max; p = strtok(NULL, " \t"))
+    argv[argc++] = p;
+  return argc;
+}
+
+static void comando_adc(int argc, char **argv, uint64_t agora) {
+  if (argc < 3)
+    erro_roteiro("uso: adc <alvo> constante|seno|rampa ...", NULL);
+  uint8_t entrada = entrada_do_alvo(argv[1]);
+  onda_t o = { .inicio_us = agora, .estado = semente * 2654435761u + entrada + 1 };
+  int usados;
+  if (strcmp(argv[2], "constante") == 0 && argc >= 4) {
+    o.tipo = ONDA_CONSTANTE;
+    o.a = numero(argv[3]);
+    usados = 4;
+  } else if (strcmp(argv[2], "seno") == 0 && argc >= 6) {
+    o.tipo = ONDA_SENO;
+    o.a = numero(argv[3]);
+    o.b = numero(argv[4]);
+    o.periodo_us = tempo(argv[5]);
+    usados = 6;
+  } else if (strcmp(argv[2], "rampa") == 0 && argc >= 6) {
+    o.tipo = ONDA_RAMPA;
+    o.a = numero(argv[3]);
+    o.b = numero(argv[4]);
+    o.periodo_us = tempo(argv[5]);
+    usados = 6;
+  } else {
+    erro_roteiro("forma de onda inválida", argv[2]);
+    return;
+  }
+  if (argc == usados + 2 && strcmp(argv[usados], "ruido") == 0)
+    o.ruido = (uint32_t)numero(argv[usados + 1]);
+  else if (argc != usados)
+    erro_roteiro("argumentos a mais", argv[usados]);
+  if (o.periodo_us == 0 && o.tipo != ONDA_CONSTANTE)
+    erro_roteiro("período/duração deve ser maior que zero", NULL);
+  if (o.tipo == ONDA_SENO) {
+    o.passo_fase = UINT64_MAX / o.periodo_us;
+    for (int i = 0; i <= SENO_PONTOS; ++i)
+      seno[i] = (float)sin(2.0 * M_PI * i / SENO_PONTOS);
+  } else if (o.tipo == ONDA_RAMPA) {
+    o.inclinacao = (o.b - o.a) / (double)o.periodo_us;
+  }
+  if (o.estado == 0)
+    o.estado = 1;
+  ondas[entrada] = o;
+  hal_host_adc_set_source(entrada, amostra_onda, &ondas[entrada]);
+}
+
+static void comando_aperta(int argc, char **argv, uint64_t agora) {
+  if (argc < 2 || argc > 3)
+    erro_roteiro("uso: aperta <alvo> [<duração>]", NULL);
+  int gpio = gpio_do_alvo(argv[1]);
+  if (quantidade_apertos == (int)(sizeof(apertos) / sizeof(apertos[0])))
+    erro_roteiro("botões apertados demais ao mesmo tempo", NULL);
+  suspender_avanco();
+  hal_host_gpio_drive((uint)gpio, false);   // Botões ligados ao GND, com pull-up
+  apertos[quantidade_apertos].gpio = (uint8_t)gpio;
+  apertos[quantidade_apertos].solta_us = agora + (argc == 3 ? tempo(argv[2]) : APERTO_PADRAO_US);
+  quantidade_apertos++;
+}
+
+static void soltar(uint8_t gpio) {
+  suspender_avanco();
+  hal_host_gpio_release(gpio);
+  for (int i = 0; i < quantidade_apertos; ++i) {
+    if (apertos[i].gpio == gpio) {
+      apertos[i] = apertos[--quantidade_apertos];
+      --i;
+    }
+  }
+}
+
+static void comando_quadro(int argc, char **argv, uint64_t agora) {
+  if (argc < 2 || argc > 3)
+    erro_roteiro("uso: quadro <arquivo.pbm> [display]", NULL);
+  const parte_t *d = display(argc == 3 ? argv[2] : NULL);
+  uint8_t endereco = d && d->endereco_i2c ? d->endereco_i2c : 0x3C;
+  char nome[LINHA_MAX + 16], caminho[PATH_MAX];
+  char *marca = strstr(argv[1], "%t");
+  if (marca)
+    snprintf(nome, sizeof(nome), "%.*s%llu%s", (int)(marca - argv[1]), argv[1],
+             (unsigned long long)(agora / 1000000u), marca + 2);
+  else
+    snprintf(nome, sizeof(nome), "%s", argv[1]);
+  if (diretorio_quadros && nome[0] != '/')
+    snprintf(caminho, sizeof(caminho), "%s/%s", diretorio_quadros, nome);
+  else
+    snprintf(caminho, sizeof(caminho), "%s", nome);
+  if (!hal_host_panel_write_pbm(endereco, caminho))
+    fprintf(relatorio, "%10.3f s  erro: não foi possível gravar %s\n", agora / 1e6, caminho);
+}
+
+static void comando_verifica(int argc, char **argv, uint64_t agora) {
+  if (argc < 3)
+    erro_roteiro("uso: verifica <saída> liga|desliga|transicoes <máximo>", NULL);
+  saida_t *s = saida(argv[1]);
+  if (!s)
+    erro_roteiro("saída não registrada", argv[1]);
+  bool ok;
+  char esperado[48];
+  if (strcmp(argv[2], "transicoes") == 0 && argc == 4) {
+    uint32_t maximo = (uint32_t)numero(argv[3]);
+    ok = s->transicoes <= maximo;
+    snprintf(esperado, sizeof(esperado), "no máximo %u transições (houve %u)", (unsigned)maximo,
+             (unsigned)s->transicoes);
+  } else if ((strcmp(argv[2], "liga") == 0 || strcmp(argv[2], "desliga") == 0) && argc == 3) {
+    bool liga = strcmp(argv[2], "liga") == 0;
+    ok = s->acesa == liga;
+    snprintf(esperado, sizeof(esperado), "%s", liga ? "acesa" : "apagada");
+  } else {
+    erro_roteiro("verificação inválida", argv[2]);
+    return;
+  }
+  if (!ok) {
+    falhas++;
+    fprintf(relatorio, "%10.3f s  FALHA (linha %u): %s deveria estar %s\n", agora / 1e6, linha_atual,
+            s->nome, esperado);
+  }
+}
+
+// Executa um comando do roteiro (já validado na leitura, exceto o que só se
+// sabe durante a execução)
+static void executar(const char *texto, uint64_t agora) {
+  char linha[LINHA_MAX];
+  snprintf(linha, sizeof(linha), "%s", texto);
+  char *argv[12];
+  int argc = palavras(linha, argv, 12);
+  if (argc == 0)
+    return;
+  if (strcmp(argv[0], "adc") == 0) {
+    comando_adc(argc, argv, agora);
+  } else if (strcmp(argv[0], "aperta") == 0) {
+    comando_aperta(argc, argv, agora);
+  } else if (strcmp(argv[0], "solta") == 0 && argc == 2) {
+    soltar((uint8_t)gpio_do_alvo(argv[1]));
+  } else if (strcmp(argv[0], "console") == 0 && argc >= 2) {
+    // O texto depois de "console", com os espaços originais
+    char linha_console[LINHA_MAX + 1];
+    const char *inicio = strstr(texto, "console") + 7;
+    while (*inicio == ' ' || *inicio == '\t')
+      inicio++;
+    snprintf(linha_console, sizeof(linha_console), "%s\n", inicio);
+    suspender_avanco();
+    if (!hal_host_stdio_inject(linha_console))
+      fprintf(relatorio, "%10.3f s  console cheio: linha descartada\n", agora / 1e6);
+  } else if (strcmp(argv[0], "observa") == 0 && argc == 3) {
+    observar(argv[1], gpio_do_alvo(argv[2]));
+  } else if (strcmp(argv[0], "quadro") == 0) {
+    comando_quadro(argc, argv, agora);
+  } else if (strcmp(argv[0], "verifica") == 0) {
+    comando_verifica(argc, argv, agora);
+  } else if (strcmp(argv[0], "fim") == 0 && argc == 1) {
+    hal_host_run_for_us(0);
+  } else {
+    erro_roteiro("comando inválido", argv[0]);
+  }
+}
+
+// Confere na leitura o que não depende da execução (alvos, tempos, formato),
+// para um erro no roteiro aparecer antes de horas simuladas
+static void validar(const char *texto) {
+  char linha[LINHA_MAX];
+  snprintf(linha, sizeof(linha), "%s", texto);
+  char *argv[12];
+  int argc = palavras(linha, argv, 12);
+  if (argc == 0)
+    return;
+  const char *c = argv[0];
+  if (strcmp(c, "adc") == 0) {
+    if (argc < 2)
+      erro_roteiro("uso: adc <alvo> ...", NULL);
+    entrada_do_alvo(argv[1]);
+  } else if (strcmp(c, "aperta") == 0 || strcmp(c, "solta") == 0) {
+    if (argc < 2)
+      erro_roteiro("falta o alvo", NULL);
+    gpio_do_alvo(argv[1]);
+    if (strcmp(c, "aperta") == 0 && argc == 3)
+      tempo(argv[2]);
+  } else if (strcmp(c, "observa") == 0) {
+    if (argc != 3)
+      erro_roteiro("uso: observa <nome> <alvo>", NULL);
+    gpio_do_alvo(argv[2]);
+  } else if (strcmp(c, "quadro") == 0 && argc == 3) {
+    if (!display(argv[2]))
+      erro_roteiro("display não está no diagrama", argv[2]);
+  } else if (strcmp(c, "console") != 0 && strcmp(c, "quadro") != 0 && strcmp(c, "verifica") != 0 &&
+             strcmp(c, "fim") != 0) {
+    erro_roteiro("comando desconhecido", c);
+  }
+}
+
+static void carregar_roteiro(const char *caminho) {
+  FILE *f = fopen(caminho, "r");
+  if (!f) {
+    fprintf(stderr, "%s: não foi possível abrir\n", caminho);
+    exit(2);
+  }
+  arquivo_roteiro = caminho;
+  char linha[LINHA_MAX];
+  uint64_t instante = 0;
+  linha_atual = 0;
+  while (fgets(linha, sizeof(linha), f)) {
+    linha_atual++;
+    char *p = linha;
+    char *comentario = strchr(p, '#');
+    if (comentario)
+      *comentario = '\0';
+    p[strcspn(p, "\r\n")] = '\0';
+    while (*p == ' ' || *p == '\t')
+      p++;
+    if (*p == '@') {
+      char *fim = p + 1 + strcspn(p + 1, " \t");
+      char separador = *fim;
+      *fim = '\0';
+      instante = tempo(p + 1);
+      p = separador ? fim + 1 : fim;
+      while (*p == ' ' || *p == '\t')
+        p++;
+    }
+    size_t n = strlen(p);
+    while (n && (p[n - 1] == ' ' || p[n - 1] == '\t'))
+      p[--n] = '\0';
+    if (!*p)
+      continue;
+
+    uint64_t periodo = 0;
+    if (strncmp(p, "cada ", 5) == 0) {
+      p += 5;
+      char *fim = p + strcspn(p, " \t");
+      if (!*fim)
+        erro_roteiro("uso: cada <período> <comando>", NULL);
+      *fim = '\0';
+      periodo = tempo(p);
+      if (periodo == 0)
+        erro_roteiro("período deve ser maior que zero", NULL);
+      p = fim + 1;
+      while (*p == ' ' || *p == '\t')
+        p++;
+    }
+    validar(p);
+    if (strcmp(p, "fim") == 0 && periodo == 0 && instante < fim_us)
+      fim_us = instante;
+    if (quantidade_eventos == MAX_EVENTOS)
+      erro_roteiro("comandos demais", NULL);
+    evento_t *e = &eventos[quantidade_eventos++];
+    e->instante_us = instante;
+    e->periodo_us = periodo;
+    e->linha = linha_atual;
+    snprintf(e->texto, sizeof(e->texto), "%s", p);
+  }
+  fclose(f);
+}
+
+// Próximo instante com algo a fazer: evento ou botão a soltar
+static uint64_t proximo_instante(void) {
+  uint64_t proximo = UINT64_MAX;
+  for (int i = 0; i < quantidade_eventos; ++i)
+    if (!eventos[i].feito && eventos[i].instante_us < proximo)
+      proximo = eventos[i].instante_us;
+  for (int i = 0; i < quantidade_apertos; ++i)
+    if (apertos[i].solta_us < proximo)
+      proximo = apertos[i].solta_us;
+  if (exato_ate_us && exato_ate_us < proximo)
+    proximo = exato_ate_us;
+  return proximo;
+}
+
+// Alarme da HAL: executa, na ordem do roteiro, o que venceu até agora
+static void alarme(void) {
+  uint64_t agora = hal_time_us();
+  retomar_avanco(agora);
+  for (int i = 0; i < quantidade_apertos; ++i) {
+    if (apertos[i].solta_us <= agora) {
+      soltar(apertos[i].gpio);
+      i = -1;   // soltar() reorganiza o vetor
+    }
+  }
+  for (int i = 0; i < quantidade_eventos; ++i) {
+    evento_t *e = &eventos[i];
+    if (e->feito || e->instante_us > agora)
+      continue;
+    linha_atual = e->linha;
+    executar(e->texto, agora);
+    if (e->periodo_us)
+      e->instante_us += e->periodo_us;
+    else
+      e->feito = true;
+  }
+  uint64_t proximo = proximo_instante();
+  if (proximo != UINT64_MAX)
+    hal_host_alarm(proximo, alarme);
+}
+
+// -----------------------------------------------------------------------------
+// FUNÇÃO PRINCIPAL
+// -----------------------------------------------------------------------------
+static void uso(void) {
+  fprintf(stderr, "uso: simulador [--diagrama diagram.json] [--duracao <tempo>] [--leds leds.csv]\n"
+                  "                 [--serial serial.txt] [--semente n] [--passo <tempo>]\n"
+                  "                 [--quadros diretório] roteiro.txt\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *diagrama = DIRETORIO_FONTES "/diagram.json";
+  const char *roteiro = NULL;
+  const char *leds = NULL;
+  const char *serial = NULL;
+  uint64_t duracao_us = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--diagrama") == 0 && i + 1 < argc)
+      diagrama = argv[++i];
+    else if (strcmp(argv[i], "--duracao") == 0 && i + 1 < argc && ler_tempo(argv[i + 1], &duracao_us))
+      ++i;
+    else if (strcmp(argv[i], "--leds") == 0 && i + 1 < argc)
+      leds = argv[++i];
+    else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc)
+      serial = argv[++i];
+    else if (strcmp(argv[i], "--passo") == 0 && i + 1 < argc && ler_tempo(argv[i + 1], &passo_us))
+      ++i;
+    else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc)
+      diretorio_quadros = argv[++i];
+    else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+      semente = (uint32_t)strtoul(argv[++i], NULL, 0);
+    else if (argv[i][0] != '-' && !roteiro)
+      roteiro = argv[i];
+    else
+      uso();
+  }
+  if (!roteiro)
+    uso();
+
+  carregar_diagrama(diagrama);
+  observar_leds_do_diagrama();
+  carregar_roteiro(roteiro);
+  if (duracao_us == 0)
+    duracao_us = fim_us;
+  if (duracao_us == UINT64_MAX) {
+    fprintf(stderr, "%s: sem \"fim\" no roteiro nem --duracao\n", roteiro);
+    return 2;
+  }
+
+  // O texto do firmware (printf) vai para --serial ou é descartado; o
+  // relatório do simulador fica com a saída padrão original
+  relatorio = fdopen(dup(STDOUT_FILENO), "w");
+  if (!relatorio || !freopen(serial ? serial : "/dev/null", "w", stdout)) {
+    fprintf(stderr, "não foi possível redirecionar a saída do firmware\n");
+    return 2;
+  }
+  if (leds) {
+    csv = fopen(leds, "w");
+    if (!csv) {
+      fprintf(stderr, "%s: não foi possível criar\n", leds);
+      return 2;
+    }
+    fprintf(csv, "instante_s,saida,permil\n");
+  }
+  fprintf(relatorio, "diagrama %s: %d partes, placa \"%s\"\n", diagrama, quantidade_partes, placa);
+  for (int i = 0; i < quantidade_saidas; ++i)
+    fprintf(relatorio, "  %-12s GPIO %u\n", saidas[i].nome, saidas[i].gpio);
+
+  // As formas de onda do instante 0 valem desde a primeira conversão; o
+  // resto do roteiro roda pelo alarme, a partir do primeiro sono do firmware
+  for (int i = 0; i < quantidade_eventos; ++i) {
+    evento_t *e = &eventos[i];
+    if (e->instante_us == 0 && e->periodo_us == 0 && strncmp(e->texto, "adc ", 4) == 0) {
+      linha_atual = e->linha;
+      executar(e->texto, 0);
+      e->feito = true;
+    }
+  }
+  hal_host_pwm_observe(pwm_mudou);
+  uint64_t proximo = proximo_instante();
+  if (proximo != UINT64_MAX)
+    hal_host_alarm(proximo, alarme);
+  hal_host_run_for_us(duracao_us);
+  hal_host_time_quantum(passo_us);
+
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  firmware_main();
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  double real_s = (double)(fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+  fflush(stdout);
+
+  uint64_t agora = hal_time_us();
+  fprintf(relatorio, "\n%.1f h simuladas em %.2f s (%.0f h/s)\n", agora / 3600e6, real_s,
+          real_s > 0 ? agora / 3600e6 / real_s : 0.0);
+  fprintf(relatorio, "saida        transicoes  acesa(%%)  ciclo medio(%%)\n");
+  for (int i = 0; i < quantidade_saidas; ++i) {
+    saida_t *s = &saidas[i];
+    acumular(s, agora);
+    fprintf(relatorio, "%-12s %10u  %8.1f  %14.1f\n", s->nome, (unsigned)s->transicoes,
+            agora ? 100.0 * s->acesa_us / agora : 0.0, agora ? s->permil_us / 10.0 / agora : 0.0);
+  }
+  fprintf(relatorio, "%u verificação(ões) com falha\n", (unsigned)falhas);
+  if (csv)
+    fclose(csv);
+  fclose(relatorio);
+  return falhas ? 1 : 0;
+}
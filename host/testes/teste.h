@@ -0,0 +1,65 @@
+#ifndef TESTE_H
+#define TESTE_H
+
+// =============================================================================
+// VERIFICAÇÕES DOS TESTES DO HOST
+// Cada teste é um executável (registrado no ctest) que roda suas verificações
+// e termina com status diferente de zero se alguma falhou. VERIFICAR não
+// interrompe o teste: todas as falhas aparecem na mesma execução.
+// =============================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned teste_falhas;
+static unsigned teste_verificacoes;
+
+#define VERIFICAR(condicao, ...)                                           \
+  do {                                                                     \
+    ++teste_verificacoes;                                                  \
+    if (!(condicao)) {                                                     \
+      ++teste_falhas;                                                      \
+      fprintf(stderr, "%s:%d: falhou: %s: ", __FILE__, __LINE__, #condicao); \
+      fprintf(stderr, __VA_ARGS__);                                        \
+      fputc('\n', stderr);                                                 \
+    }                                                                      \
+  } while (0)
+
+// Compara dois blocos de memória e mostra o primeiro byte diferente
+#define VERIFICAR_MEMORIA(a, b, tamanho, descricao)                              \
+  do {                                                                     \
+    const unsigned char *va_ = (const unsigned char *)(a);                 \
+    const unsigned char *vb_ = (const unsigned char *)(b);                 \
+    size_t i_ = 0;                                                         \
+    while (i_ < (size_t)(tamanho) && va_[i_] == vb_[i_])                   \
+      ++i_;                                                                \
+    VERIFICAR(i_ == (size_t)(tamanho), "byte %zu: %02x != %02x; %s", i_,   \
+              i_ < (size_t)(tamanho) ? va_[i_] : 0,                        \
+              i_ < (size_t)(tamanho) ? vb_[i_] : 0, (descricao));        \
+  } while (0)
+
+// Resumo e status de saída para o main do teste
+static inline int teste_resultado(const char *nome) {
+  printf("%s: %u verificações, %u falhas\n", nome, teste_verificacoes, teste_falhas);
+  return teste_falhas ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Gerador pseudoaleatório determinístico (xorshift32), para as sequências
+// aleatórias se repetirem em toda execução
+static uint32_t teste_semente = 0x2545F491u;
+
+static inline uint32_t teste_aleatorio(void) {
+  uint32_t x = teste_semente;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return teste_semente = x;
+}
+
+// Inteiro em [min, max]
+static inline uint32_t teste_entre(uint32_t min, uint32_t max) {
+  return min + teste_aleatorio() % (max - min + 1);
+}
+
+#endif
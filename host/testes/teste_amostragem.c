@@ -0,0 +1,140 @@
+// =============================================================================
+// TESTE: ANEL DO ADC COM REPRODUÇÃO DE VETORES
+// Cada entrada reproduz um vetor conhecido (hal_host_adc_set_replay); os
+// leitores de amostragem.h têm de devolver a sequência de cada entrada sem
+// trocar entradas nem pular amostras, com os instantes certos, através de
+// mudanças de taxa, pausas e leitores atrasados.
+// =============================================================================
+#include "amostragem.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define TAXA_HZ    1000
+#define AMOSTRAS   4096
+#define ENTRADAS   3
+
+static uint16_t vetor[ENTRADAS][AMOSTRAS];
+static const uint8_t canal[ENTRADAS] = { 0, 1, 4 };   // Máscara 0b10011
+
+// Valor da amostra seq da entrada i: únicos por entrada, para uma troca de
+// entradas ou um salto na sequência aparecerem na comparação
+static uint16_t esperado(int i, uint64_t seq) {
+  return (uint16_t)((i * 1365u + seq * 7u) % 4096u);
+}
+
+static uint64_t cursor[ENTRADAS];
+
+// Lê as novas de cada entrada e confere contra o vetor a partir do cursor
+static uint16_t conferir_novas(const char *etapa, uint16_t max) {
+  uint16_t lidas = 0;
+  for (int i = 0; i < ENTRADAS; ++i) {
+    uint16_t destino[AMOSTRAGEM_TAMANHO];
+    uint64_t antes = cursor[i];
+    uint16_t n = amostragem_novas(canal[i], destino, max, &cursor[i]);
+    uint64_t primeira = cursor[i] - n;
+    VERIFICAR(primeira >= antes, "%s: entrada %d voltou de %llu para %llu", etapa, i,
+              (unsigned long long)antes, (unsigned long long)primeira);
+    for (uint16_t k = 0; k < n; ++k) {
+      if (destino[k] != esperado(i, primeira + k)) {
+        VERIFICAR(false, "%s: entrada %d, amostra %llu: %u != %u", etapa, i,
+                  (unsigned long long)(primeira + k), destino[k], esperado(i, primeira + k));
+        break;
+      }
+    }
+    lidas = n;
+  }
+  return lidas;
+}
+
+static void testar_sequencia(uint64_t inicio_us) {
+  // 10 ms a 1 kHz por entrada: 10 amostras de cada
+  hal_host_time_advance_us(10000);
+  uint16_t n = conferir_novas("início", 100);
+  VERIFICAR(n == 10, "%u amostras em 10 ms", n);
+  VERIFICAR(cursor[0] == 10 && cursor[2] == 10, "cursores %llu, %llu",
+            (unsigned long long)cursor[0], (unsigned long long)cursor[2]);
+
+  // A mais recente da última entrada é a conversão 29 (3 entradas
+  // intercaladas), a 29 / 3000 s do início
+  amostra_t a;
+  VERIFICAR(amostragem_ultima(canal[2], &a), "sem amostra");
+  VERIFICAR(a.valor == esperado(2, 9), "valor %u", a.valor);
+  VERIFICAR(a.instante_us == inicio_us + 29u * 1000000u / 3000u, "instante %llu",
+            (unsigned long long)(a.instante_us - inicio_us));
+
+  // Sem tempo novo, nada novo
+  VERIFICAR(conferir_novas("sem avanço", 100) == 0, "amostras sem o tempo avançar");
+
+  // Muitas leituras pequenas seguidas, com o relógio avançando aos poucos
+  for (int passo = 0; passo < 2000; ++passo) {
+    hal_host_time_advance_us(1 + teste_aleatorio() % 700);
+    conferir_novas("passos curtos", 1000);
+  }
+}
+
+static void testar_atraso(void) {
+  // Leitor parado por 1 s: só cabem as mais recentes, sem misturar entradas
+  hal_host_time_advance_us(1000000);
+  uint64_t antes = cursor[1];
+  uint16_t n = conferir_novas("atrasado", 1000);
+  uint16_t capacidade = (AMOSTRAGEM_TAMANHO - 2) / ENTRADAS;
+  VERIFICAR(n == capacidade, "%u amostras (capacidade %u)", n, capacidade);
+  VERIFICAR(cursor[1] - antes >= 1000, "cursor avançou só %llu",
+            (unsigned long long)(cursor[1] - antes));
+
+  // Cópia e média das mais recentes
+  uint16_t ultimas[8];
+  uint64_t instante;
+  VERIFICAR(amostragem_copiar(canal[1], ultimas, 8, &instante) == 8, "cópia curta");
+  uint32_t soma = 0;
+  for (int k = 0; k < 8; ++k) {
+    VERIFICAR(ultimas[k] == esperado(1, cursor[1] - 8 + k), "cópia %d: %u", k, ultimas[k]);
+    soma += ultimas[k];
+  }
+  VERIFICAR(amostragem_media(canal[1], 8) == soma / 8, "média %u != %u",
+            amostragem_media(canal[1], 8), soma / 8);
+}
+
+static void testar_taxas(void) {
+  // Mais lento: 100 Hz por entrada, a sequência continua sem salto
+  conferir_novas("antes da troca", 1000);
+  uint64_t antes = cursor[0];
+  amostragem_definir_taxa(100);
+  uint64_t troca_us = hal_time_us();
+  hal_host_time_advance_us(100000);
+  conferir_novas("100 Hz", 1000);
+  VERIFICAR(cursor[0] - antes == 10, "%llu amostras em 100 ms a 100 Hz",
+            (unsigned long long)(cursor[0] - antes));
+  amostra_t a;
+  VERIFICAR(amostragem_ultima(canal[0], &a), "sem amostra");
+  VERIFICAR(a.instante_us >= troca_us && a.instante_us <= troca_us + 100000, "instante %llu fora de [%llu, +100 ms]",
+            (unsigned long long)a.instante_us, (unsigned long long)troca_us);
+
+  // Pausa: nada novo, e os cursores seguem válidos na volta
+  amostragem_definir_taxa(0);
+  hal_host_time_advance_us(500000);
+  VERIFICAR(conferir_novas("pausado", 1000) == 0, "amostras com o ADC pausado");
+  amostragem_definir_taxa(TAXA_HZ);
+  for (int passo = 0; passo < 500; ++passo) {
+    hal_host_time_advance_us(1 + teste_aleatorio() % 3000);
+    conferir_novas("depois da pausa", 1000);
+  }
+}
+
+int main(void) {
+  for (int i = 0; i < ENTRADAS; ++i) {
+    for (int k = 0; k < AMOSTRAS; ++k)
+      vetor[i][k] = esperado(i, (uint64_t)k);
+    hal_host_adc_set_replay(canal[i], vetor[i], AMOSTRAS);
+  }
+  hal_host_time_set_us(123456);
+  hal_adc_init(0b10011);
+  amostragem_iniciar(0b10011, TAXA_HZ);
+  VERIFICAR(hal_adc_stream_start_us() == 123456, "início %llu",
+            (unsigned long long)hal_adc_stream_start_us());
+
+  testar_sequencia(123456);
+  testar_atraso();
+  testar_taxas();
+  return teste_resultado("teste_amostragem");
+}
@@ -0,0 +1,200 @@
+// =============================================================================
+// TESTE: ARMAZENAMENTO NA FLASH COM QUEDAS DE ENERGIA
+// Uma carga fixa (chaves confirmadas e páginas de amostras, dando a volta nos
+// dois anéis) é repetida com a energia cortada em cada uma das operações de
+// flash, inclusive no meio dela. Depois do "reboot", a partida tem de
+// devolver o valor da última confirmação que retornou true (ou, inteiro, o da
+// confirmação interrompida, se a metade gravada da página já o continha) e
+// todas as amostras gravadas ainda no anel, e a gravação seguinte tem de
+// funcionar. O
+// desgaste (apagamentos por setor) tem de ficar igual entre os setores de
+// cada anel, com e sem reinícios no meio.
+// =============================================================================
+#include "armazenamento.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define ITERACOES        260   // Dá a volta no anel de chaves 4 vezes e no de amostras 1 vez
+#define CHAVES_USADAS    5
+#define PAGINAS_SETOR    (HAL_FLASH_SECTOR_SIZE / HAL_FLASH_PAGE_SIZE)
+#define SETORES          (HAL_FLASH_AREA_SIZE / HAL_FLASH_SECTOR_SIZE)
+
+static armazenamento_t arm;
+
+// Estado confirmado: o que a partida tem de reconstruir
+typedef struct {
+  bool presente[ARMAZENAMENTO_CHAVES];
+  uint32_t valor[ARMAZENAMENTO_CHAVES];
+  uint32_t amostras;          // Amostras em páginas gravadas com sucesso
+  bool falhou;
+  // Gravação interrompida: pode ter chegado inteira à flash, ou nada dela
+  int chave_em_voo;           // -1: nenhuma
+  uint32_t valor_em_voo;
+  bool amostras_em_voo;
+} confirmado_t;
+
+#define CONFIRMADO_VAZIO { .chave_em_voo = -1 }
+
+static uint32_t operacoes_flash(void) {
+  uint32_t total = hal_host_flash_program_count();
+  for (uint32_t s = 0; s < SETORES; ++s)
+    total += hal_host_flash_erase_count(s);
+  return total;
+}
+
+// A carga: em cada iteração, uma chave muda e é confirmada, e uma página de
+// amostras é completada. Para na primeira operação que falhar
+static void carga(confirmado_t *c, int iteracoes) {
+  for (int i = 0; i < iteracoes && !c->falhou; ++i) {
+    uint8_t chave = (uint8_t)(i % CHAVES_USADAS);
+    uint32_t valor = 1000u + (uint32_t)i;
+    armazenamento_escrever(&arm, chave, &valor, sizeof(valor));
+    if (!armazenamento_confirmar(&arm)) {
+      c->falhou = true;
+      c->chave_em_voo = chave;
+      c->valor_em_voo = valor;
+      break;
+    }
+    c->presente[chave] = true;
+    c->valor[chave] = valor;
+    for (int k = 0; k < ARMAZENAMENTO_AMOSTRAS_PAGINA; ++k) {
+      amostra_log_t amostra = { .instante_s = c->amostras + (uint32_t)k + 1, .umidade = (int16_t)i };
+      bool ok = armazenamento_registrar(&arm, &amostra);
+      if (k == ARMAZENAMENTO_AMOSTRAS_PAGINA - 1) {
+        if (!ok) {
+          c->falhou = true;
+          c->amostras_em_voo = true;
+          break;
+        }
+        c->amostras += ARMAZENAMENTO_AMOSTRAS_PAGINA;
+      }
+    }
+  }
+}
+
+typedef struct {
+  uint32_t quantidade;
+  uint32_t ultima;
+  bool em_ordem;
+} percurso_t;
+
+static void contar_amostra(const amostra_log_t *amostra, void *contexto) {
+  percurso_t *p = contexto;
+  if (p->quantidade && amostra->instante_s != p->ultima + 1)
+    p->em_ordem = false;
+  p->ultima = amostra->instante_s;
+  p->quantidade++;
+}
+
+// Confere a partida contra o estado confirmado e adota o resultado da
+// gravação interrompida, se ela chegou à flash
+static bool conferir(confirmado_t *c, const char *etapa, int corte) {
+  bool certo = true;
+  for (uint8_t chave = 0; chave < CHAVES_USADAS; ++chave) {
+    uint32_t lido = 0;
+    bool presente = armazenamento_ler(&arm, chave, &lido, sizeof(lido));
+    bool confirmado = presente == c->presente[chave] && (!presente || lido == c->valor[chave]);
+    bool em_voo = presente && chave == c->chave_em_voo && lido == c->valor_em_voo;
+    if (!confirmado && !em_voo) {
+      VERIFICAR(false, "%s, corte na operação %d: chave %u = %lu (%s), esperado %lu (%s)", etapa,
+                corte, chave, (unsigned long)lido, presente ? "presente" : "ausente",
+                (unsigned long)c->valor[chave], c->presente[chave] ? "presente" : "ausente");
+      certo = false;
+    }
+    c->presente[chave] = presente;
+    c->valor[chave] = lido;
+  }
+  // Amostras: contíguas, terminando na última gravada, e pelo menos as que
+  // cabem no anel menos o setor que é apagado à frente
+  percurso_t p = { .em_ordem = true };
+  armazenamento_percorrer(&arm, contar_amostra, &p);
+  uint32_t capacidade = (ARMAZENAMENTO_SETORES_LOG - 1) * PAGINAS_SETOR * ARMAZENAMENTO_AMOSTRAS_PAGINA;
+  uint32_t minimo = c->amostras < capacidade ? c->amostras : capacidade;
+  bool ultima = p.ultima == c->amostras ||
+                (c->amostras_em_voo && p.ultima == c->amostras + ARMAZENAMENTO_AMOSTRAS_PAGINA);
+  if (!p.em_ordem || !ultima || p.quantidade < minimo) {
+    VERIFICAR(false, "%s, corte na operação %d: %lu amostras até %lu (em ordem: %d), esperado >= %lu até %lu",
+              etapa, corte, (unsigned long)p.quantidade, (unsigned long)p.ultima, p.em_ordem,
+              (unsigned long)minimo, (unsigned long)c->amostras);
+    certo = false;
+  }
+  c->amostras = p.ultima;
+  c->chave_em_voo = -1;
+  c->amostras_em_voo = false;
+  c->falhou = false;
+  return certo;
+}
+
+static void testar_quedas(void) {
+  // Sem corte: quantas operações a carga faz
+  hal_host_flash_wipe();
+  armazenamento_iniciar(&arm);
+  confirmado_t completo = CONFIRMADO_VAZIO;
+  carga(&completo, ITERACOES);
+  VERIFICAR(!completo.falhou, "carga sem corte falhou");
+  int total = (int)operacoes_flash();
+  VERIFICAR(total > 2 * ITERACOES, "só %d operações de flash", total);
+
+  int falhas = 0;
+  for (int corte = 0; corte <= total && falhas < 5; ++corte) {
+    hal_host_flash_wipe();
+    hal_host_flash_cut_after(corte);
+    armazenamento_iniciar(&arm);
+    confirmado_t c = CONFIRMADO_VAZIO;
+    carga(&c, ITERACOES);
+
+    hal_host_flash_power_on();
+    armazenamento_iniciar(&arm);
+    if (!conferir(&c, "depois do corte", corte)) {
+      ++falhas;
+      continue;
+    }
+    // A vida continua: mais uma volta da carga grava por cima da página
+    // interrompida e sobrevive a outro reinício
+    carga(&c, 20);
+    VERIFICAR(!c.falhou, "corte na operação %d: gravação depois do reinício falhou", corte);
+    armazenamento_iniciar(&arm);
+    falhas += !conferir(&c, "depois da recuperação", corte);
+  }
+  teste_verificacoes += (unsigned)total;
+}
+
+// Apagamentos por setor de [primeiro, primeiro + setores): diferença máxima
+static uint32_t espalhamento(uint32_t primeiro, uint32_t setores, uint32_t *minimo) {
+  uint32_t menor = UINT32_MAX, maior = 0;
+  for (uint32_t s = primeiro; s < primeiro + setores; ++s) {
+    uint32_t n = hal_host_flash_erase_count(s);
+    menor = n < menor ? n : menor;
+    maior = n > maior ? n : maior;
+  }
+  *minimo = menor;
+  return maior - menor;
+}
+
+static void testar_desgaste(bool reiniciar) {
+  hal_host_flash_wipe();
+  armazenamento_iniciar(&arm);
+  confirmado_t c = CONFIRMADO_VAZIO;
+  // 10 voltas no anel de chaves e 2 no de amostras
+  for (int i = 0; i < 10 * ARMAZENAMENTO_SETORES_KV * PAGINAS_SETOR; i += 37) {
+    carga(&c, 37);
+    if (reiniciar)
+      armazenamento_iniciar(&arm);
+  }
+  VERIFICAR(!c.falhou, "carga falhou");
+  uint32_t minimo;
+  uint32_t kv = espalhamento(0, ARMAZENAMENTO_SETORES_KV, &minimo);
+  VERIFICAR(kv <= 1 && minimo >= 9, "chaves (%s): apagamentos de %lu a %lu por setor",
+            reiniciar ? "com reinícios" : "direto", (unsigned long)minimo, (unsigned long)(minimo + kv));
+  uint32_t log = espalhamento(ARMAZENAMENTO_SETORES_KV, ARMAZENAMENTO_SETORES_LOG, &minimo);
+  VERIFICAR(log <= 1 && minimo >= 2, "amostras (%s): apagamentos de %lu a %lu por setor",
+            reiniciar ? "com reinícios" : "direto", (unsigned long)minimo, (unsigned long)(minimo + log));
+  VERIFICAR(conferir(&c, reiniciar ? "desgaste com reinícios" : "desgaste", -1), "estado final");
+}
+
+int main(void) {
+  testar_quedas();
+  testar_desgaste(false);
+  testar_desgaste(true);
+  return teste_resultado("teste_armazenamento");
+}
@@ -0,0 +1,189 @@
+// =============================================================================
+// TESTE: ANTIRREBOTE E GESTOS DOS BOTÕES
+// Padrões de repique gravados são repetidos com botoes_registrar_em, incluindo
+// eventos em que descida e subida chegaram juntas e só o nível lido diz onde
+// o pino parou. O caminho da interrupção (botoes_registrar lendo o pino) é
+// exercitado pelo GPIO simulado.
+// =============================================================================
+#include "botoes.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define PINO          5
+#define ANTIRREBOTE   20000
+#define LONGO         1000000
+#define MAX_GESTOS    16
+
+static botao_gesto_t gestos[MAX_GESTOS];
+static int total_gestos;
+
+static void tratar(uint8_t gpio, botao_gesto_t gesto) {
+  VERIFICAR(gpio == PINO, "gesto do pino %u", gpio);
+  if (total_gestos < MAX_GESTOS)
+    gestos[total_gestos] = gesto;
+  ++total_gestos;
+}
+
+static const char *nome_gesto(botao_gesto_t g) {
+  static const char *nomes[] = { "PRESSIONADO", "SOLTO", "CLIQUE", "DUPLO_CLIQUE", "LONGO" };
+  return nomes[g];
+}
+
+// Confere os gestos emitidos desde a última chamada
+static void conferir(const char *caso, const botao_gesto_t *esperados, int quantidade) {
+  bool igual = total_gestos == quantidade;
+  for (int i = 0; igual && i < quantidade; ++i)
+    igual = gestos[i] == esperados[i];
+  VERIFICAR(igual, "%s: %d gestos, esperados %d", caso, total_gestos, quantidade);
+  if (!igual)
+    for (int i = 0; i < total_gestos && i < MAX_GESTOS; ++i)
+      printf("  [%d] %s\n", i, nome_gesto(gestos[i]));
+  total_gestos = 0;
+}
+
+#define CONFERIR(caso, ...) do { \
+    const botao_gesto_t esperados_[] = { __VA_ARGS__ }; \
+    conferir(caso, esperados_, (int)(sizeof(esperados_) / sizeof(esperados_[0]))); \
+  } while (0)
+#define CONFERIR_NADA(caso) conferir(caso, NULL, 0)
+
+// Evento: nível lido pela interrupção e deslocamento em microssegundos
+typedef struct { bool apertado; uint32_t dt_us; } evento_t;
+
+static uint64_t agora;
+
+// Repete um padrão gravado, processando entre os eventos como a tarefa faria
+static void repetir(botoes_t *b, const evento_t *eventos, int quantidade) {
+  for (int i = 0; i < quantidade; ++i) {
+    agora += eventos[i].dt_us;
+    botoes_registrar_em(PINO, eventos[i].apertado, agora);
+    botoes_processar(b, agora);
+  }
+}
+
+static void esperar(botoes_t *b, uint32_t dt_us) {
+  // Processa a cada 10 ms, como o período da tarefa
+  for (uint32_t t = 0; t < dt_us; t += 10000) {
+    agora += dt_us - t < 10000 ? dt_us - t : 10000;
+    botoes_processar(b, agora);
+  }
+}
+
+static void testar_repiques(void) {
+  botao_t lista[] = { BOTAO(PINO, 0) };
+  botoes_t b = BOTOES(lista, tratar, ANTIRREBOTE, LONGO);
+  agora = 1000000;
+
+  // Aperto limpo e soltura limpa
+  repetir(&b, (evento_t[]){ { true, 0 } }, 1);
+  esperar(&b, 100000);
+  CONFERIR("aperto limpo", BOTAO_PRESSIONADO);
+  repetir(&b, (evento_t[]){ { false, 0 } }, 1);
+  esperar(&b, 100000);
+  CONFERIR("soltura limpa", BOTAO_SOLTO, BOTAO_CLIQUE);
+
+  // Repique de 5 ms no aperto e na soltura: um só clique, confirmado só
+  // depois do antirrebote contado a partir da última borda
+  static const evento_t aperto[] = {
+    { true, 0 }, { false, 300 }, { true, 700 }, { false, 1200 }, { true, 2800 },
+  };
+  repetir(&b, aperto, 5);
+  esperar(&b, ANTIRREBOTE - 10000);
+  CONFERIR_NADA("repique no aperto, antes do antirrebote");
+  esperar(&b, 100000);
+  CONFERIR("repique no aperto", BOTAO_PRESSIONADO);
+  static const evento_t soltura[] = {
+    { false, 0 }, { true, 400 }, { false, 900 }, { true, 150 }, { false, 3000 },
+  };
+  repetir(&b, soltura, 5);
+  esperar(&b, 100000);
+  CONFERIR("repique na soltura", BOTAO_SOLTO, BOTAO_CLIQUE);
+
+  // Descida e subida juntas com o pino lido em nível baixo: o botão ficou
+  // apertado (o evento das bordas sozinho não diria isso)
+  repetir(&b, (evento_t[]){ { true, 0 } }, 1);
+  esperar(&b, LONGO + 50000);
+  CONFERIR("bordas juntas, botão segurado", BOTAO_PRESSIONADO, BOTAO_LONGO);
+  // ... e a soltura também chega fundida com um repique
+  repetir(&b, (evento_t[]){ { false, 0 } }, 1);
+  esperar(&b, 100000);
+  CONFERIR("soltura depois da pressão longa", BOTAO_SOLTO);
+
+  // Bordas juntas terminando solto: repique sem gesto
+  repetir(&b, (evento_t[]){ { false, 0 }, { false, 2000 } }, 2);
+  esperar(&b, 100000);
+  CONFERIR_NADA("repique que volta a solto");
+
+  // Pulso mais curto que o antirrebote é ruído
+  repetir(&b, (evento_t[]){ { true, 0 }, { false, ANTIRREBOTE / 2 } }, 2);
+  esperar(&b, 100000);
+  CONFERIR_NADA("pulso curto");
+
+  // Repique contínuo adia a confirmação: 30 bordas a cada 5 ms
+  for (int i = 0; i < 30; ++i)
+    repetir(&b, (evento_t[]){ { i % 2 == 0, 5000 } }, 1);
+  CONFERIR_NADA("repique contínuo");
+  repetir(&b, (evento_t[]){ { false, 5000 } }, 1);
+  esperar(&b, 100000);
+  CONFERIR_NADA("repique contínuo terminando solto");
+}
+
+static void testar_duplo_clique(void) {
+  botao_t lista[] = { BOTAO(PINO, 300000) };
+  botoes_t b = BOTOES(lista, tratar, ANTIRREBOTE, LONGO);
+  agora = 50000000;
+
+  // Clique simples sai só depois da janela
+  repetir(&b, (evento_t[]){ { true, 0 }, { false, 80000 } }, 2);
+  esperar(&b, 200000);
+  CONFERIR("clique dentro da janela", BOTAO_PRESSIONADO, BOTAO_SOLTO);
+  esperar(&b, 200000);
+  CONFERIR("clique depois da janela", BOTAO_CLIQUE);
+
+  // Dois cliques com repique no segundo aperto
+  repetir(&b, (evento_t[]){ { true, 0 }, { false, 80000 } }, 2);
+  esperar(&b, 100000);
+  static const evento_t segundo[] = {
+    { true, 0 }, { false, 500 }, { true, 600 }, { false, 80000 },
+  };
+  repetir(&b, segundo, 4);
+  esperar(&b, 500000);
+  CONFERIR("duplo clique", BOTAO_PRESSIONADO, BOTAO_SOLTO, BOTAO_PRESSIONADO, BOTAO_SOLTO,
+           BOTAO_DUPLO_CLIQUE);
+}
+
+// Caminho da interrupção: o GPIO simulado chama a rotina a cada borda, e ela
+// só passa o pino; botoes_registrar lê o nível e o relógio simulado
+static void interrupcao(uint gpio, uint32_t eventos) {
+  (void)eventos;
+  botoes_registrar((uint8_t)gpio);
+}
+
+static void testar_interrupcao(void) {
+  botao_t lista[] = { BOTAO(PINO, 0) };
+  botoes_t b = BOTOES(lista, tratar, ANTIRREBOTE, LONGO);
+  hal_gpio_init_input(PINO, true);
+  hal_gpio_set_irq(PINO, HAL_GPIO_EDGE_FALL | HAL_GPIO_EDGE_RISE, interrupcao);
+  hal_host_time_set_us(100000000);
+
+  static const bool niveis[] = { false, true, false, true, false };
+  for (int i = 0; i < 5; ++i) {
+    hal_host_gpio_drive(PINO, niveis[i]);
+    hal_host_time_advance_us(600);
+  }
+  hal_host_time_advance_us(ANTIRREBOTE);
+  botoes_processar(&b, hal_time_us());
+  CONFERIR("interrupção: aperto", BOTAO_PRESSIONADO);
+  hal_host_gpio_release(PINO);
+  hal_host_time_advance_us(ANTIRREBOTE);
+  botoes_processar(&b, hal_time_us());
+  CONFERIR("interrupção: soltura", BOTAO_SOLTO, BOTAO_CLIQUE);
+  VERIFICAR(b.descartados == 0, "%u eventos descartados", (unsigned)b.descartados);
+}
+
+int main(void) {
+  testar_repiques();
+  testar_duplo_clique();
+  testar_interrupcao();
+  return teste_resultado("teste_botoes");
+}
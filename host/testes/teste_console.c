@@ -0,0 +1,206 @@
+// =============================================================================
+// TESTE: CONSOLE DE COMANDOS COM ENTRADA ROTEIRIZADA
+// Linhas são alimentadas byte a byte (console_alimentar) ou pela serial
+// simulada (console_receber) e processadas por console_processar; uma tabela
+// de comandos de teste grava cada despacho. Cobre separação dos argumentos,
+// limites de argumentos, erros, linhas longas, terminadores, anel cheio,
+// limite de linhas por chamada e a conversão de inteiros e horários.
+// =============================================================================
+#include "console.h"
+#include "hal_host.h"
+#include "teste.h"
+
+// Último despacho
+static int chamadas;
+static uint8_t ultimo_argc;
+static char ultimo_argv[CONSOLE_ARGUMENTOS][CONSOLE_LINHA + 1];
+
+static void gravar(uint8_t argc, char **argv) {
+  chamadas++;
+  ultimo_argc = argc;
+  for (uint8_t i = 0; i < argc; ++i)
+    snprintf(ultimo_argv[i], sizeof(ultimo_argv[i]), "%s", argv[i]);
+}
+
+static const console_comando_t comandos[] = {
+  CONSOLE_COMANDO("estado",   gravar, 0, 0, ""),
+  CONSOLE_COMANDO("desejada", gravar, 1, 2, "<porcento> [zona]"),
+  CONSOLE_COMANDO("janela",   gravar, 3, 5, "<zona> <inicio> <fim> ..."),
+};
+
+static console_t console;
+
+static void reiniciar(void) {
+  console = (console_t)CONSOLE(comandos);
+  chamadas = 0;
+}
+
+static void alimentar(const char *texto) {
+  while (*texto)
+    VERIFICAR(console_alimentar(&console, (uint8_t)*texto++), "anel cheio");
+}
+
+// Alimenta e processa tudo; confere linhas despachadas e erros novos
+static void roteiro(const char *texto, uint32_t linhas, int despachos, uint32_t erros) {
+  int chamadas_antes = chamadas;
+  uint32_t erros_antes = console.erros;
+  alimentar(texto);
+  uint32_t processadas = console_processar(&console, 100);
+  VERIFICAR(processadas == linhas, "\"%s\": %u linhas processadas, esperadas %u", texto,
+            (unsigned)processadas, (unsigned)linhas);
+  VERIFICAR(chamadas - chamadas_antes == despachos, "\"%s\": %d despachos, esperados %d", texto,
+            chamadas - chamadas_antes, despachos);
+  VERIFICAR(console.erros - erros_antes == erros, "\"%s\": %u erros, esperados %u", texto,
+            (unsigned)(console.erros - erros_antes), (unsigned)erros);
+}
+
+static void conferir_argv(const char *caso, uint8_t argc, const char *const *argv) {
+  VERIFICAR(ultimo_argc == argc, "%s: argc %u, esperado %u", caso, ultimo_argc, argc);
+  for (uint8_t i = 0; i < argc && i < ultimo_argc; ++i)
+    VERIFICAR(strcmp(ultimo_argv[i], argv[i]) == 0, "%s: argv[%u] = \"%s\", esperado \"%s\"", caso, i,
+              ultimo_argv[i], argv[i]);
+}
+
+#define CONFERIR_ARGV(caso, ...) do { \
+    const char *const argv_[] = { __VA_ARGS__ }; \
+    conferir_argv(caso, (uint8_t)(sizeof(argv_) / sizeof(argv_[0])), argv_); \
+  } while (0)
+
+static void testar_despacho(void) {
+  reiniciar();
+  roteiro("estado\n", 1, 1, 0);
+  CONFERIR_ARGV("estado", "estado");
+
+  // Espaços e tabulações repetidos, no começo e no fim
+  roteiro("  desejada \t 55   2  \n", 1, 1, 0);
+  CONFERIR_ARGV("separação", "desejada", "55", "2");
+
+  // \r\n é uma linha só; \r sozinho também termina a linha
+  roteiro("desejada 40\r\n", 1, 1, 0);
+  CONFERIR_ARGV("\\r\\n", "desejada", "40");
+  roteiro("estado\restado\r", 2, 2, 0);
+
+  // Linhas vazias são ignoradas; só com espaços, processadas sem despacho
+  // nem contagem
+  uint32_t linhas = console.linhas;
+  roteiro("\n\n   \n\t\n", 2, 0, 0);
+  VERIFICAR(console.linhas == linhas, "linhas vazias contadas");
+
+  // Número máximo de palavras
+  roteiro("janela 1 06:00 07:00 08:00 09:00\n", 1, 1, 0);
+  CONFERIR_ARGV("máximo de palavras", "janela", "1", "06:00", "07:00", "08:00", "09:00");
+
+  // Uma linha chegando em pedaços, entre chamadas
+  alimentar("desej");
+  VERIFICAR(console_processar(&console, 100) == 0, "linha incompleta processada");
+  roteiro("ada 7\n", 1, 1, 0);
+  CONFERIR_ARGV("em pedaços", "desejada", "7");
+
+  // ajuda não é da tabela, mas é um comando
+  roteiro("ajuda\n", 1, 0, 0);
+}
+
+static void testar_erros(void) {
+  reiniciar();
+  roteiro("regar\n", 1, 0, 1);                        // Desconhecido
+  roteiro("Estado\n", 1, 0, 1);                       // Nomes diferenciam maiúsculas
+  roteiro("estad\n", 1, 0, 1);                        // Prefixo não vale
+  roteiro("estado 1\n", 1, 0, 1);                     // Argumentos demais para o comando
+  roteiro("desejada\n", 1, 0, 1);                     // Argumentos de menos
+  roteiro("desejada 1 2 3\n", 1, 0, 1);
+  roteiro("janela 1 2 3 4 5 6\n", 1, 0, 1);           // Mais palavras que CONSOLE_ARGUMENTOS
+  VERIFICAR(console.erros == 7, "%u erros", (unsigned)console.erros);
+
+  // Linha com exatamente CONSOLE_LINHA caracteres passa; uma a mais é
+  // descartada inteira, sem despachar nada dela, e a seguinte funciona
+  char linha[CONSOLE_LINHA + 8];
+  memset(linha, ' ', sizeof(linha));
+  memcpy(linha, "estado", 6);
+  linha[CONSOLE_LINHA] = '\n';
+  linha[CONSOLE_LINHA + 1] = '\0';
+  roteiro(linha, 1, 1, 0);
+  memcpy(linha + CONSOLE_LINHA - 6, "estado", 6);   // Palavra extra no fim
+  linha[CONSOLE_LINHA] = 'x';
+  linha[CONSOLE_LINHA + 1] = '\n';
+  linha[CONSOLE_LINHA + 2] = '\0';
+  roteiro(linha, 0, 0, 1);
+  roteiro("estado\n", 1, 1, 0);
+}
+
+static void testar_anel(void) {
+  reiniciar();
+  // Sem processar, o anel aceita CONSOLE_ANEL bytes e recusa o resto
+  int aceitos = 0;
+  for (int i = 0; i < CONSOLE_ANEL + 50; ++i)
+    aceitos += console_alimentar(&console, (uint8_t)((i % 7) == 6 ? '\n' : 'a'));
+  VERIFICAR(aceitos == CONSOLE_ANEL, "%d bytes aceitos", aceitos);
+  VERIFICAR(console.perdidos == 50, "%u bytes perdidos", (unsigned)console.perdidos);
+
+  // max_linhas limita o trabalho por chamada; o resto fica para a próxima
+  reiniciar();
+  alimentar("estado\nestado\nestado\nestado\nestado\n");
+  VERIFICAR(console_processar(&console, 2) == 2 && chamadas == 2, "primeira chamada: %d", chamadas);
+  VERIFICAR(console_processar(&console, 2) == 2 && chamadas == 4, "segunda chamada: %d", chamadas);
+  VERIFICAR(console_processar(&console, 2) == 1 && chamadas == 5, "terceira chamada: %d", chamadas);
+  VERIFICAR(console_processar(&console, 2) == 0, "anel deveria estar vazio");
+
+  // Contadores livres dando a volta: muitas linhas pelo mesmo anel
+  reiniciar();
+  console.cabeca = console.cauda = UINT32_MAX - 20;
+  for (int i = 0; i < 100; ++i)
+    roteiro("desejada 12 3\n", 1, 1, 0);
+  CONFERIR_ARGV("volta dos contadores", "desejada", "12", "3");
+
+  // Pela serial simulada: os bytes chegam a 115200 bauds
+  reiniciar();
+  hal_host_time_set_us(1000000);
+  VERIFICAR(hal_host_stdio_inject("desejada 33\n"), "injeção recusada");
+  console_receber(&console);
+  VERIFICAR(console_processar(&console, 10) == 0, "linha processada antes de chegar");
+  hal_host_time_advance_us(2000);
+  console_receber(&console);
+  VERIFICAR(console_processar(&console, 10) == 1, "linha pela serial não processada");
+  CONFERIR_ARGV("serial", "desejada", "33");
+}
+
+static void testar_conversoes(void) {
+  static const struct { const char *texto; int32_t minimo, maximo; bool valido; int32_t valor; } inteiros[] = {
+    { "0", 0, 100, true, 0 },         { "100", 0, 100, true, 100 },    { "101", 0, 100, false, 0 },
+    { "-1", 0, 100, false, 0 },       { "-5", -10, 10, true, -5 },     { "+7", 0, 10, true, 7 },
+    { "", 0, 10, false, 0 },          { "-", -10, 10, false, 0 },      { "1a", 0, 100, false, 0 },
+    { "0x10", 0, 100, false, 0 },     { " 1", 0, 100, false, 0 },      { "007", 0, 100, true, 7 },
+    { "2147483647", 0, INT32_MAX, true, INT32_MAX },
+    { "2147483648", 0, INT32_MAX, false, 0 },
+    { "-2147483648", INT32_MIN, 0, true, INT32_MIN },
+    { "99999999999999999999", 0, INT32_MAX, false, 0 },
+  };
+  for (size_t i = 0; i < sizeof(inteiros) / sizeof(inteiros[0]); ++i) {
+    int32_t valor = 12345;
+    bool valido = console_inteiro(inteiros[i].texto, inteiros[i].minimo, inteiros[i].maximo, &valor);
+    VERIFICAR(valido == inteiros[i].valido && (!valido || valor == inteiros[i].valor),
+              "console_inteiro(\"%s\"): %d, %ld", inteiros[i].texto, valido, (long)valor);
+    if (!valido)
+      VERIFICAR(valor == 12345, "console_inteiro(\"%s\") mudou o valor ao falhar", inteiros[i].texto);
+  }
+
+  static const struct { const char *texto; bool valido; uint16_t minuto; } horarios[] = {
+    { "00:00", true, 0 },   { "06:30", true, 390 }, { "6:30", true, 390 },  { "23:59", true, 1439 },
+    { "24:00", false, 0 },  { "12:60", false, 0 },  { "12:5", false, 0 },   { "12:055", false, 0 },
+    { "123:00", false, 0 }, { ":30", false, 0 },    { "12", false, 0 },     { "12:", false, 0 },
+    { "+6:30", false, 0 },  { "06:+5", false, 0 },  { "-1:30", false, 0 },  { "06:3a", false, 0 },
+  };
+  for (size_t i = 0; i < sizeof(horarios) / sizeof(horarios[0]); ++i) {
+    uint16_t minuto = 9999;
+    bool valido = console_horario(horarios[i].texto, &minuto);
+    VERIFICAR(valido == horarios[i].valido && (!valido || minuto == horarios[i].minuto),
+              "console_horario(\"%s\"): %d, %u", horarios[i].texto, valido, minuto);
+  }
+}
+
+int main(void) {
+  testar_despacho();
+  testar_erros();
+  testar_anel();
+  testar_conversoes();
+  return teste_resultado("teste_console");
+}
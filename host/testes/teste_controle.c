@@ -0,0 +1,153 @@
+// =============================================================================
+// TESTE: PI EM MALHA FECHADA COM O MODELO DA PLANTA
+// O controlador com a sintonia do firmware rega o modelo de primeira ordem
+// (tau = 60 s, passo de 100 ms). Tempo de subida, assentamento, sobressinal,
+// erro em regime, rejeição de perturbação, anti-windup e limite de taxa têm
+// limites explícitos.
+// =============================================================================
+#include "controle.h"
+#include "planta.h"
+#include "teste.h"
+
+#define PWM_MAX      4095
+#define PASSO_US     100000
+#define PASSOS_S     10        // Passos por segundo
+
+// Mesma sintonia e mesma planta de BitDogLab_Joystick_LEDs.c
+static const pid_config_t config = {
+  .kp_q16 = 20 << 16, .ki_q16 = 22000, .kd_q16 = 0,
+  .saida_min = 0, .saida_max = PWM_MAX, .taxa_max = PWM_MAX / 10,
+  .periodo_us = PASSO_US,
+};
+#define PLANTA_TAU_S  60
+#define PLANTA_GANHO  20
+
+typedef struct {
+  controlador_pid_t pid;
+  planta_t planta;
+  int32_t umidade;
+  int32_t bomba;
+  int32_t maior_salto;     // Maior variação da bomba entre passos
+} laco_t;
+
+static void laco_iniciar(laco_t *l, int32_t umidade, int32_t ganho) {
+  pid_iniciar(&l->pid, &config);
+  planta_iniciar(&l->planta, umidade, PLANTA_TAU_S, ganho, PWM_MAX);
+  l->umidade = umidade;
+  l->bomba = 0;
+  l->maior_salto = 0;
+}
+
+static void laco_passo(laco_t *l, int32_t desejada, int32_t ambiente) {
+  int32_t bomba = pid_passo(&l->pid, desejada, l->umidade);
+  int32_t salto = bomba > l->bomba ? bomba - l->bomba : l->bomba - bomba;
+  if (salto > l->maior_salto)
+    l->maior_salto = salto;
+  l->bomba = bomba;
+  l->umidade = planta_passo(&l->planta, ambiente, bomba, PASSO_US);
+}
+
+// Degrau de 40% para 60% (décimos de %) com ambiente a 30%
+static void testar_degrau(void) {
+  laco_t l;
+  laco_iniciar(&l, 400, PLANTA_GANHO);
+  const int32_t desejada = 600, degrau = 200;
+  int subida = -1, assentamento = 0;
+  int32_t maxima = 0;
+  for (int k = 0; k < 300 * PASSOS_S; ++k) {
+    laco_passo(&l, desejada, 300);
+    if (subida < 0 && l.umidade >= 400 + degrau * 63 / 100)
+      subida = k + 1;
+    if (l.umidade > maxima)
+      maxima = l.umidade;
+    if (l.umidade < desejada - degrau / 20 || l.umidade > desejada + degrau / 20)
+      assentamento = k + 1;
+    VERIFICAR(l.bomba >= 0 && l.bomba <= PWM_MAX, "bomba %d fora da faixa", (int)l.bomba);
+  }
+  // Constante de tempo em malha fechada da ordem de 10 s
+  VERIFICAR(subida > 0 && subida <= 15 * PASSOS_S, "63%% do degrau em %.1f s (limite 15 s)",
+            subida / (double)PASSOS_S);
+  VERIFICAR(subida >= 5 * PASSOS_S, "63%% do degrau em %.1f s: rápido demais para a bomba limitada",
+            subida / (double)PASSOS_S);
+  // Assentamento na faixa de ±5% do degrau
+  VERIFICAR(assentamento <= 60 * PASSOS_S, "assentamento (±5%%) em %.1f s (limite 60 s)",
+            assentamento / (double)PASSOS_S);
+  // Sobressinal de no máximo 2% do degrau
+  VERIFICAR(maxima <= desejada + degrau / 50, "sobressinal: máxima %d para desejada %d",
+            (int)maxima, (int)desejada);
+  // Erro em regime de no máximo 0,2%
+  VERIFICAR(l.umidade >= desejada - 2 && l.umidade <= desejada + 2, "regime em %d", (int)l.umidade);
+  // Limite de taxa: no máximo 10% do curso por passo
+  VERIFICAR(l.maior_salto <= PWM_MAX / 10, "bomba variou %d em um passo", (int)l.maior_salto);
+
+  // Perturbação: o ambiente seca de 30% para 10%; a umidade cai menos de 5%
+  // e volta à faixa de ±1% em até 90 s
+  int32_t minima = 1000;
+  int fora = 0;
+  for (int k = 0; k < 180 * PASSOS_S; ++k) {
+    laco_passo(&l, desejada, 100);
+    if (l.umidade < minima)
+      minima = l.umidade;
+    if (l.umidade < desejada - 10 || l.umidade > desejada + 10)
+      fora = k + 1;
+  }
+  VERIFICAR(minima >= desejada - 50, "perturbação derrubou a umidade para %d", (int)minima);
+  VERIFICAR(fora <= 90 * PASSOS_S, "recuperação da perturbação em %.1f s (limite 90 s)",
+            fora / (double)PASSOS_S);
+}
+
+// Bomba fraca demais para o setpoint: saturada por 10 minutos. Quando o
+// setpoint cai abaixo da medida, a bomba tem de desligar no ritmo do limite
+// de taxa, sem esperar um integrador acumulado esvaziar
+static void testar_anti_windup(void) {
+  laco_t l;
+  laco_iniciar(&l, 300, 2);   // Equilíbrio máximo: 30% + 2 * 60 = 42%
+  for (int k = 0; k < 600 * PASSOS_S; ++k)
+    laco_passo(&l, 800, 300);
+  VERIFICAR(l.bomba == PWM_MAX, "bomba em %d com o setpoint inalcançável", (int)l.bomba);
+  int passos = 0;
+  while (l.bomba > 0 && passos < 100) {
+    laco_passo(&l, 300, 300);
+    ++passos;
+  }
+  VERIFICAR(passos <= 11, "bomba levou %d passos para desligar (limite 11)", passos);
+}
+
+// O passo vetorial (zonas) segue o escalar, passo a passo
+static void testar_vetor(void) {
+  enum { N = 4 };
+  controlador_pid_t pid[N];
+  int32_t desejada[N], medida[N], anterior[N], saida[N];
+  int64_t integral[N];
+  for (int i = 0; i < N; ++i) {
+    pid_iniciar(&pid[i], &config);
+    integral[i] = 0;
+    saida[i] = config.saida_min;
+    medida[i] = anterior[i] = 300 + 50 * i;
+  }
+  for (int k = 0; k < 2000; ++k) {
+    for (int i = 0; i < N; ++i) {
+      desejada[i] = (k / 300) % 2 ? 350 : 700 - 40 * i;
+      medida[i] = (int32_t)(300 + 50 * i + (k * (i + 3)) % 400);
+    }
+    int32_t esperada[N];
+    for (int i = 0; i < N; ++i)
+      esperada[i] = pid_passo(&pid[i], desejada[i], medida[i]);
+    pid_passo_vetor(&config, N, desejada, medida, integral, anterior, saida);
+    for (int i = 0; i < N; ++i) {
+      if (saida[i] != esperada[i]) {
+        VERIFICAR(false, "passo %d, zona %d: vetor %d != escalar %d", k, i, (int)saida[i],
+                  (int)esperada[i]);
+        return;
+      }
+    }
+  }
+  ++teste_verificacoes;
+}
+
+int main(void) {
+  testar_degrau();
+  testar_anti_windup();
+  testar_vetor();
+  return teste_resultado("teste_controle");
+}
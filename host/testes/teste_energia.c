@@ -0,0 +1,167 @@
+// =============================================================================
+// TESTE: MÁQUINA DE ESTADOS DE ENERGIA
+// Um roteiro sobre o relógio simulado, atualizado a cada 100 ms como no
+// firmware: ATIVO -> OCIOSO no tempo limite, atividade acordando a máquina,
+// painel apagando no seu próprio tempo limite (inclusive desligado) e a
+// carga calculada segmento a segmento. Depois, passos e atividades
+// aleatórios: o tempo por estado soma o tempo decorrido e a carga é a soma
+// de corrente x tempo do estado que vigorava em cada intervalo.
+// =============================================================================
+#include "energia.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define S 1000000ull
+
+static const energia_config_t config = {
+  .ocioso_apos_us = 30 * S,
+  .tela_apos_us = 10 * S,
+  .corrente_ua = { [ENERGIA_ATIVO] = 24000, [ENERGIA_OCIOSO] = 15000, [ENERGIA_DESLIGADO] = 8000 },
+  .corrente_tela_ua = 9000,
+};
+
+static energia_t energia;
+
+// -----------------------------------------------------------------------------
+// Roteiro
+// -----------------------------------------------------------------------------
+typedef struct {
+  uint64_t inicio_s, fim_s;
+  energia_estado_t estado;
+  bool tela;
+} segmento_t;
+
+// O que tem de vigorar em cada trecho, com os eventos do roteiro:
+// atividade em 45 s, 90 s (desligado) e 120 s; sistema desligado de 80 s a
+// 120 s
+static const segmento_t segmentos[] = {
+  { 0, 10, ENERGIA_ATIVO, true },
+  { 10, 30, ENERGIA_ATIVO, false },       // Painel apaga em 10 s
+  { 30, 45, ENERGIA_OCIOSO, false },      // Ocioso em 30 s
+  { 45, 55, ENERGIA_ATIVO, true },        // Atividade acorda tudo
+  { 55, 75, ENERGIA_ATIVO, false },
+  { 75, 80, ENERGIA_OCIOSO, false },
+  { 80, 90, ENERGIA_DESLIGADO, false },   // Desligado pelo usuário
+  { 90, 100, ENERGIA_DESLIGADO, true },   // Atividade desligado: só o painel
+  { 100, 120, ENERGIA_DESLIGADO, false },
+  { 120, 130, ENERGIA_ATIVO, true },      // Religado com atividade
+  { 130, 150, ENERGIA_ATIVO, false },
+  { 150, 200, ENERGIA_OCIOSO, false },
+};
+#define N_SEGMENTOS (sizeof(segmentos) / sizeof(segmentos[0]))
+
+static const segmento_t *segmento_em(uint64_t t_us) {
+  for (size_t i = 0; i < N_SEGMENTOS; ++i)
+    if (t_us < segmentos[i].fim_s * S)
+      return &segmentos[i];
+  return &segmentos[N_SEGMENTOS - 1];
+}
+
+static bool em(uint64_t t_us, uint64_t s) {
+  return t_us == s * S;
+}
+
+static void testar_roteiro(void) {
+  hal_host_time_set_us(0);
+  energia_iniciar(&energia, &config, hal_time_us());
+  unsigned mudancas = 0;
+
+  for (uint64_t t = 0; t <= 200 * S; t += 100000) {
+    hal_host_time_set_us(t);
+    uint64_t agora = hal_time_us();
+    if (em(agora, 45) || em(agora, 90) || em(agora, 120))
+      energia_atividade(&energia, agora);
+    bool ligado = agora < 80 * S || agora >= 120 * S;
+
+    const segmento_t *antes = segmento_em(agora > 0 ? agora - 1 : 0);
+    const segmento_t *esperado = segmento_em(agora);
+    bool mudou = energia_atualizar(&energia, ligado, agora);
+    mudancas += mudou;
+
+    bool deve_mudar = agora > 0 && (antes->estado != esperado->estado || antes->tela != esperado->tela);
+    VERIFICAR(mudou == deve_mudar, "t = %.1f s: mudança %d, esperada %d", agora / 1e6, mudou, deve_mudar);
+    VERIFICAR(energia.estado == esperado->estado, "t = %.1f s: estado %d, esperado %d", agora / 1e6,
+              energia.estado, esperado->estado);
+    VERIFICAR(energia.tela_ligada == esperado->tela, "t = %.1f s: painel %s", agora / 1e6,
+              energia.tela_ligada ? "aceso" : "apagado");
+  }
+
+  // Tempos e carga por segmento, contados à mão a partir da tabela
+  uint64_t tempo[ENERGIA_ESTADOS] = { 0 }, tela = 0, carga_uas = 0;
+  for (size_t i = 0; i < N_SEGMENTOS; ++i) {
+    uint64_t d = segmentos[i].fim_s - segmentos[i].inicio_s;
+    tempo[segmentos[i].estado] += d;
+    tela += segmentos[i].tela ? d : 0;
+    carga_uas += d * (config.corrente_ua[segmentos[i].estado] +
+                      (segmentos[i].tela ? config.corrente_tela_ua : 0));
+  }
+  VERIFICAR(tempo[ENERGIA_ATIVO] == 90 && tempo[ENERGIA_OCIOSO] == 70 && tempo[ENERGIA_DESLIGADO] == 40,
+            "tabela do roteiro inconsistente");
+  for (int i = 0; i < ENERGIA_ESTADOS; ++i)
+    VERIFICAR(energia.tempo_us[i] == tempo[i] * S, "estado %d: %llu us, esperado %llu s", i,
+              (unsigned long long)energia.tempo_us[i], (unsigned long long)tempo[i]);
+  VERIFICAR(energia.tempo_tela_us == tela * S, "painel aceso %llu us, esperado %llu s",
+            (unsigned long long)energia.tempo_tela_us, (unsigned long long)tela);
+  VERIFICAR(energia_carga_uc(&energia) == carga_uas, "carga %llu uC, esperada %llu",
+            (unsigned long long)energia_carga_uc(&energia), (unsigned long long)carga_uas);
+  VERIFICAR(energia.transicoes == 6, "%u transições de estado", energia.transicoes);
+  VERIFICAR(mudancas == N_SEGMENTOS - 1, "%u mudanças informadas", mudancas);
+}
+
+// -----------------------------------------------------------------------------
+// Passos e atividades aleatórios
+// -----------------------------------------------------------------------------
+static void testar_aleatorio(void) {
+  uint64_t inicio = 1234567;
+  hal_host_time_set_us(inicio);
+  energia_iniciar(&energia, &config, hal_time_us());
+  bool ligado = true;
+  energia_estado_t estado = energia.estado;
+  bool tela = energia.tela_ligada;
+  // Carga em uA x us: só é dividida por 10^6 no fim, como no módulo por estado
+  uint64_t carga_estado[ENERGIA_ESTADOS] = { 0 }, carga_tela = 0;
+
+  for (int passo = 0; passo < 100000; ++passo) {
+    uint64_t dt = teste_aleatorio() % 64 == 0 ? teste_entre(0, 60000) * 1000ull : teste_entre(0, 500000);
+    hal_host_time_advance_us(dt);
+    uint64_t agora = hal_time_us();
+    carga_estado[estado] += dt * config.corrente_ua[estado];
+    carga_tela += tela ? dt * config.corrente_tela_ua : 0;
+
+    uint32_t sorteio = teste_aleatorio() % 256;
+    if (sorteio < 8)
+      energia_atividade(&energia, agora);
+    else if (sorteio == 8)
+      ligado = !ligado;
+    energia_atualizar(&energia, ligado, agora);
+
+    uint64_t parado = agora - energia.atividade_us;
+    energia_estado_t esperado = !ligado                            ? ENERGIA_DESLIGADO
+                                : parado >= config.ocioso_apos_us ? ENERGIA_OCIOSO
+                                                                  : ENERGIA_ATIVO;
+    VERIFICAR(energia.estado == esperado, "passo %d: estado %d, esperado %d", passo, energia.estado,
+              esperado);
+    VERIFICAR(energia.tela_ligada == (parado < config.tela_apos_us), "passo %d: painel", passo);
+    estado = energia.estado;
+    tela = energia.tela_ligada;
+  }
+
+  uint64_t decorrido = hal_time_us() - inicio, soma = 0, carga = carga_tela / 1000000u;
+  for (int i = 0; i < ENERGIA_ESTADOS; ++i) {
+    soma += energia.tempo_us[i];
+    carga += carga_estado[i] / 1000000u;
+  }
+  VERIFICAR(soma == decorrido, "tempos somam %llu us de %llu", (unsigned long long)soma,
+            (unsigned long long)decorrido);
+  VERIFICAR(energia.tempo_tela_us <= decorrido, "painel aceso mais que o tempo decorrido");
+  VERIFICAR(energia_carga_uc(&energia) == carga, "carga %llu uC, esperada %llu",
+            (unsigned long long)energia_carga_uc(&energia), (unsigned long long)carga);
+  for (int i = 0; i < ENERGIA_ESTADOS; ++i)
+    VERIFICAR(energia.tempo_us[i] > 0, "estado %d nunca visitado", i);
+}
+
+int main(void) {
+  testar_roteiro();
+  testar_aleatorio();
+  return teste_resultado("teste_energia");
+}
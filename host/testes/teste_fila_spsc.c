@@ -0,0 +1,215 @@
+// =============================================================================
+// TESTE: FILA SPSC ENTRE DUAS THREADS
+// Um produtor e um consumidor em threads de verdade, com fila pequena para
+// ela encher e esvaziar o tempo todo. Cada item leva o número de sequência e
+// uma carga derivada dele: um item rasgado (cópia lida antes de terminar de
+// ser escrita), repetido ou fora de ordem aparece na conferência. Os índices
+// começam perto de 2^32 para a volta do contador acontecer no meio do teste.
+// A disputa real precisa de dois processadores; com um só, as threads se
+// alternam quase sempre nos sched_yield() e o teste só confere a lógica.
+// A caixa do último valor é testada do mesmo jeito: um consumidor lento tem
+// de receber sempre o item mais recente, inteiro, e nunca um mais antigo.
+// =============================================================================
+#include <pthread.h>
+#include <sched.h>
+#include "fila_spsc.h"
+#include "teste.h"
+
+#define ITENS 2000000u
+
+typedef struct {
+  uint32_t sequencia;
+  uint32_t carga[7];
+} item_t;
+
+FILA_SPSC_DEFINIR(fila, item_t, 8);
+CAIXA_SPSC_DEFINIR(caixa, item_t);
+
+static void preencher(item_t *item, uint32_t sequencia) {
+  item->sequencia = sequencia;
+  for (int i = 0; i < 7; ++i)
+    item->carga[i] = sequencia * 2654435761u + (uint32_t)i;
+}
+
+static bool integro(const item_t *item) {
+  for (int i = 0; i < 7; ++i)
+    if (item->carga[i] != item->sequencia * 2654435761u + (uint32_t)i)
+      return false;
+  return true;
+}
+
+static void reiniciar(void) {
+  atomic_store(&fila.cabeca, UINT32_MAX - 1000u);
+  atomic_store(&fila.cauda, UINT32_MAX - 1000u);
+  fila.descartadas = 0;
+}
+
+// Produtor que insiste: nenhum item se perde
+static void *produzir_todos(void *arg) {
+  (void)arg;
+  item_t item;
+  for (uint32_t s = 0; s < ITENS; ++s) {
+    preencher(&item, s);
+    while (!fila_spsc_enviar(&fila, &item))
+      sched_yield();   // Com um processador só, cede a vez ao consumidor
+  }
+  return NULL;
+}
+
+// Produtor que descarta com a fila cheia, como o firmware; ao fim, insiste
+// num item de sequência ITENS que marca o término
+static uint32_t descartes;
+
+static void *produzir_descartando(void *arg) {
+  (void)arg;
+  item_t item;
+  for (uint32_t s = 0; s < ITENS; ++s) {
+    preencher(&item, s);
+    fila_spsc_enviar(&fila, &item);
+  }
+  descartes = fila.descartadas;
+  preencher(&item, ITENS);
+  while (!fila_spsc_enviar(&fila, &item))
+    sched_yield();
+  return NULL;
+}
+
+static void testar_sem_perdas(void) {
+  reiniciar();
+  pthread_t produtor;
+  pthread_create(&produtor, NULL, produzir_todos, NULL);
+  item_t item;
+  uint32_t esperado = 0, rasgados = 0, fora_de_ordem = 0;
+  while (esperado < ITENS) {
+    if (!fila_spsc_receber(&fila, &item)) {
+      sched_yield();
+      continue;
+    }
+    rasgados += !integro(&item);
+    fora_de_ordem += item.sequencia != esperado;
+    esperado = item.sequencia + 1;
+  }
+  pthread_join(produtor, NULL);
+  VERIFICAR(rasgados == 0, "%u itens rasgados", rasgados);
+  VERIFICAR(fora_de_ordem == 0, "%u itens fora de ordem", fora_de_ordem);
+  VERIFICAR(!fila_spsc_receber(&fila, &item), "item sobrando na fila");
+  VERIFICAR(fila.descartadas > 0, "a fila nunca encheu: o teste não exercitou a disputa");
+}
+
+static void testar_com_descartes(bool so_ultimo) {
+  reiniciar();
+  pthread_t produtor;
+  pthread_create(&produtor, NULL, produzir_descartando, NULL);
+  item_t item;
+  uint32_t recebidos = 0, rasgados = 0, fora_de_ordem = 0;
+  int64_t ultimo = -1;
+  while (ultimo != ITENS) {
+    uint32_t n = so_ultimo ? fila_spsc_receber_ultimo(&fila, &item)
+                           : fila_spsc_receber(&fila, &item);
+    if (n == 0) {
+      sched_yield();
+      continue;
+    }
+    recebidos += n;
+    rasgados += !integro(&item);
+    fora_de_ordem += (int64_t)item.sequencia <= ultimo;
+    ultimo = item.sequencia;
+  }
+  pthread_join(produtor, NULL);
+  const char *modo = so_ultimo ? "receber_ultimo" : "receber";
+  VERIFICAR(rasgados == 0, "%s: %u itens rasgados", modo, rasgados);
+  VERIFICAR(fora_de_ordem == 0, "%s: %u itens repetidos ou fora de ordem", modo, fora_de_ordem);
+  VERIFICAR(recebidos - 1 + descartes == ITENS, "%s: %u recebidos + %u descartados != %u", modo,
+            recebidos - 1, descartes, ITENS);
+  VERIFICAR(!fila_spsc_receber(&fila, &item), "%s: item depois do término", modo);
+}
+
+// -----------------------------------------------------------------------------
+// Caixa do último valor
+// -----------------------------------------------------------------------------
+
+// A sequência começa perto de 2^32 (e par) para a volta acontecer no teste
+static void reiniciar_caixa(void) {
+  atomic_store(&caixa.sequencia, UINT32_MAX - 1001u);
+  caixa.lida = UINT32_MAX - 1001u;
+}
+
+// O ritmo do firmware com a tela desligada: publicações a cada 100 ms e
+// leituras a cada 1 s, às vezes com intervalos irregulares. Cada leitura tem
+// de trazer a última publicação, e só uma vez
+static void testar_caixa_consumidor_lento(void) {
+  reiniciar_caixa();
+  item_t item;
+  VERIFICAR(!caixa_spsc_ler(&caixa, &item), "caixa: leitura antes da primeira publicação");
+  uint32_t s = 0;
+  for (int leitura = 0; leitura < 2000; ++leitura) {
+    uint32_t publicacoes = teste_aleatorio() % 4 == 0 ? teste_entre(0, 30) : 10;
+    for (uint32_t i = 0; i < publicacoes; ++i) {
+      preencher(&item, s++);
+      caixa_spsc_publicar(&caixa, &item);
+    }
+    memset(&item, 0xAA, sizeof(item));
+    bool nova = caixa_spsc_ler(&caixa, &item);
+    if (publicacoes == 0) {
+      VERIFICAR(!nova, "caixa: leitura %d sem publicação nova devolveu item", leitura);
+      continue;
+    }
+    VERIFICAR(nova, "caixa: leitura %d não viu %u publicações", leitura, publicacoes);
+    VERIFICAR(item.sequencia == s - 1 && integro(&item), "caixa: leitura %d trouxe %u, esperado %u",
+              leitura, item.sequencia, s - 1);
+    VERIFICAR(!caixa_spsc_ler(&caixa, &item), "caixa: leitura %d repetida", leitura);
+  }
+}
+
+// Produtor sem pausa; publicadas conta as publicações já terminadas
+static _Atomic uint32_t publicadas;
+
+static void *publicar_todos(void *arg) {
+  (void)arg;
+  item_t item;
+  for (uint32_t s = 0; s < ITENS; ++s) {
+    preencher(&item, s);
+    caixa_spsc_publicar(&caixa, &item);
+    atomic_store(&publicadas, s + 1);
+  }
+  return NULL;
+}
+
+// Consumidor lento contra o produtor em outra thread: o item lido nunca é
+// anterior à última publicação terminada antes da leitura começar
+static void testar_caixa_concorrente(void) {
+  reiniciar_caixa();
+  atomic_store(&publicadas, 0);
+  pthread_t produtor;
+  pthread_create(&produtor, NULL, publicar_todos, NULL);
+  item_t item;
+  uint32_t leituras = 0, rasgados = 0, atrasados = 0, fora_de_ordem = 0;
+  int64_t ultimo = -1;
+  while (ultimo != ITENS - 1) {
+    for (uint32_t i = teste_entre(0, 3); i > 0; --i)
+      sched_yield();   // O consumidor é o lado lento
+    uint32_t terminadas = atomic_load(&publicadas);
+    if (!caixa_spsc_ler(&caixa, &item))
+      continue;
+    ++leituras;
+    rasgados += !integro(&item);
+    atrasados += terminadas > 0 && item.sequencia < terminadas - 1;
+    fora_de_ordem += (int64_t)item.sequencia <= ultimo;
+    ultimo = item.sequencia;
+  }
+  pthread_join(produtor, NULL);
+  VERIFICAR(rasgados == 0, "caixa: %u itens rasgados", rasgados);
+  VERIFICAR(atrasados == 0, "caixa: %u leituras de um item já substituído", atrasados);
+  VERIFICAR(fora_de_ordem == 0, "caixa: %u itens repetidos ou fora de ordem", fora_de_ordem);
+  VERIFICAR(leituras < ITENS, "caixa: o consumidor leu todos os %u itens: não foi lento", leituras);
+  VERIFICAR(!caixa_spsc_ler(&caixa, &item), "caixa: item depois do último");
+}
+
+int main(void) {
+  testar_caixa_consumidor_lento();
+  testar_caixa_concorrente();
+  testar_sem_perdas();
+  testar_com_descartes(false);
+  testar_com_descartes(true);
+  return teste_resultado("teste_fila_spsc");
+}
@@ -0,0 +1,157 @@
+// =============================================================================
+// TESTE: CADEIA DE FILTROS SOBRE O TRAÇO GRAVADO
+// O traço host/traco_umidade.txt (1 kHz, com ruído, zumbido de 60 Hz, picos
+// isolados e uma rega em t = 2 s) passa pela cadeia configurada como no
+// firmware. Cada saída é comparada com uma implementação direta das mesmas
+// etapas, e o comportamento tem limites explícitos: picos rejeitados, leitura
+// estável sem oscilar e tempo de resposta à rega.
+// =============================================================================
+#include "filtro.h"
+#include "traco.h"
+#include "teste.h"
+
+#define MAX_AMOSTRAS 8192
+#define RAMPA_INICIO 2000     // Amostra em que a rega começa
+
+static uint16_t traco[MAX_AMOSTRAS];
+static int32_t saida[MAX_AMOSTRAS];
+
+// Mesma configuração do sensor de umidade no firmware
+static const filtro_config_t config = {
+  .calibrar = true, .mediana = 5, .media = 16, .ema_shift = 4, .histerese = 3,
+};
+
+// -----------------------------------------------------------------------------
+// REFERÊNCIA: as etapas escritas da forma mais direta, sobre o histórico
+// -----------------------------------------------------------------------------
+static int cmp_int32(const void *a, const void *b) {
+  int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void referencia(const uint16_t *entrada, size_t n, int32_t *esperada) {
+  static int32_t calibrada[MAX_AMOSTRAS], mediana[MAX_AMOSTRAS], media[MAX_AMOSTRAS];
+  int32_t ema_q8 = 0, ultima = 0;
+  for (size_t i = 0; i < n; ++i) {
+    // Reta de 0..4095 para 0..1000 décimos de porcento
+    calibrada[i] = (int32_t)(((int64_t)entrada[i] * ((1000 << 16) / 4095) + 0x8000) >> 16);
+
+    size_t j0 = i >= 4 ? i - 4 : 0;
+    int32_t janela[5];
+    size_t m = 0;
+    for (size_t j = j0; j <= i; ++j)
+      janela[m++] = calibrada[j];
+    qsort(janela, m, sizeof(janela[0]), cmp_int32);
+    mediana[i] = janela[m / 2];
+
+    size_t k0 = i >= 15 ? i - 15 : 0;
+    int32_t soma = 0;
+    for (size_t k = k0; k <= i; ++k)
+      soma += mediana[k];
+    media[i] = soma / (int32_t)(i - k0 + 1);
+
+    ema_q8 = i == 0 ? media[i] * 256 : ema_q8 + ((media[i] * 256 - ema_q8) >> 4);
+    int32_t ema = (ema_q8 + 128) >> 8;
+
+    if (i == 0 || ema > ultima + 3 || ema < ultima - 3)
+      ultima = ema;
+    esperada[i] = ultima;
+  }
+}
+
+int main(void) {
+  size_t n = traco_carregar("host/traco_umidade.txt", traco, MAX_AMOSTRAS);
+  VERIFICAR(n == 4000, "traço com %zu amostras", n);
+  if (n < 4000)
+    return teste_resultado("teste_filtro");
+
+  calibracao_t calibracao;
+  calibracao_definir(&calibracao, 0, 0, 4095, 1000);
+  VERIFICAR(calibracao_aplicar(&calibracao, 0) == 0, "seco");
+  VERIFICAR(calibracao_aplicar(&calibracao, 2048) == 500, "meio da escala: %d",
+            (int)calibracao_aplicar(&calibracao, 2048));
+  VERIFICAR(calibracao_aplicar(&calibracao, 4095) == 1000, "encharcado: %d",
+            (int)calibracao_aplicar(&calibracao, 4095));
+  VERIFICAR(calibracao_aplicar(&calibracao, 5000) == 1000, "acima da escala não é limitado");
+
+  filtro_t filtro;
+  filtro_iniciar(&filtro, &config, &calibracao);
+  for (size_t i = 0; i < n; ++i)
+    saida[i] = filtro_processar(&filtro, traco[i]);
+
+  // Saídas idênticas às da referência, amostra por amostra
+  static int32_t esperada[MAX_AMOSTRAS];
+  referencia(traco, n, esperada);
+  size_t diferente = 0;
+  while (diferente < n && saida[diferente] == esperada[diferente])
+    ++diferente;
+  VERIFICAR(diferente == n, "amostra %zu: %d != %d (referência)", diferente,
+            diferente < n ? (int)saida[diferente] : 0, diferente < n ? (int)esperada[diferente] : 0);
+
+  // Antes da rega (depois de 100 ms de aquecimento dos filtros): a leitura
+  // fica perto da média bruta, apesar dos picos de até 4095 e do zumbido,
+  // e muda pouco (sem tremer de um décimo para outro)
+  int64_t soma = 0;
+  for (size_t i = 100; i < RAMPA_INICIO; ++i)
+    soma += calibracao_aplicar(&calibracao, traco[i]);
+  int32_t media_bruta = (int32_t)(soma / (RAMPA_INICIO - 100));
+  int32_t minima = INT32_MAX, maxima = INT32_MIN;
+  unsigned mudancas = 0;
+  for (size_t i = 100; i < RAMPA_INICIO; ++i) {
+    if (saida[i] < minima)
+      minima = saida[i];
+    if (saida[i] > maxima)
+      maxima = saida[i];
+    mudancas += saida[i] != saida[i - 1];
+  }
+  VERIFICAR(minima >= media_bruta - 5 && maxima <= media_bruta + 5,
+            "saída em [%d, %d] décimos, média bruta %d (limite ±5)", (int)minima, (int)maxima,
+            (int)media_bruta);
+  VERIFICAR(mudancas <= 5, "%u mudanças da saída em 1,9 s (limite 5)", mudancas);
+
+  // Rega: do nível seco (~417) ao molhado (~640). 90% da subida em até
+  // 150 ms, sem passar do nível final mais que a histerese
+  int32_t seco = saida[RAMPA_INICIO - 1];
+  int32_t molhado = 0;
+  for (size_t i = n - 500; i < n; ++i)
+    molhado += saida[i];
+  molhado /= 500;
+  VERIFICAR(molhado - seco > 200, "rega de só %d décimos", (int)(molhado - seco));
+  size_t subida = RAMPA_INICIO;
+  while (subida < n && saida[subida] < seco + (molhado - seco) * 9 / 10)
+    ++subida;
+  VERIFICAR(subida - RAMPA_INICIO <= 150, "90%% da rega em %zu ms (limite 150)",
+            subida - RAMPA_INICIO);
+  VERIFICAR(subida - RAMPA_INICIO >= 40, "90%% da rega em %zu ms: a subida do sensor "
+            "leva ~90 ms, resposta mais rápida indica filtro desligado", subida - RAMPA_INICIO);
+  for (size_t i = RAMPA_INICIO; i < n; ++i) {
+    if (saida[i] > molhado + 8) {
+      VERIFICAR(false, "sobressinal de %d décimos em %zu", (int)(saida[i] - molhado), i);
+      break;
+    }
+  }
+
+  // Cada pico isolado do traço (mais de 300 LSB fora dos vizinhos) some
+  unsigned picos = 0;
+  for (size_t i = 100; i + 1 < n; ++i) {
+    int32_t vizinhos = (traco[i - 1] + traco[i + 1]) / 2;
+    if (abs((int)traco[i] - vizinhos) > 300 && abs((int)traco[i - 1] - (int)traco[i + 1]) < 100) {
+      ++picos;
+      VERIFICAR(abs((int)(saida[i] - saida[i - 1])) <= 8, "pico em %zu passou: %d -> %d", i,
+                (int)saida[i - 1], (int)saida[i]);
+    }
+  }
+  VERIFICAR(picos >= 5, "traço com só %u picos isolados", picos);
+
+  // Eixo do joystick: zona morta e escala que recomeça em 0 fora dela
+  joystick_eixo_t eixo = { .zona_morta = 100, .minimo = 0, .maximo = 4095 };
+  joystick_calibrar_centro(&eixo, 2000);
+  VERIFICAR(joystick_deflexao(&eixo, 2099) == 0, "dentro da zona morta");
+  VERIFICAR(joystick_deflexao(&eixo, 2101) == 0, "sem degrau na borda da zona morta");
+  VERIFICAR(joystick_deflexao(&eixo, 4095) == 100, "%d no fim do curso",
+            (int)joystick_deflexao(&eixo, 4095));
+  VERIFICAR(joystick_deflexao(&eixo, 0) == -100, "%d no início do curso",
+            (int)joystick_deflexao(&eixo, 0));
+
+  return teste_resultado("teste_filtro");
+}
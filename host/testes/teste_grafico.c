@@ -0,0 +1,128 @@
+// =============================================================================
+// TESTE: ROLAGEM DO GRÁFICO DE TENDÊNCIA
+// Um gráfico atualizado por rolagem (grafico_atualizar com o gráfico válido)
+// tem de deixar no buffer exatamente os mesmos bytes que outro, sobre a mesma
+// série, redesenhado do zero a cada atualização. Lotes de 0 a mais que a
+// largura em amostras novas, série ainda incompleta, valores fora da faixa,
+// troca da referência e série esvaziada. As colunas marcadas como sujas têm de
+// bastar: depois de ssd1306_send_dirty, a GDDRAM emulada é igual ao buffer.
+// =============================================================================
+#include "grafico.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define RODADAS 5000
+#define ENDERECO_ROLADO 0x3C
+#define ENDERECO_REDESENHO 0x3D
+
+SSD1306_DEFINE(rolado, 128, 64);
+SSD1306_DEFINE(redesenho, 128, 64);
+
+static grafico_serie_t serie;
+
+// O gráfico de tendência do firmware (128x56 com setpoint) e, na página 0
+// que ele deixa livre, uma linha de tendência estreita fora da origem e outra
+// com faixa negativa. As áreas não se sobrepõem: cada gráfico rola só o que
+// ele mesmo desenhou
+typedef struct {
+  grafico_t rolado, redesenho;
+} par_t;
+
+static par_t pares[] = {
+  { GRAFICO(&serie, 0, 8, 128, 56, 0, 100), GRAFICO(&serie, 0, 8, 128, 56, 0, 100) },
+  { GRAFICO(&serie, 37, 0, 77, 8, 0, 100), GRAFICO(&serie, 37, 0, 77, 8, 0, 100) },
+  { GRAFICO(&serie, 0, 0, 31, 8, -50, 50), GRAFICO(&serie, 0, 0, 31, 8, -50, 50) },
+};
+#define N_PARES (sizeof(pares) / sizeof(pares[0]))
+
+static int16_t valor_anterior = 50;
+
+// Passeio aleatório com saltos ocasionais, às vezes fora da faixa dos gráficos
+static int16_t proxima_amostra(void) {
+  int32_t v = valor_anterior;
+  if (teste_aleatorio() % 16 == 0)
+    v = (int32_t)teste_entre(0, 260) - 130;
+  else
+    v += (int32_t)teste_entre(0, 20) - 10;
+  if (v < -150)
+    v = -150;
+  if (v > 150)
+    v = 150;
+  return valor_anterior = (int16_t)v;
+}
+
+// Quantas amostras chegam entre duas atualizações: quase sempre poucas
+static uint32_t lote(void) {
+  uint32_t sorteio = teste_aleatorio() % 32;
+  if (sorteio == 0)
+    return teste_entre(100, 300);   // Mais que a largura: redesenho completo
+  if (sorteio < 4)
+    return 0;
+  return sorteio < 24 ? 1 : teste_entre(2, 20);
+}
+
+static void comparar(int rodada) {
+  if (memcmp(rolado.ram_buffer, redesenho.ram_buffer, rolado.bufsize) == 0) {
+    ++teste_verificacoes;
+  } else {
+    char etapa[48];
+    snprintf(etapa, sizeof(etapa), "rolagem != redesenho, rodada %d", rodada);
+    VERIFICAR_MEMORIA(rolado.ram_buffer, redesenho.ram_buffer, rolado.bufsize, etapa);
+  }
+
+  ssd1306_send_dirty(&rolado);
+  if (memcmp(hal_host_panel_ram(ENDERECO_ROLADO), rolado.ram_buffer + 1, 128 * 8) == 0) {
+    ++teste_verificacoes;
+  } else {
+    char etapa[48];
+    snprintf(etapa, sizeof(etapa), "envio das colunas sujas, rodada %d", rodada);
+    VERIFICAR_MEMORIA(hal_host_panel_ram(ENDERECO_ROLADO), rolado.ram_buffer + 1, 128 * 8, etapa);
+  }
+}
+
+// Retorna true se o gráfico rolado desenhou só parte das colunas (rolagem)
+static bool atualizar(par_t *p, int rodada) {
+  uint8_t colunas = grafico_atualizar(&rolado, &p->rolado);
+  grafico_invalidar(&p->redesenho);
+  uint8_t todas = grafico_atualizar(&redesenho, &p->redesenho);
+  VERIFICAR(todas == p->redesenho.largura, "redesenho com %u colunas, rodada %d", todas, rodada);
+  return colunas > 0 && colunas < todas;
+}
+
+int main(void) {
+  hal_i2c_init(i2c1, 400000, 14, 15);
+  ssd1306_init(&rolado, false, ENDERECO_ROLADO, i2c1);
+  ssd1306_init(&redesenho, false, ENDERECO_REDESENHO, i2c1);
+  ssd1306_config(&rolado);
+
+  // Fora das áreas dos gráficos nada pode mudar: os dois partem do mesmo lixo
+  for (size_t i = 1; i < rolado.bufsize; ++i)
+    rolado.ram_buffer[i] = redesenho.ram_buffer[i] = (uint8_t)teste_aleatorio();
+  ssd1306_send_data(&rolado);
+
+  unsigned rolagens = 0;
+  for (int rodada = 0; rodada < RODADAS; ++rodada) {
+    uint32_t sorteio = teste_aleatorio() % 512;
+    if (sorteio == 0) {
+      grafico_serie_limpar(&serie);
+      for (size_t i = 0; i < N_PARES; ++i)
+        grafico_invalidar(&pares[i].rolado);
+    } else if (sorteio < 8) {
+      // Referência nova (ou nenhuma), fora da faixa às vezes
+      int16_t r = sorteio == 1 ? GRAFICO_SEM_REFERENCIA : (int16_t)((int32_t)teste_entre(0, 240) - 120);
+      par_t *p = &pares[teste_aleatorio() % N_PARES];
+      grafico_definir_referencia(&p->rolado, r);
+      grafico_definir_referencia(&p->redesenho, r);
+    }
+
+    for (uint32_t n = lote(); n > 0; --n)
+      grafico_serie_adicionar(&serie, proxima_amostra());
+    for (size_t i = 0; i < N_PARES; ++i)
+      rolagens += atualizar(&pares[i], rodada);
+    comparar(rodada);
+  }
+
+  // A comparação só vale se o caminho de rolagem foi exercitado
+  VERIFICAR(rolagens > RODADAS, "só %u atualizações por rolagem", rolagens);
+  return teste_resultado("teste_grafico");
+}
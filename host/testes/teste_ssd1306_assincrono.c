@@ -0,0 +1,234 @@
+// =============================================================================
+// TESTE: ENVIO ASSÍNCRONO DO SSD1306
+// Uma transação por faixa de páginas sujas (não o retângulo que as envolve),
+// encadeadas na conclusão de cada uma, e recuperação de um envio abortado
+// por NACK: o erro chega ao chamador e as colunas perdidas são reenviadas.
+// Dois painéis no mesmo barramento revezam os quadros, e o seguinte da fila
+// parte na conclusão do anterior, sem nova chamada do driver.
+// =============================================================================
+#include "ssd1306.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define ENDERECO 0x3C
+#define ENDERECO_SEGUNDO 0x3D
+
+SSD1306_DEFINE(painel, 128, 64);
+SSD1306_DEFINE(segundo, 128, 64);
+
+// Uma janela de uma página: cabeçalho da janela, byte de controle e dados
+#define BYTES_JANELA(colunas) (SSD1306_WINDOW_HEADER + 1u + (colunas))
+
+static unsigned conclusoes, falhas;
+
+static void concluido(ssd1306_t *ssd, bool ok) {
+  VERIFICAR(ssd == &painel, "painel errado na conclusão");
+  ++conclusoes;
+  if (!ok)
+    ++falhas;
+}
+
+static bool painel_igual(void) {
+  return memcmp(hal_host_panel_ram(ENDERECO), painel.ram_buffer + 1, 128 * 8) == 0;
+}
+
+static void testar_janelas_separadas(void) {
+  ssd1306_pixel(&painel, 3, 1, true);      // Página 0
+  ssd1306_pixel(&painel, 120, 62, true);   // Página 7
+  hal_host_i2c_reset_stats();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+
+  // A primeira janela fica retida no barramento simulado até a conclusão
+  size_t len = 0;
+  const uint8_t *pendente = hal_host_i2c_pending(&len);
+  VERIFICAR(pendente != NULL, "nenhuma transferência pendente");
+  VERIFICAR(len == BYTES_JANELA(1), "primeira janela com %zu bytes", len);
+  if (pendente && len == BYTES_JANELA(1)) {
+    const uint8_t esperado[] = { 0x80, SET_COL_ADDR, 0x80, 3, 0x80, 3,
+                                 0x80, SET_PAGE_ADDR, 0x80, 0, 0x80, 0, 0x40, 0x02 };
+    VERIFICAR_MEMORIA(pendente, esperado, sizeof(esperado), "janela da página 0");
+  }
+
+  // A conclusão da primeira inicia a segunda
+  VERIFICAR(hal_host_i2c_complete(), "conclusão sem transferência");
+  pendente = hal_host_i2c_pending(&len);
+  VERIFICAR(pendente != NULL && len == BYTES_JANELA(1), "segunda janela ausente");
+  VERIFICAR(ssd1306_flush_busy(&painel), "painel livre com janela pendente");
+  ssd1306_flush_wait(&painel);
+
+  hal_host_i2c_stats_t s = hal_host_i2c_stats();
+  VERIFICAR(s.transactions == 2, "%u transações", s.transactions);
+  VERIFICAR(s.bytes == 2 * BYTES_JANELA(1), "%u bytes para dois pixels", s.bytes);
+  VERIFICAR(conclusoes == 1 && falhas == 0, "%u conclusões, %u falhas", conclusoes, falhas);
+  VERIFICAR(painel_igual(), "painel diferente do buffer");
+}
+
+static void testar_faixa_continua(void) {
+  // Páginas 2 a 4 com colunas próximas: uma janela só com a união das colunas
+  ssd1306_rect(&painel, 20, 40, 10, 16, true, true);
+  ssd1306_pixel(&painel, 52, 36, true);
+  hal_host_i2c_reset_stats();
+  conclusoes = 0;
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  hal_host_i2c_stats_t s = hal_host_i2c_stats();
+  VERIFICAR(s.transactions == 1, "%u transações", s.transactions);
+  VERIFICAR(s.bytes == SSD1306_WINDOW_HEADER + 1u + 3u * 13u, "%u bytes", s.bytes);
+  VERIFICAR(conclusoes == 1, "%u conclusões", conclusoes);
+  VERIFICAR(painel_igual(), "painel diferente do buffer");
+}
+
+static void testar_nack(void) {
+  conclusoes = falhas = 0;
+  hal_host_i2c_nack(ENDERECO, true);
+  ssd1306_pixel(&painel, 10, 10, true);
+  ssd1306_pixel(&painel, 100, 50, true);
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  VERIFICAR(conclusoes == 1 && falhas == 1, "%u conclusões, %u falhas", conclusoes, falhas);
+  VERIFICAR(painel.flush_errors == 1, "%u erros contados", (unsigned)painel.flush_errors);
+  VERIFICAR(!painel_igual(), "dados chegaram a um painel que não responde");
+
+  // A escrita bloqueante também vê o NACK, e só ele
+  const uint8_t nop[] = { SSD1306_COMMAND_STREAM, 0xE3 };
+  VERIFICAR(hal_i2c_write(i2c1, ENDERECO, nop, sizeof(nop)) < 0, "NACK não informado");
+  hal_host_i2c_nack(ENDERECO, false);
+  VERIFICAR(hal_i2c_write(i2c1, ENDERECO, nop, sizeof(nop)) == sizeof(nop),
+            "erro antigo informado numa escrita bem-sucedida");
+
+  // Sem desenho novo, o próximo envio repete as colunas que se perderam
+  conclusoes = falhas = 0;
+  hal_host_i2c_reset_stats();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  hal_host_i2c_stats_t s = hal_host_i2c_stats();
+  VERIFICAR(s.transactions == 2 && s.bytes == 2 * BYTES_JANELA(1), "%u transações, %u bytes",
+            s.transactions, s.bytes);
+  VERIFICAR(conclusoes == 1 && falhas == 0, "%u conclusões, %u falhas", conclusoes, falhas);
+  VERIFICAR(painel_igual(), "painel não recuperou o quadro perdido");
+
+  // E depois disso não há mais nada a enviar
+  hal_host_i2c_reset_stats();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  VERIFICAR(hal_host_i2c_stats().transactions == 0, "reenvio repetido");
+}
+
+static void testar_quadro_inteiro(void) {
+  // Todas as páginas sujas de ponta a ponta: uma janela de quadro inteiro
+  for (size_t i = 1; i < painel.bufsize; ++i)
+    painel.ram_buffer[i] = (uint8_t)(i * 13u);
+  ssd1306_mark_dirty(&painel, 0, 127, 0, 7);
+  hal_host_i2c_reset_stats();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  hal_host_i2c_stats_t s = hal_host_i2c_stats();
+  VERIFICAR(s.transactions == 1 && s.bytes == BYTES_JANELA(1024), "%u transações, %u bytes",
+            s.transactions, s.bytes);
+  VERIFICAR(painel_igual(), "painel diferente do buffer");
+}
+
+// -----------------------------------------------------------------------------
+// Dois painéis no mesmo barramento
+// -----------------------------------------------------------------------------
+#define QUADROS 20
+
+static ssd1306_t *ordem[2 * QUADROS];
+static unsigned n_ordem, restantes[2];
+
+static bool gddram_igual(ssd1306_t *ssd) {
+  return memcmp(hal_host_panel_ram(ssd->address), ssd->ram_buffer + 1, 128 * 8) == 0;
+}
+
+// Pixels em páginas alternadas: várias janelas por quadro
+static void desenhar(ssd1306_t *ssd) {
+  for (uint8_t page = teste_aleatorio() % 2; page < 8; page += 2)
+    ssd1306_pixel(ssd, (uint8_t)teste_entre(0, 127), (uint8_t)(page * 8 + teste_entre(0, 7)),
+                  teste_aleatorio() % 2);
+  ssd1306_mark_dirty(ssd, 0, 0, 0, 0);   // Ao menos uma janela, mesmo sem mudança
+}
+
+// Só as conclusões (a interrupção, no alvo) movem a fila: nada de
+// ssd1306_flush_poll, ssd1306_flush_busy ou ssd1306_flush_wait
+static unsigned concluir_tudo(void) {
+  unsigned n = 0;
+  while (hal_host_i2c_complete())
+    ++n;
+  return n;
+}
+
+static void testar_fila_sem_driver(void) {
+  ssd1306_set_flush_callback(&painel, NULL);
+  for (int rodada = 0; rodada < 50; ++rodada) {
+    ssd1306_t *primeiro = rodada % 2 ? &segundo : &painel;
+    ssd1306_t *outro = rodada % 2 ? &painel : &segundo;
+    desenhar(primeiro);
+    desenhar(outro);
+    VERIFICAR(ssd1306_flush_async(primeiro), "envio recusado, rodada %d", rodada);
+    VERIFICAR(ssd1306_flush_async(outro), "envio na fila recusado, rodada %d", rodada);
+    uint8_t janelas = (uint8_t)(primeiro->front_windows + outro->front_windows);
+    VERIFICAR(outro->flush_state == SSD1306_FLUSH_QUEUED, "segundo painel fora da fila, rodada %d",
+              rodada);
+
+    unsigned transacoes = concluir_tudo();
+    VERIFICAR(transacoes == janelas, "%u transações para %u janelas, rodada %d", transacoes, janelas,
+              rodada);
+    VERIFICAR(painel.flush_state == SSD1306_FLUSH_IDLE && segundo.flush_state == SSD1306_FLUSH_IDLE,
+              "envio parado na fila, rodada %d", rodada);
+    VERIFICAR(gddram_igual(&painel), "GDDRAM de 0x%02x diferente do buffer, rodada %d", ENDERECO, rodada);
+    VERIFICAR(gddram_igual(&segundo), "GDDRAM de 0x%02x diferente do buffer, rodada %d", ENDERECO_SEGUNDO,
+              rodada);
+  }
+}
+
+// Cada painel pede o próximo quadro assim que o anterior termina: com o
+// outro sempre na fila, os quadros se alternam
+static void reenviar(ssd1306_t *ssd, bool ok) {
+  VERIFICAR(ok, "quadro de 0x%02x abortado", ssd->address);
+  if (n_ordem < 2 * QUADROS)
+    ordem[n_ordem++] = ssd;
+  unsigned *r = &restantes[ssd == &segundo];
+  if (*r == 0)
+    return;
+  --*r;
+  desenhar(ssd);
+  VERIFICAR(ssd1306_flush_async(ssd), "reenvio de 0x%02x recusado", ssd->address);
+}
+
+static void testar_revezamento(void) {
+  ssd1306_set_flush_callback(&painel, reenviar);
+  ssd1306_set_flush_callback(&segundo, reenviar);
+  n_ordem = 0;
+  restantes[0] = restantes[1] = QUADROS - 1;
+  desenhar(&painel);
+  desenhar(&segundo);
+  VERIFICAR(ssd1306_flush_async(&painel) && ssd1306_flush_async(&segundo), "envio recusado");
+  concluir_tudo();
+
+  VERIFICAR(n_ordem == 2 * QUADROS, "%u quadros concluídos", n_ordem);
+  for (unsigned i = 0; i < n_ordem; ++i)
+    VERIFICAR(ordem[i] == (i % 2 ? &segundo : &painel), "quadro %u fora do revezamento", i);
+  VERIFICAR(gddram_igual(&painel) && gddram_igual(&segundo), "GDDRAM diferente do buffer");
+  ssd1306_set_flush_callback(&painel, NULL);
+  ssd1306_set_flush_callback(&segundo, NULL);
+}
+
+int main(void) {
+  hal_i2c_init(i2c1, 400000, 14, 15);
+  ssd1306_init(&painel, false, ENDERECO, i2c1);
+  ssd1306_config(&painel);
+  ssd1306_send_data(&painel);
+  ssd1306_set_flush_callback(&painel, concluido);
+
+  testar_janelas_separadas();
+  testar_faixa_continua();
+  testar_nack();
+  testar_quadro_inteiro();
+
+  ssd1306_init(&segundo, false, ENDERECO_SEGUNDO, i2c1);
+  ssd1306_config(&segundo);
+  ssd1306_send_data(&segundo);
+  testar_fila_sem_driver();
+  testar_revezamento();
+  return teste_resultado("teste_ssd1306_assincrono");
+}
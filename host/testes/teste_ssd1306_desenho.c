@@ -0,0 +1,86 @@
+// =============================================================================
+// TESTE: PRIMITIVAS DE 32 BITS CONTRA AS DE REFERÊNCIA
+// fill, rect (cheio e contorno), hline e vline sobre um painel têm de deixar
+// exatamente os mesmos bytes que as versões pixel a pixel de desenho_pixel.h
+// sobre outro, com posições, tamanhos e cores aleatórios (inclusive fora da
+// tela) e partindo de conteúdo aleatório.
+// =============================================================================
+#include "ssd1306.h"
+#include "desenho_pixel.h"
+#include "teste.h"
+
+#define RODADAS 20000
+
+SSD1306_DEFINE(rapido, 128, 64);
+SSD1306_DEFINE(referencia, 128, 64);
+SSD1306_DEFINE(rapido_32, 128, 32);
+SSD1306_DEFINE(referencia_32, 128, 32);
+// Largura que não é múltipla de 4: o alinhamento das páginas muda
+SSD1306_DEFINE(rapido_estreito, 77, 64);
+SSD1306_DEFINE(referencia_estreito, 77, 64);
+
+// Coordenada aleatória, às vezes fora da tela
+static uint8_t coordenada(uint8_t limite) {
+  return (uint8_t)(teste_aleatorio() % 8 == 0 ? teste_entre(0, 255) : teste_entre(0, limite - 1));
+}
+
+static void comparar(ssd1306_t *a, ssd1306_t *b, int rodada) {
+  if (memcmp(a->ram_buffer, b->ram_buffer, a->bufsize) == 0) {
+    ++teste_verificacoes;
+    return;
+  }
+  char etapa[64];
+  snprintf(etapa, sizeof(etapa), "painel %ux%u, rodada %d", a->width, a->height, rodada);
+  VERIFICAR_MEMORIA(a->ram_buffer, b->ram_buffer, a->bufsize, etapa);
+}
+
+static void testar(ssd1306_t *a, ssd1306_t *b) {
+  for (size_t i = 1; i < a->bufsize; ++i)
+    a->ram_buffer[i] = b->ram_buffer[i] = (uint8_t)teste_aleatorio();
+
+  for (int rodada = 0; rodada < RODADAS; ++rodada) {
+    uint8_t x0 = coordenada(a->width), x1 = coordenada(a->width);
+    uint8_t y0 = coordenada(a->height), y1 = coordenada(a->height);
+    bool cor = teste_aleatorio() & 1;
+    switch (teste_aleatorio() % 5) {
+      case 0:
+        if (teste_aleatorio() % 16 == 0) {
+          ssd1306_fill(a, cor);
+          pixel_fill(b, cor);
+        }
+        break;
+      case 1:
+      case 2: {
+        uint8_t largura = (uint8_t)teste_entre(0, a->width);
+        uint8_t altura = (uint8_t)teste_entre(0, a->height);
+        bool cheio = teste_aleatorio() & 1;
+        ssd1306_rect(a, y0, x0, largura, altura, cor, cheio);
+        pixel_rect(b, y0, x0, largura, altura, cor, cheio);
+        break;
+      }
+      case 3:
+        ssd1306_hline(a, x0, x1, y0, cor);
+        pixel_hline(b, x0, x1, y0, cor);
+        break;
+      default:
+        ssd1306_vline(a, x0, y0, y1, cor);
+        pixel_vline(b, x0, y0, y1, cor);
+        break;
+    }
+    comparar(a, b, rodada);
+  }
+}
+
+int main(void) {
+  ssd1306_init(&rapido, false, 0x3C, i2c1);
+  ssd1306_init(&referencia, false, 0x3C, i2c1);
+  ssd1306_init(&rapido_32, false, 0x3C, i2c1);
+  ssd1306_init(&referencia_32, false, 0x3C, i2c1);
+  ssd1306_init(&rapido_estreito, false, 0x3C, i2c1);
+  ssd1306_init(&referencia_estreito, false, 0x3C, i2c1);
+
+  testar(&rapido, &referencia);
+  testar(&rapido_32, &referencia_32);
+  testar(&rapido_estreito, &referencia_estreito);
+  return teste_resultado("teste_ssd1306_desenho");
+}
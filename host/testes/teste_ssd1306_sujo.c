@@ -0,0 +1,128 @@
+// =============================================================================
+// TESTE: ENVIO SÓ DAS PÁGINAS ALTERADAS
+// Depois de cada atualização parcial, a GDDRAM do painel emulado tem de ser
+// igual ao buffer de desenho, e o tráfego I2C (hal_host_i2c_stats) tem de
+// ficar no que a janela mínima exige, abaixo do quadro inteiro.
+// =============================================================================
+#include "ssd1306.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define ENDERECO 0x3C
+
+SSD1306_DEFINE(painel, 128, 64);
+
+// Bytes de um envio de quadro inteiro: janela (controle + 6 comandos) e
+// dados (controle + 1024)
+#define BYTES_QUADRO (7u + 1u + 128u * 8u)
+
+static void verificar_painel(const char *etapa) {
+  VERIFICAR_MEMORIA(hal_host_panel_ram(ENDERECO), painel.ram_buffer + 1, 128 * 8, etapa);
+}
+
+static hal_host_i2c_stats_t enviar_sujo(void) {
+  hal_host_i2c_reset_stats();
+  ssd1306_send_dirty(&painel);
+  return hal_host_i2c_stats();
+}
+
+static hal_host_i2c_stats_t enviar_assincrono(void) {
+  hal_host_i2c_reset_stats();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio assíncrono recusado");
+  ssd1306_flush_wait(&painel);
+  return hal_host_i2c_stats();
+}
+
+static void testar_quadro_inteiro(void) {
+  for (size_t i = 1; i < painel.bufsize; ++i)
+    painel.ram_buffer[i] = (uint8_t)(i * 37u);
+  hal_host_i2c_reset_stats();
+  ssd1306_send_data(&painel);
+  hal_host_i2c_stats_t s = hal_host_i2c_stats();
+  VERIFICAR(s.transactions == 2, "%u transações", s.transactions);
+  VERIFICAR(s.bytes == BYTES_QUADRO, "%u bytes", s.bytes);
+  verificar_painel("quadro inteiro");
+
+  // Sem alterações, nada vai para o barramento
+  s = enviar_sujo();
+  VERIFICAR(s.transactions == 0 && s.bytes == 0, "%u bytes sem alteração", s.bytes);
+}
+
+static void testar_pixel(void) {
+  ssd1306_fill(&painel, false);
+  ssd1306_send_data(&painel);
+
+  // Um pixel: janela de uma coluna numa página (7 bytes) + controle e 1 byte
+  ssd1306_pixel(&painel, 77, 42, true);
+  hal_host_i2c_stats_t s = enviar_sujo();
+  VERIFICAR(s.transactions == 2, "%u transações", s.transactions);
+  VERIFICAR(s.bytes == 7 + 2, "%u bytes para um pixel", s.bytes);
+  verificar_painel("um pixel");
+
+  // Reescrever o mesmo valor não suja a página
+  ssd1306_pixel(&painel, 77, 42, true);
+  s = enviar_sujo();
+  VERIFICAR(s.bytes == 0, "%u bytes para pixel inalterado", s.bytes);
+
+  // Duas páginas distantes: duas janelas separadas, não o retângulo entre elas
+  ssd1306_pixel(&painel, 3, 1, true);
+  ssd1306_pixel(&painel, 120, 62, true);
+  s = enviar_sujo();
+  VERIFICAR(s.transactions == 4, "%u transações", s.transactions);
+  VERIFICAR(s.bytes == 2 * (7 + 2), "%u bytes para dois pixels", s.bytes);
+  verificar_painel("dois pixels");
+}
+
+// Atualizações parciais aleatórias, como as da interface: texto, retângulos e
+// linhas em posições variadas
+static void desenhar_aleatorio(void) {
+  uint32_t n = teste_entre(1, 4);
+  for (uint32_t k = 0; k < n; ++k) {
+    uint8_t x = (uint8_t)teste_entre(0, 127);
+    uint8_t y = (uint8_t)teste_entre(0, 63);
+    bool cor = teste_aleatorio() & 1;
+    switch (teste_aleatorio() % 4) {
+      case 0:
+        ssd1306_rect(&painel, y, x, (uint8_t)teste_entre(1, 20), (uint8_t)teste_entre(1, 20),
+                     cor, teste_aleatorio() & 1);
+        break;
+      case 1:
+        ssd1306_draw_string(&painel, "42%", x, y);
+        break;
+      case 2:
+        ssd1306_line(&painel, x, y, (uint8_t)teste_entre(0, 127), (uint8_t)teste_entre(0, 63), cor);
+        break;
+      default:
+        ssd1306_pixel(&painel, x, y, cor);
+        break;
+    }
+  }
+}
+
+static void testar_aleatorio(void) {
+  uint32_t total = 0;
+  for (int rodada = 0; rodada < 500; ++rodada) {
+    desenhar_aleatorio();
+    bool assincrono = rodada & 1;
+    hal_host_i2c_stats_t s = assincrono ? enviar_assincrono() : enviar_sujo();
+    VERIFICAR(s.bytes <= BYTES_QUADRO + 8 * 14, "rodada %d: %u bytes", rodada, s.bytes);
+    total += s.bytes;
+    char etapa[48];
+    snprintf(etapa, sizeof(etapa), "rodada %d (%s)", rodada, assincrono ? "assíncrono" : "síncrono");
+    verificar_painel(etapa);
+  }
+  // Atualizações pequenas custam bem menos que quadros inteiros
+  VERIFICAR(total < 500u * BYTES_QUADRO / 2, "%u bytes em 500 rodadas", total);
+}
+
+int main(void) {
+  hal_i2c_init(i2c1, 400000, 14, 15);
+  ssd1306_init(&painel, false, ENDERECO, i2c1);
+  ssd1306_config(&painel);
+  VERIFICAR(hal_host_panel_display_on(ENDERECO), "painel desligado após a configuração");
+
+  testar_quadro_inteiro();
+  testar_pixel();
+  testar_aleatorio();
+  return teste_resultado("teste_ssd1306_sujo");
+}
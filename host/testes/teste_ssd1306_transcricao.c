@@ -0,0 +1,223 @@
+// =============================================================================
+// TESTE: TRANSCRIÇÃO I2C DO SSD1306
+// Os bytes que vão para o barramento, transação por transação, comparados
+// com sequências escritas à mão a partir da folha de dados: inicialização
+// numa transação só, janela de escrita "00 21 x0 x1 22 p0 p1" seguida da
+// transação de dados "40 ...", liga/desliga e a janela com Co = 1 do envio
+// assíncrono. Uma mudança de ordem, um comando a mais ou uma transação
+// partida em duas aparecem aqui mesmo que a GDDRAM emulada fique igual.
+// =============================================================================
+#include "ssd1306.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define ENDERECO 0x3C
+#define ENDERECO_32 0x3D
+
+SSD1306_DEFINE(painel, 128, 64);
+SSD1306_DEFINE(painel_32, 64, 32);
+
+// -----------------------------------------------------------------------------
+// Gravação das transações
+// -----------------------------------------------------------------------------
+#define MAX_TRANSACOES 8
+#define MAX_BYTES 1100
+
+typedef struct {
+  uint8_t addr;
+  size_t tamanho;
+  uint8_t dados[MAX_BYTES];
+} transacao_t;
+
+static transacao_t transacoes[MAX_TRANSACOES];
+static unsigned n_transacoes;
+static unsigned transacoes_perdidas;
+
+static void gravar(uint8_t addr, const uint8_t *dados, size_t tamanho, void *contexto) {
+  (void)contexto;
+  if (n_transacoes == MAX_TRANSACOES || tamanho > MAX_BYTES) {
+    ++transacoes_perdidas;
+    return;
+  }
+  transacao_t *t = &transacoes[n_transacoes++];
+  t->addr = addr;
+  t->tamanho = tamanho;
+  memcpy(t->dados, dados, tamanho);
+}
+
+static void limpar_gravacao(void) {
+  n_transacoes = 0;
+  transacoes_perdidas = 0;
+}
+
+// Transação i tem de ir para addr com exatamente os bytes esperados
+static void verificar_transacao(unsigned i, uint8_t addr, const uint8_t *esperado, size_t tamanho,
+                                const char *descricao) {
+  VERIFICAR(transacoes_perdidas == 0, "%u transações fora da gravação; %s", transacoes_perdidas, descricao);
+  VERIFICAR(i < n_transacoes, "transação %u ausente (%u gravadas); %s", i, n_transacoes, descricao);
+  if (i >= n_transacoes)
+    return;
+  const transacao_t *t = &transacoes[i];
+  VERIFICAR(t->addr == addr, "endereço 0x%02x; %s", t->addr, descricao);
+  VERIFICAR(t->tamanho == tamanho, "%zu bytes, esperados %zu; %s", t->tamanho, tamanho, descricao);
+  if (t->tamanho == tamanho)
+    VERIFICAR_MEMORIA(t->dados, esperado, tamanho, descricao);
+}
+
+// Transação de dados: byte de controle 0x40 e as colunas, na ordem de envio
+static void verificar_dados(unsigned i, const uint8_t *colunas, size_t tamanho, const char *descricao) {
+  static uint8_t esperado[MAX_BYTES];
+  esperado[0] = 0x40;
+  memcpy(&esperado[1], colunas, tamanho);
+  verificar_transacao(i, ENDERECO, esperado, tamanho + 1, descricao);
+}
+
+// -----------------------------------------------------------------------------
+// Casos
+// -----------------------------------------------------------------------------
+static void testar_inicializacao(void) {
+  static const uint8_t init_64[] = {
+    0x00,
+    0xAE,             // Display desligado
+    0x20, 0x00,       // Endereçamento horizontal
+    0x40,             // Linha inicial 0
+    0xA1,             // Coluna 127 no SEG0
+    0xA8, 0x3F,       // Multiplex de 64 linhas
+    0xC8,             // Varredura COM de baixo para cima
+    0xD3, 0x00,       // Sem deslocamento vertical
+    0xDA, 0x12,       // Pinos COM alternados
+    0xD5, 0x80,       // Divisor do clock
+    0xD9, 0xF1,       // Pré-carga
+    0xDB, 0x30,       // Nível VCOMH
+    0x81, 0xFF,       // Contraste
+    0xA4,             // Segue a GDDRAM
+    0xA6,             // Não invertido
+    0x8D, 0x14,       // Bomba de carga interna
+    0xAF,             // Display ligado
+  };
+  static const uint8_t init_32[] = {
+    0x00, 0xAE, 0x20, 0x00, 0x40, 0xA1,
+    0xA8, 0x1F,       // Multiplex de 32 linhas
+    0xC8, 0xD3, 0x00,
+    0xDA, 0x02,       // Pinos COM sequenciais
+    0xD5, 0x80, 0xD9, 0xF1, 0xDB, 0x30, 0x81, 0xFF, 0xA4, 0xA6, 0x8D, 0x14, 0xAF,
+  };
+  _Static_assert(!SSD1306_ROTATE_180, "sequências esperadas para a orientação padrão");
+
+  limpar_gravacao();
+  ssd1306_config(&painel);
+  VERIFICAR(n_transacoes == 1, "inicialização em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, init_64, sizeof(init_64), "inicialização 128x64");
+
+  limpar_gravacao();
+  ssd1306_config(&painel_32);
+  VERIFICAR(n_transacoes == 1, "inicialização em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO_32, init_32, sizeof(init_32), "inicialização 64x32");
+}
+
+static void testar_liga_desliga(void) {
+  static const uint8_t desligar[] = { 0x00, 0xAE, 0x8D, 0x10 };
+  static const uint8_t ligar[] = { 0x00, 0x8D, 0x14, 0xAF };
+
+  limpar_gravacao();
+  ssd1306_display(&painel, false);
+  ssd1306_display(&painel, true);
+  VERIFICAR(n_transacoes == 2, "%u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, desligar, sizeof(desligar), "desligar");
+  verificar_transacao(1, ENDERECO, ligar, sizeof(ligar), "ligar");
+}
+
+static void testar_quadro_inteiro(void) {
+  static const uint8_t janela[] = { 0x00, 0x21, 0x00, 0x7F, 0x22, 0x00, 0x07 };
+  static const uint8_t janela_32[] = { 0x00, 0x21, 0x00, 0x3F, 0x22, 0x00, 0x03 };
+
+  for (size_t i = 1; i < painel.bufsize; ++i)
+    painel.ram_buffer[i] = (uint8_t)(i * 29u + 5u);
+  limpar_gravacao();
+  ssd1306_send_data(&painel);
+  VERIFICAR(n_transacoes == 2, "quadro inteiro em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, janela, sizeof(janela), "janela do quadro inteiro");
+  verificar_dados(1, painel.ram_buffer + 1, 128 * 8, "dados do quadro inteiro");
+
+  // Geometria diferente da padrão: janela montada na hora
+  limpar_gravacao();
+  ssd1306_send_data(&painel_32);
+  VERIFICAR(n_transacoes == 2, "quadro 64x32 em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO_32, janela_32, sizeof(janela_32), "janela do quadro 64x32");
+}
+
+static void testar_janelas_sujas(void) {
+  ssd1306_fill(&painel, false);
+  ssd1306_send_data(&painel);
+
+  // Um pixel em (77, 42): coluna 0x4D, página 5, bit 2
+  ssd1306_pixel(&painel, 77, 42, true);
+  limpar_gravacao();
+  ssd1306_send_dirty(&painel);
+  static const uint8_t janela_pixel[] = { 0x00, 0x21, 0x4D, 0x4D, 0x22, 0x05, 0x05 };
+  static const uint8_t dados_pixel[] = { 0x40, 0x04 };
+  VERIFICAR(n_transacoes == 2, "pixel em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, janela_pixel, sizeof(janela_pixel), "janela do pixel");
+  verificar_transacao(1, ENDERECO, dados_pixel, sizeof(dados_pixel), "dados do pixel");
+
+  // Duas páginas distantes: uma janela por página, na ordem das páginas
+  ssd1306_pixel(&painel, 10, 60, true);    // Página 7, coluna 0x0A
+  ssd1306_hline(&painel, 100, 103, 3, true);  // Página 0, colunas 0x64..0x67
+  limpar_gravacao();
+  ssd1306_send_dirty(&painel);
+  static const uint8_t janela_p0[] = { 0x00, 0x21, 0x64, 0x67, 0x22, 0x00, 0x00 };
+  static const uint8_t dados_p0[] = { 0x40, 0x08, 0x08, 0x08, 0x08 };
+  static const uint8_t janela_p7[] = { 0x00, 0x21, 0x0A, 0x0A, 0x22, 0x07, 0x07 };
+  static const uint8_t dados_p7[] = { 0x40, 0x10 };
+  VERIFICAR(n_transacoes == 4, "duas janelas em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, janela_p0, sizeof(janela_p0), "janela da página 0");
+  verificar_transacao(1, ENDERECO, dados_p0, sizeof(dados_p0), "dados da página 0");
+  verificar_transacao(2, ENDERECO, janela_p7, sizeof(janela_p7), "janela da página 7");
+  verificar_transacao(3, ENDERECO, dados_p7, sizeof(dados_p7), "dados da página 7");
+
+  // Páginas 2 e 3 quase inteiras: uma janela de largura total cobre as duas
+  ssd1306_hline(&painel, 1, 126, 20, true);
+  ssd1306_hline(&painel, 0, 127, 28, true);
+  limpar_gravacao();
+  ssd1306_send_dirty(&painel);
+  static const uint8_t janela_unida[] = { 0x00, 0x21, 0x00, 0x7F, 0x22, 0x02, 0x03 };
+  VERIFICAR(n_transacoes == 2, "páginas unidas em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, janela_unida, sizeof(janela_unida), "janela das páginas 2 e 3");
+  verificar_dados(1, painel.ram_buffer + 1 + 2 * 128, 2 * 128, "dados das páginas 2 e 3");
+}
+
+// No envio assíncrono, janela e dados vão numa transação só: cada comando
+// com o byte de controle 0x80 (Co = 1) e os dados depois de 0x40
+static void testar_janela_assincrona(void) {
+  ssd1306_fill(&painel, false);
+  ssd1306_send_data(&painel);
+
+  ssd1306_hline(&painel, 64, 66, 50, true);   // Página 6, colunas 0x40..0x42, bit 2
+  limpar_gravacao();
+  VERIFICAR(ssd1306_flush_async(&painel), "envio recusado");
+  ssd1306_flush_wait(&painel);
+  static const uint8_t esperado[] = {
+    0x80, 0x21, 0x80, 0x40, 0x80, 0x42, 0x80, 0x22, 0x80, 0x06, 0x80, 0x06,
+    0x40, 0x04, 0x04, 0x04,
+  };
+  VERIFICAR(n_transacoes == 1, "janela assíncrona em %u transações", n_transacoes);
+  verificar_transacao(0, ENDERECO, esperado, sizeof(esperado), "janela assíncrona");
+}
+
+int main(void) {
+  hal_i2c_init(i2c1, 400000, 14, 15);
+  ssd1306_init(&painel, false, ENDERECO, i2c1);
+  ssd1306_init(&painel_32, false, ENDERECO_32, i2c1);
+  hal_host_i2c_observe(gravar, NULL);
+
+  testar_inicializacao();
+  testar_liga_desliga();
+  testar_quadro_inteiro();
+  testar_janelas_sujas();
+  testar_janela_assincrona();
+
+  hal_host_i2c_observe(NULL, NULL);
+  VERIFICAR(memcmp(hal_host_panel_ram(ENDERECO), painel.ram_buffer + 1, 128 * 8) == 0,
+            "GDDRAM emulada difere do buffer");
+  return teste_resultado("teste_ssd1306_transcricao");
+}
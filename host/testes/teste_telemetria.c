@@ -0,0 +1,291 @@
+// =============================================================================
+// TESTE: QUADROS DA TELEMETRIA BINÁRIA
+// Codificação e decodificação nos extremos: deltas de ±65535 nos campos de
+// 16 bits, volta do instante_us e lacunas na sequência (inclusive a volta
+// dela). O pior caso ocupa exatamente TELEMETRIA_QUADRO_MAX. Quadros com CRC,
+// comprimento ou carga errados são recusados. O anel de saída é escoado em
+// quadros inteiros, também quando um quadro atravessa o fim do vetor.
+// =============================================================================
+#include "telemetria.h"
+#include "crc16.h"
+#include "teste.h"
+
+static bool registros_iguais(const registro_t *a, const registro_t *b) {
+  return a->sequencia == b->sequencia && a->instante_us == b->instante_us && a->umidade == b->umidade &&
+         a->desejada == b->desejada && a->bomba == b->bomba && a->flags == b->flags;
+}
+
+// Codifica n registros, confere o tamanho anunciado e decodifica de volta
+static size_t ida_e_volta(const registro_t *r, uint8_t n, const char *descricao) {
+  uint8_t quadro[TELEMETRIA_QUADRO_MAX];
+  size_t tamanho = telemetria_codificar(r, n, quadro);
+  VERIFICAR(tamanho <= TELEMETRIA_QUADRO_MAX, "%s: %zu bytes", descricao, tamanho);
+  VERIFICAR(telemetria_tamanho_quadro(quadro, tamanho) == tamanho, "%s: tamanho do cabeçalho", descricao);
+  VERIFICAR(telemetria_tamanho_quadro(quadro, 3) == 0, "%s: cabeçalho incompleto aceito", descricao);
+
+  registro_t lido[TELEMETRIA_LOTE];
+  uint8_t m = 0;
+  VERIFICAR(telemetria_decodificar(quadro, tamanho, lido, &m), "%s: quadro recusado", descricao);
+  VERIFICAR(m == n, "%s: %u registros de %u", descricao, m, n);
+  for (uint8_t i = 0; i < n && i < m; ++i)
+    VERIFICAR(registros_iguais(&lido[i], &r[i]), "%s: registro %u diferente", descricao, i);
+  return tamanho;
+}
+
+// -----------------------------------------------------------------------------
+// Extremos dos deltas
+// -----------------------------------------------------------------------------
+static void testar_extremos(void) {
+  registro_t r[] = {
+    { 10, 0xFFFFFF00u, INT16_MIN, 0, 65535, 0 },
+    { 11, 0x00000100u, INT16_MAX, 65535, 0, TELEMETRIA_LIGADO },   // Δ +65535 / -65535, tempo volta
+    { 12, 0x00000200u, INT16_MIN, 0, 65535, TELEMETRIA_MANUAL },   // Δ -65535 / +65535
+    { 1012, 0x00000200u, 0, 0, 0, TELEMETRIA_ZONA(63) },           // Lacuna de 1000, Δt = 0
+    { 0xFFFFFFFFu, 0x7FFFFFFFu, -1, 1, 1, 0xFF },                   // Lacuna enorme
+    { 3, 0x80000000u, 1, 2, 3, 0 },                                  // Sequência dá a volta
+  };
+  ida_e_volta(r, sizeof(r) / sizeof(r[0]), "extremos");
+  ida_e_volta(r, 1, "registro único");
+  ida_e_volta(r, 0, "lote vazio");
+
+  // Passeios aleatórios com saltos de qualquer tamanho nos campos de 16 bits
+  registro_t lote[TELEMETRIA_LOTE];
+  for (int rodada = 0; rodada < 2000; ++rodada) {
+    uint8_t n = (uint8_t)teste_entre(1, TELEMETRIA_LOTE);
+    for (uint8_t i = 0; i < n; ++i) {
+      registro_t *x = &lote[i];
+      const registro_t *a = i ? &lote[i - 1] : NULL;
+      uint32_t salto = teste_aleatorio() % 8 == 0 ? teste_aleatorio() : 1;
+      x->sequencia = a ? a->sequencia + salto : teste_aleatorio();
+      x->instante_us = (a ? a->instante_us : teste_aleatorio()) + teste_aleatorio() % 200000;
+      x->umidade = (int16_t)teste_aleatorio();
+      x->desejada = (uint16_t)teste_aleatorio();
+      x->bomba = (uint16_t)teste_aleatorio();
+      x->flags = (uint8_t)teste_aleatorio();
+    }
+    ida_e_volta(lote, n, "aleatório");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Pior caso: varints de 5 bytes para sequência e tempo e de 3 bytes para os
+// três campos de 16 bits em todos os registros
+// -----------------------------------------------------------------------------
+static void testar_pior_caso(void) {
+  registro_t r[TELEMETRIA_LOTE];
+  for (uint8_t i = 0; i < TELEMETRIA_LOTE; ++i) {
+    r[i].sequencia = 0xF0000000u + i * (1u << 28) + i;   // Lacunas de 2^28: 5 bytes
+    r[i].instante_us = 0xF0000000u + i * 0x90000000u;      // Δ >= 2^28: 5 bytes
+    r[i].umidade = i % 2 ? INT16_MAX : INT16_MIN;
+    r[i].desejada = i % 2 ? 0 : 65535;
+    r[i].bomba = i % 2 ? 0 : 65535;
+    r[i].flags = 0xFF;
+  }
+  size_t tamanho = ida_e_volta(r, TELEMETRIA_LOTE, "pior caso");
+  VERIFICAR(tamanho == TELEMETRIA_QUADRO_MAX, "pior caso com %zu bytes, limite %u", tamanho,
+            TELEMETRIA_QUADRO_MAX);
+
+  // Um byte além do limite já não é um quadro
+  uint8_t cabecalho[] = { 0xA5, 0x5A, 0, 0 };
+  size_t carga = TELEMETRIA_QUADRO_MAX - 6 + 1;
+  cabecalho[2] = (uint8_t)carga;
+  cabecalho[3] = (uint8_t)(carga >> 8);
+  VERIFICAR(telemetria_tamanho_quadro(cabecalho, sizeof(cabecalho)) == 0, "quadro acima do limite aceito");
+}
+
+// -----------------------------------------------------------------------------
+// Quadros inválidos
+// -----------------------------------------------------------------------------
+
+// Regrava comprimento e CRC para a carga atual (só o conteúdo fica errado)
+static size_t refazer_quadro(uint8_t *quadro, size_t carga) {
+  quadro[2] = (uint8_t)carga;
+  quadro[3] = (uint8_t)(carga >> 8);
+  uint16_t crc = crc16_ccitt(quadro + 2, carga + 2);
+  quadro[4 + carga] = (uint8_t)crc;
+  quadro[5 + carga] = (uint8_t)(crc >> 8);
+  return carga + 6;
+}
+
+static void testar_recusas(void) {
+  registro_t r[3] = {
+    { 100, 5000, 450, 500, 1000, TELEMETRIA_LIGADO },
+    { 101, 105000, 452, 500, 1100, TELEMETRIA_LIGADO },
+    { 102, 205000, 455, 500, 900, TELEMETRIA_LIGADO },
+  };
+  uint8_t original[TELEMETRIA_QUADRO_MAX + 8], quadro[sizeof(original)];
+  size_t tamanho = telemetria_codificar(r, 3, original);
+  size_t carga = tamanho - 6;
+  registro_t lido[TELEMETRIA_LOTE];
+  uint8_t n;
+
+  // Qualquer bit trocado no comprimento, na carga ou no CRC
+  for (size_t bit = 16; bit < tamanho * 8; ++bit) {
+    memcpy(quadro, original, tamanho);
+    quadro[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    VERIFICAR(!telemetria_decodificar(quadro, tamanho, lido, &n), "bit %zu trocado aceito", bit);
+  }
+
+  // Comprimento diferente do anunciado: quadro truncado ou com sobra
+  VERIFICAR(!telemetria_decodificar(original, tamanho - 1, lido, &n), "quadro truncado aceito");
+  VERIFICAR(!telemetria_decodificar(original, tamanho + 1, lido, &n), "byte a mais aceito");
+
+  // Comprimento abaixo do mínimo (tipo e n) e acima do máximo
+  memcpy(quadro, original, tamanho);
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, 1), lido, &n), "carga de 1 byte aceita");
+  memcpy(quadro, original, tamanho);
+  quadro[2] = 0xFF;
+  quadro[3] = 0xFF;
+  VERIFICAR(telemetria_tamanho_quadro(quadro, sizeof(quadro)) == 0, "comprimento 0xFFFF aceito");
+
+  // Bytes sobrando depois do último registro, com CRC correto
+  memcpy(quadro, original, tamanho);
+  quadro[4 + carga] = 0x00;
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, carga + 1), lido, &n),
+            "byte sobrando na carga aceito");
+
+  // n maior que os registros presentes: a carga acaba no meio
+  memcpy(quadro, original, tamanho);
+  quadro[5] = 4;
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, carga), lido, &n), "n inflado aceito");
+
+  // n acima do lote e tipo desconhecido
+  memcpy(quadro, original, tamanho);
+  quadro[5] = TELEMETRIA_LOTE + 1;
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, carga), lido, &n), "n acima do lote aceito");
+  memcpy(quadro, original, tamanho);
+  quadro[4] = TELEMETRIA_TIPO_LOTE + 1;
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, carga), lido, &n), "tipo desconhecido aceito");
+
+  // Varint com mais de 5 bytes
+  static const uint8_t varint_longo[] = { 0x01, 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0, 0, 0, 0, 0 };
+  memcpy(quadro + 4, varint_longo, sizeof(varint_longo));
+  VERIFICAR(!telemetria_decodificar(quadro, refazer_quadro(quadro, sizeof(varint_longo)), lido, &n),
+            "varint de 6 bytes aceito");
+
+  // O original continua válido
+  VERIFICAR(telemetria_decodificar(original, tamanho, lido, &n) && n == 3, "quadro original recusado");
+}
+
+// -----------------------------------------------------------------------------
+// Anel de saída
+// -----------------------------------------------------------------------------
+#define SAIDA_MAX (1u << 20)
+
+static uint8_t saida[SAIDA_MAX];
+static size_t n_saida;
+static unsigned trechos;
+
+static void gravar(const uint8_t *dados, size_t tamanho) {
+  VERIFICAR(n_saida + tamanho <= SAIDA_MAX, "saída cheia");
+  if (n_saida + tamanho > SAIDA_MAX)
+    return;
+  memcpy(&saida[n_saida], dados, tamanho);
+  n_saida += tamanho;
+  ++trechos;
+}
+
+TELEMETRIA_DEFINIR(telemetria, 64, gravar);
+
+// Decodifica a saída a partir de *lido até o fim: só quadros inteiros e
+// válidos, com a sequência continuando de *esperada
+static void conferir_saida(size_t *lido, uint32_t *esperada, uint32_t *registros) {
+  registro_t r[TELEMETRIA_LOTE];
+  while (*lido < n_saida) {
+    size_t tamanho = telemetria_tamanho_quadro(&saida[*lido], n_saida - *lido);
+    uint8_t n = 0;
+    bool ok = tamanho && tamanho <= n_saida - *lido && telemetria_decodificar(&saida[*lido], tamanho, r, &n);
+    VERIFICAR(ok, "quadro inválido ou partido na posição %zu", *lido);
+    if (!ok) {
+      *lido = n_saida;
+      return;
+    }
+    for (uint8_t i = 0; i < n; ++i) {
+      VERIFICAR(r[i].sequencia == *esperada, "sequência %u, esperada %u", r[i].sequencia, *esperada);
+      VERIFICAR(r[i].umidade == (int16_t)(r[i].sequencia * 7u), "registro %u corrompido", r[i].sequencia);
+      *esperada = r[i].sequencia + 1;
+    }
+    *registros += n;
+    *lido += tamanho;
+  }
+}
+
+static void testar_escoar(void) {
+  // Índices perto de 2^32: a volta deles e a do anel acontecem no teste
+  telemetria.cabeca = telemetria.cauda = UINT32_MAX - 3000u;
+  telemetria.proxima_sequencia = UINT32_MAX - 5000u;
+  uint32_t esperada = telemetria.proxima_sequencia, registros = 0, enviados = 0;
+  size_t lido = 0;
+  unsigned voltas = 0;
+
+  for (int rodada = 0; rodada < 3000; ++rodada) {
+    for (uint32_t n = teste_entre(0, 40); n > 0; --n) {
+      registro_t r = {
+        .instante_us = (uint32_t)rodada * 100000u,
+        .umidade = (int16_t)(telemetria.proxima_sequencia * 7u),
+        .desejada = (uint16_t)teste_entre(0, 1000),
+        .bomba = (uint16_t)teste_aleatorio(),
+        .flags = TELEMETRIA_LIGADO,
+      };
+      VERIFICAR(telemetria_registrar(&telemetria, &r), "fila cheia na rodada %d", rodada);
+    }
+    telemetria_processar(&telemetria, teste_aleatorio() % 4 == 0);
+
+    // Limite às vezes menor que um quadro: sai um inteiro mesmo assim
+    unsigned antes = trechos;
+    uint32_t pendentes = telemetria.cabeca - telemetria.cauda;
+    uint32_t max = teste_entre(0, 600);
+    uint32_t n = telemetria_escoar(&telemetria, max);
+    enviados += n;
+    VERIFICAR(n == n_saida - (size_t)(enviados - n), "retorno %u diferente do escrito", n);
+    VERIFICAR(pendentes == 0 || n > 0, "nada escoado com %u bytes no anel", pendentes);
+    VERIFICAR(n <= max || n <= TELEMETRIA_QUADRO_MAX, "%u bytes escoados para limite %u", n, max);
+    voltas += trechos - antes > (n ? 1u : 0u);
+    conferir_saida(&lido, &esperada, &registros);
+  }
+  telemetria_processar(&telemetria, true);
+  while (telemetria_escoar(&telemetria, TELEMETRIA_ANEL))
+    ;
+  conferir_saida(&lido, &esperada, &registros);
+
+  VERIFICAR(registros == esperada - (UINT32_MAX - 5000u), "%u registros, %u enviados", registros,
+            esperada - (UINT32_MAX - 5000u));
+  VERIFICAR(esperada == telemetria.proxima_sequencia, "faltam registros: último %u de %u", esperada,
+            telemetria.proxima_sequencia);
+  VERIFICAR(telemetria_perdidos(&telemetria) == 0, "%u registros perdidos", telemetria_perdidos(&telemetria));
+  VERIFICAR(telemetria.bytes == n_saida, "bytes contados %u, escritos %zu", telemetria.bytes, n_saida);
+  VERIFICAR(n_saida > 4 * TELEMETRIA_ANEL, "só %zu bytes: o anel não deu voltas", n_saida);
+  VERIFICAR(voltas > 0, "nenhum quadro atravessou o fim do anel");
+}
+
+// Sem escoar, o anel enche: os lotes que não cabem são descartados e contados
+static void testar_anel_cheio(void) {
+  telemetria.cabeca = telemetria.cauda = 0;
+  n_saida = 0;
+  uint32_t sequencia_inicial = telemetria.proxima_sequencia;
+  for (int i = 0; i < 40 * TELEMETRIA_LOTE; ++i) {
+    registro_t r = { .umidade = (int16_t)(telemetria.proxima_sequencia * 7u) };
+    telemetria_registrar(&telemetria, &r);
+    telemetria_processar(&telemetria, false);
+  }
+  uint32_t perdidos = telemetria_perdidos(&telemetria);
+  VERIFICAR(perdidos > 0, "anel nunca encheu");
+  VERIFICAR(telemetria.cabeca - telemetria.cauda <= TELEMETRIA_ANEL, "anel transbordou");
+
+  // O que coube sai inteiro, e as perdas aparecem como lacuna na sequência
+  while (telemetria_escoar(&telemetria, TELEMETRIA_ANEL))
+    ;
+  size_t lido = 0;
+  uint32_t esperada = sequencia_inicial, registros = 0;
+  conferir_saida(&lido, &esperada, &registros);
+  VERIFICAR(registros + perdidos == 40 * TELEMETRIA_LOTE, "%u registros + %u perdidos", registros, perdidos);
+}
+
+int main(void) {
+  testar_extremos();
+  testar_pior_caso();
+  testar_recusas();
+  testar_escoar();
+  testar_anel_cheio();
+  return teste_resultado("teste_telemetria");
+}
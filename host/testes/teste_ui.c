@@ -0,0 +1,108 @@
+// =============================================================================
+// TESTE: BARRAS E MEDIDORES INCREMENTAIS
+// ui_atualizar redesenha de uma barra só a diferença para o valor anterior e,
+// no medidor, devolve à coluna da marca antiga o estado da barra. Depois de
+// cada atualização, o painel atualizado assim tem de ser idêntico a outro em
+// que os mesmos widgets são invalidados e desenhados do zero. As áreas
+// marcadas como sujas têm de bastar para a GDDRAM emulada acompanhar.
+// =============================================================================
+#include "ui.h"
+#include "hal_host.h"
+#include "teste.h"
+
+#define RODADAS 20000
+#define ENDERECO_INCREMENTAL 0x3C
+#define ENDERECO_ZERO 0x3D
+
+SSD1306_DEFINE(incremental, 128, 64);
+SSD1306_DEFINE(zero, 128, 64);
+
+static volatile uint16_t valores[4], referencias[3];
+
+// O medidor da tela de status, medidores estreitos (marca presa na última
+// coluna interna) e com máximo que não divide a largura, e uma barra simples
+#define WIDGETS                                                                \
+  {                                                                            \
+    UI_MEDIDOR(0, 54, 128, 10, &valores[0], &referencias[0], 100),             \
+    UI_MEDIDOR(3, 5, 13, 7, &valores[1], &referencias[1], 10),                 \
+    UI_MEDIDOR(40, 20, 77, 20, &valores[2], &referencias[2], 1000),            \
+    UI_BARRA(20, 44, 90, 6, &valores[3], 37),                                  \
+  }
+
+static ui_widget_t widgets_incremental[] = WIDGETS;
+static ui_widget_t widgets_zero[] = WIDGETS;
+static ui_tela_t tela_incremental = UI_TELA(widgets_incremental);
+static ui_tela_t tela_zero = UI_TELA(widgets_zero);
+
+// Próximo valor: repetido, perto do anterior, aleatório ou além do máximo
+static uint16_t sortear(uint16_t anterior, uint16_t maximo) {
+  switch (teste_aleatorio() % 8) {
+    case 0:
+    case 1:
+      return anterior;
+    case 2:
+      return (uint16_t)(maximo + teste_entre(0, 50));
+    case 3:
+      return 0;
+    case 4:
+    case 5: {
+      int32_t v = (int32_t)anterior + (int32_t)teste_entre(0, 10) - 5;
+      return (uint16_t)(v < 0 ? 0 : v);
+    }
+    default:
+      return (uint16_t)teste_entre(0, maximo);
+  }
+}
+
+static void comparar(int rodada) {
+  if (memcmp(incremental.ram_buffer, zero.ram_buffer, incremental.bufsize) == 0) {
+    ++teste_verificacoes;
+  } else {
+    char etapa[48];
+    snprintf(etapa, sizeof(etapa), "incremental != do zero, rodada %d", rodada);
+    VERIFICAR_MEMORIA(incremental.ram_buffer, zero.ram_buffer, incremental.bufsize, etapa);
+  }
+
+  ssd1306_send_dirty(&incremental);
+  if (memcmp(hal_host_panel_ram(ENDERECO_INCREMENTAL), incremental.ram_buffer + 1, 128 * 8) == 0) {
+    ++teste_verificacoes;
+  } else {
+    char etapa[48];
+    snprintf(etapa, sizeof(etapa), "envio das áreas sujas, rodada %d", rodada);
+    VERIFICAR_MEMORIA(hal_host_panel_ram(ENDERECO_INCREMENTAL), incremental.ram_buffer + 1, 128 * 8,
+                      etapa);
+  }
+}
+
+int main(void) {
+  hal_i2c_init(i2c1, 400000, 14, 15);
+  ssd1306_init(&incremental, false, ENDERECO_INCREMENTAL, i2c1);
+  ssd1306_init(&zero, false, ENDERECO_ZERO, i2c1);
+  ssd1306_config(&incremental);
+
+  // Fora dos widgets nada pode mudar: os dois partem do mesmo lixo
+  for (size_t i = 1; i < incremental.bufsize; ++i)
+    incremental.ram_buffer[i] = zero.ram_buffer[i] = (uint8_t)teste_aleatorio();
+  ssd1306_send_data(&incremental);
+
+  unsigned parciais = 0;
+  for (int rodada = 0; rodada < RODADAS; ++rodada) {
+    for (size_t i = 0; i < sizeof(valores) / sizeof(valores[0]); ++i)
+      valores[i] = sortear(valores[i], widgets_incremental[i].maximo);
+    for (size_t i = 0; i < sizeof(referencias) / sizeof(referencias[0]); ++i)
+      if (teste_aleatorio() % 4 == 0)
+        referencias[i] = sortear(referencias[i], widgets_incremental[i].maximo);
+    // Às vezes a tela inteira é invalidada, como na troca de telas
+    if (teste_aleatorio() % 256 == 0)
+      ui_invalidar(&tela_incremental);
+
+    parciais += ui_atualizar(&incremental, &tela_incremental);
+    ui_invalidar(&tela_zero);
+    VERIFICAR(ui_atualizar(&zero, &tela_zero) == tela_zero.quantidade, "redesenho incompleto, rodada %d",
+              rodada);
+    comparar(rodada);
+  }
+
+  VERIFICAR(parciais > RODADAS, "só %u redesenhos incrementais", parciais);
+  return teste_resultado("teste_ui");
+}
@@ -0,0 +1,35 @@
+#ifndef TRACO_H
+#define TRACO_H
+
+// =============================================================================
+// TRAÇOS DO ADC GRAVADOS EM ARQUIVO
+// Uma leitura de 12 bits por linha; linhas com '#' são comentários. Os
+// caminhos relativos partem de DIRETORIO_FONTES (a raiz do projeto, definida
+// pelo CMake), para não depender do diretório de onde o programa roda.
+// =============================================================================
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef DIRETORIO_FONTES
+#define DIRETORIO_FONTES "."
+#endif
+
+// Lê até max leituras de nome (ex.: "host/traco_umidade.txt"); retorna
+// quantas leu (0 se o arquivo não abrir)
+static inline size_t traco_carregar(const char *nome, uint16_t *amostras, size_t max) {
+  char caminho[512];
+  snprintf(caminho, sizeof(caminho), "%s/%s", DIRETORIO_FONTES, nome);
+  FILE *f = fopen(caminho, "r");
+  if (!f)
+    return 0;
+  size_t n = 0;
+  char linha[64];
+  unsigned valor;
+  while (n < max && fgets(linha, sizeof(linha), f))
+    if (linha[0] != '#' && sscanf(linha, "%u", &valor) == 1)
+      amostras[n++] = (uint16_t)(valor & 0x0FFF);
+  fclose(f);
+  return n;
+}
+
+#endif